@@ -0,0 +1,20 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// the io_uring reactor requires the kernel headers of Linux 5.11
+// (IORING_ENTER_EXT_ARG, struct io_uring_getevents_arg)
+
+extern "C" {
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+}
+
+int main() {
+    struct io_uring_getevents_arg arg = {};
+    struct __kernel_timespec ts = {};
+    arg.ts = reinterpret_cast< unsigned long long >( & ts);
+    unsigned flags = IORING_ENTER_EXT_ARG | IORING_FEAT_EXT_ARG;
+    return 0 == arg.ts + flags ? 1 : 0;
+}
@@ -9,6 +9,7 @@
 #include <atomic>
 #include <chrono>
 #include <cstddef>
+#include <new>
 
 #include <boost/assert.hpp>
 #include <boost/config.hpp>
@@ -39,6 +40,14 @@ public:
 
     virtual void awakened( context *) noexcept = 0;
 
+    // makes `n` contexts ready at once (e.g. launched by spawn_n());
+    // algorithms might override it to take their locks only once
+    virtual void awakened_n( context ** ctxs, std::size_t n) noexcept {
+        for ( std::size_t i = 0; i < n; ++i) {
+            awakened( ctxs[i]);
+        }
+    }
+
     virtual context * pick_next() noexcept = 0;
 
     virtual bool has_ready_fibers() const noexcept = 0;
@@ -93,6 +102,21 @@ public:
     // called by fiber_properties::notify() -- don't directly call
     virtual void property_change_( context * ctx, fiber_properties * props) noexcept = 0;
 
+    // size of the properties constructed by construct_properties() in
+    // storage reserved on top of a new fiber's stack; 0 (the default) if the
+    // properties are created by new_properties() on the first call of
+    // awakened()
+    virtual std::size_t properties_size() const noexcept {
+        return 0;
+    }
+
+    // placement-constructs the properties of `ctx` in `storage`; only called
+    // if properties_size() is not 0
+    virtual fiber_properties * construct_properties( context * /* ctx */, void * /* storage */) {
+        BOOST_ASSERT_MSG( false, "construct_properties() requires properties_size() to be overridden");
+        return nullptr;
+    }
+
 protected:
     static fiber_properties* get_properties( context * ctx) noexcept;
     static void set_properties( context * ctx, fiber_properties * p) noexcept;
@@ -108,9 +132,10 @@ struct algorithm_with_properties : public algorithm_with_properties_base {
     // with: algorithm_with_properties<PROPS>::awakened(fb);
     void awakened( context * ctx) noexcept final {
         fiber_properties * props = super::get_properties( ctx);
-        if ( BOOST_LIKELY( nullptr == props) ) {
-            // TODO: would be great if PROPS could be allocated on the new
-            // fiber's stack somehow
+        if ( BOOST_UNLIKELY( nullptr == props) ) {
+            // fibers spawned on a thread running this algorithm got their
+            // properties on top of their stack (see properties_size());
+            // main-/dispatcher-context and fibers spawned elsewhere get here
             props = new_properties( ctx);
             // It is not good for new_properties() to return 0.
             BOOST_ASSERT_MSG( props, "new_properties() must return non-NULL");
@@ -151,6 +176,21 @@ struct algorithm_with_properties : public algorithm_with_properties_base {
     virtual fiber_properties * new_properties( context * ctx) {
         return new PROPS( ctx);
     }
+
+    // Placement-constructs PROPS in storage on top of a new fiber's stack.
+    // Only called if properties_size() is overridden to return
+    // in_place_properties_size(): such algorithms opt in to skip
+    // new_properties() for fibers launched on their thread.
+    fiber_properties * construct_properties( context * ctx, void * storage) override {
+        return new ( storage) PROPS( ctx);
+    }
+
+protected:
+    // size of PROPS, 0 if PROPS is over-aligned for the storage on top of
+    // the stack
+    static constexpr std::size_t in_place_properties_size() noexcept {
+        return alignof( PROPS) <= alignof( std::max_align_t) ? sizeof( PROPS) : 0;
+    }
 };
 
 }}}
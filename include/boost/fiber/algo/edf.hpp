@@ -0,0 +1,167 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_ALGO_EDF_H
+#define BOOST_FIBERS_ALGO_EDF_H
+
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+#include <boost/config.hpp>
+#include <boost/intrusive/set.hpp>
+
+#include <boost/fiber/algo/algorithm.hpp>
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/properties.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace boost {
+namespace fibers {
+namespace algo {
+
+class edf_props : public fiber_properties {
+public:
+    typedef intrusive::set_member_hook<
+        intrusive::link_mode< intrusive::safe_link >
+    >                                                   hook_type;
+
+    // key of a ready fiber, fixed while the fiber is queued;
+    // fibers with equal deadlines are scheduled in FIFO order
+    struct key_type {
+        std::chrono::steady_clock::time_point   deadline{};
+        std::uint64_t                           seq{ 0 };
+
+        friend bool operator<( key_type const& l, key_type const& r) noexcept {
+            return l.deadline < r.deadline || ( l.deadline == r.deadline && l.seq < r.seq);
+        }
+    };
+
+private:
+    std::chrono::steady_clock::time_point   deadline_;
+
+public:
+    hook_type                               hook_{};
+    key_type                                key_{};
+
+    // fibers without deadline (time_point::max()) run after all fibers with
+    // a deadline
+    explicit edf_props( context * ctx,
+                        std::chrono::steady_clock::time_point const& deadline =
+                            (std::chrono::steady_clock::time_point::max)() ) noexcept :
+        fiber_properties{ ctx },
+        deadline_{ deadline } {
+    }
+
+    context * get_context() const noexcept {
+        return ctx_;
+    }
+
+    std::chrono::steady_clock::time_point get_deadline() const noexcept {
+        return deadline_;
+    }
+
+    // must be called by a fiber of the thread the fiber belongs to
+    void set_deadline( std::chrono::steady_clock::time_point const& deadline) noexcept {
+        if ( deadline != deadline_) {
+            deadline_ = deadline;
+            // a queued fiber is not linked to the ready-queue of the
+            // scheduler, hence fiber_properties::notify() can not be used
+            if ( nullptr != algo_) {
+                dynamic_cast< algorithm_with_properties_base * >( algo_)->property_change_( ctx_, this);
+            }
+        }
+    }
+
+    template< typename Rep, typename Period >
+    void set_deadline( std::chrono::duration< Rep, Period > const& timeout_duration) noexcept {
+        set_deadline( std::chrono::steady_clock::now() + timeout_duration);
+    }
+};
+
+}
+
+namespace detail {
+
+struct edf_key_of {
+    typedef algo::edf_props::key_type type;
+
+    type const& operator()( algo::edf_props const& props) const noexcept {
+        return props.key_;
+    }
+};
+
+// ready fibers ordered by (deadline, arrival)
+typedef intrusive::multiset<
+    algo::edf_props,
+    intrusive::member_hook< algo::edf_props, algo::edf_props::hook_type, & algo::edf_props::hook_ >,
+    intrusive::key_of_value< edf_key_of >,
+    intrusive::constant_time_size< false >
+>                                                       edf_queue_type;
+
+// deadline a ready fiber is queued with; the dispatcher-context gets the
+// nearest deadline of the ready fibers (including the fiber resumed right
+// now), otherwise fibers with an expired deadline would starve sleeping and
+// remote-ready fibers
+BOOST_FIBERS_DECL
+std::chrono::steady_clock::time_point
+edf_queue_deadline( context *, algo::edf_props &, edf_queue_type const&) noexcept;
+
+}
+
+namespace algo {
+
+// earliest deadline first: picks the ready fiber with the nearest deadline
+// enqueue, pick and change of a deadline take O(log n)
+class BOOST_FIBERS_DECL edf : public algorithm_with_properties< edf_props > {
+private:
+    detail::edf_queue_type      rqueue_{};
+    std::uint64_t               seq_{ 0 };
+    std::mutex                  mtx_{};
+    std::condition_variable     cnd_{};
+    bool                        flag_{ false };
+
+public:
+    edf() = default;
+
+    edf( edf const&) = delete;
+    edf & operator=( edf const&) = delete;
+
+    void awakened( context *, edf_props &) noexcept override;
+
+    context * pick_next() noexcept override;
+
+    bool has_ready_fibers() const noexcept override;
+
+    void property_change( context *, edf_props &) noexcept override;
+
+    std::size_t properties_size() const noexcept override;
+
+    void suspend_until( std::chrono::steady_clock::time_point const&) noexcept override;
+
+    void notify() noexcept override;
+};
+
+}}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_ALGO_EDF_H
@@ -0,0 +1,137 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_ALGO_EDF_WORK_STEALING_H
+#define BOOST_FIBERS_ALGO_EDF_WORK_STEALING_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/algo/algorithm.hpp>
+#include <boost/fiber/algo/edf.hpp>
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/peer_registry.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+#include <boost/fiber/detail/stealing_peer.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace boost {
+namespace fibers {
+namespace algo {
+
+class edf_work_stealing;
+
+// a set of `thread_count` threads running edf_work_stealing, stealing ready
+// fibers from each other; see work_stealing_pool
+class BOOST_FIBERS_DECL edf_work_stealing_pool {
+private:
+    friend class edf_work_stealing;
+
+    std::uint32_t                                   thread_count_;
+    std::atomic< std::uint32_t >                    counter_{ 0 };
+    detail::peer_registry< edf_work_stealing >      registry_;
+
+public:
+    explicit edf_work_stealing_pool( std::uint32_t);
+
+    edf_work_stealing_pool( edf_work_stealing_pool const&) = delete;
+    edf_work_stealing_pool & operator=( edf_work_stealing_pool const&) = delete;
+
+    std::uint32_t thread_count() const noexcept {
+        return thread_count_;
+    }
+};
+
+// earliest deadline first with work-stealing: each thread runs the ready
+// fiber with the nearest deadline of its own queue, an idle thread steals
+// the fibers with the latest deadlines from a peer
+// edf_props::set_deadline() should be called only by the fiber itself
+class BOOST_FIBERS_DECL edf_work_stealing : public algorithm_with_properties< edf_props > {
+public:
+    // max. number of contexts taken from a peer at once
+    static constexpr std::size_t steal_batch_size = 32;
+
+private:
+    template< typename >
+    friend class detail::stealing_peer;
+
+    std::shared_ptr< edf_work_stealing_pool >                   pool_;
+    std::uint32_t                                               thread_count_;
+    detail::stealing_peer< edf_work_stealing >                  peer_;
+    mutable detail::spinlock                                    splk_{};
+    // fibers the peers might steal (from the end with the latest deadline)
+    detail::edf_queue_type                                      rqueue_{};
+    // main-/dispatcher-context and fibers bound to this thread; kept apart,
+    // because their deadlines (often none) would put them at the end the
+    // peers steal from
+    detail::edf_queue_type                                      pinned_{};
+    std::uint64_t                                               seq_{ 0 };
+
+    static std::shared_ptr< edf_work_stealing_pool > const& default_pool_( std::uint32_t);
+
+    // steal() would succeed, if not raced by the owner or another thief
+    bool stealable_() const noexcept;
+
+public:
+    // joins the pool shared by all threads using this constructor, created
+    // by the first call
+    edf_work_stealing( std::uint32_t, bool = false);
+
+    edf_work_stealing( std::shared_ptr< edf_work_stealing_pool >, bool = false);
+
+    ~edf_work_stealing() override;
+
+    edf_work_stealing( edf_work_stealing const&) = delete;
+    edf_work_stealing( edf_work_stealing &&) = delete;
+
+    edf_work_stealing & operator=( edf_work_stealing const&) = delete;
+    edf_work_stealing & operator=( edf_work_stealing &&) = delete;
+
+    void awakened( context *, edf_props &) noexcept override;
+
+    context * pick_next() noexcept override;
+
+    // fiber with the latest deadline, unless it is pinned to its thread
+    context * steal() noexcept;
+
+    // steals up to half of the ready fibers at once, latest deadlines first
+    std::size_t steal_batch( context **, std::size_t) noexcept;
+
+    bool has_ready_fibers() const noexcept override;
+
+    void property_change( context *, edf_props &) noexcept override;
+
+    std::size_t properties_size() const noexcept override;
+
+    void suspend_until( std::chrono::steady_clock::time_point const&) noexcept override;
+
+    void notify() noexcept override;
+};
+
+}}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_ALGO_EDF_WORK_STEALING_H
@@ -0,0 +1,69 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_ALGO_EPOLL_ROUND_ROBIN_H
+#define BOOST_FIBERS_ALGO_EPOLL_ROUND_ROBIN_H
+
+#include <chrono>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/algo/algorithm.hpp>
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/epoll_reactor.hpp>
+#include <boost/fiber/scheduler.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace boost {
+namespace fibers {
+namespace algo {
+
+// round robin scheduling, the thread blocks in epoll_wait() while no fiber
+// is ready; fibers might wait for file descriptors with
+// this_fiber::wait_readable() / this_fiber::wait_writable()
+class BOOST_FIBERS_DECL epoll_round_robin : public algorithm {
+private:
+    typedef scheduler::ready_queue_type rqueue_type;
+
+    rqueue_type                 rqueue_{};
+    detail::epoll_reactor       reactor_{};
+
+public:
+    epoll_round_robin() = default;
+
+    epoll_round_robin( epoll_round_robin const&) = delete;
+    epoll_round_robin & operator=( epoll_round_robin const&) = delete;
+
+    void awakened( context *) noexcept override;
+
+    context * pick_next() noexcept override;
+
+    bool has_ready_fibers() const noexcept override;
+
+    void suspend_until( std::chrono::steady_clock::time_point const&) noexcept override;
+
+    void notify() noexcept override;
+};
+
+}}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_ALGO_EPOLL_ROUND_ROBIN_H
@@ -0,0 +1,71 @@
+//          Copyright Oliver Kowalke 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#ifndef BOOST_FIBERS_ALGO_EPOLL_WORK_STEALING_H
+#define BOOST_FIBERS_ALGO_EPOLL_WORK_STEALING_H
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/algo/work_stealing.hpp>
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/epoll_reactor.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace boost {
+namespace fibers {
+namespace algo {
+
+// work stealing, an idle thread blocks in epoll_wait()
+// a fiber waiting for a file descriptor is registered at the reactor of the
+// thread it is running on, after it has been woken it might be stolen
+class BOOST_FIBERS_DECL epoll_work_stealing : public work_stealing {
+private:
+    detail::epoll_reactor       reactor_{};
+
+public:
+    epoll_work_stealing( std::uint32_t);
+
+    epoll_work_stealing( std::shared_ptr< work_stealing_pool >);
+
+    ~epoll_work_stealing() override;
+
+    epoll_work_stealing( epoll_work_stealing const&) = delete;
+    epoll_work_stealing( epoll_work_stealing &&) = delete;
+
+    epoll_work_stealing & operator=( epoll_work_stealing const&) = delete;
+    epoll_work_stealing & operator=( epoll_work_stealing &&) = delete;
+
+    context * pick_next() noexcept override;
+
+    void suspend_until( std::chrono::steady_clock::time_point const&) noexcept override;
+
+    void notify() noexcept override;
+};
+
+}}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_ALGO_EPOLL_WORK_STEALING_H
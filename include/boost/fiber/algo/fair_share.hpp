@@ -0,0 +1,180 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_ALGO_FAIR_SHARE_H
+#define BOOST_FIBERS_ALGO_FAIR_SHARE_H
+
+#include <condition_variable>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <boost/config.hpp>
+#include <boost/intrusive/set.hpp>
+
+#include <boost/fiber/algo/algorithm.hpp>
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/properties.hpp>
+#include <boost/fiber/scheduler.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace boost {
+namespace fibers {
+namespace algo {
+
+class fair_share;
+
+class BOOST_FIBERS_DECL fair_share_props : public fiber_properties {
+private:
+    friend class fair_share;
+
+    std::uint32_t   group_;
+    // group the fiber is queued at
+    std::uint32_t   queued_{ 0 };
+
+public:
+    // fibers of a group that does not exist belong to group 0
+    explicit fair_share_props( context * ctx, std::uint32_t group = 0) noexcept :
+        fiber_properties{ ctx },
+        group_{ group } {
+    }
+
+    std::uint32_t get_group() const noexcept {
+        return group_;
+    }
+
+    void set_group( std::uint32_t) noexcept;
+};
+
+// weighted fair-share scheduling among groups of fibers
+// the run time of a fiber, measured between two calls of pick_next(), is
+// charged to its group; the virtual run time of a group advances by the run
+// time scaled by default_weight / weight, the ready group with the smallest
+// virtual run time is picked (round-robin among the fibers of a group)
+// a group becoming ready starts not behind the smallest virtual run time of
+// the ready groups, hence a group that was blocked for a while cannot
+// monopolize the thread afterwards
+// groups are created and re-weighted by fibers of the thread running the
+// algorithm; awakened() and pick_next() are O(log number of ready groups)
+class BOOST_FIBERS_DECL fair_share : public algorithm_with_properties< fair_share_props > {
+public:
+    static constexpr std::uint32_t default_weight = 1024;
+
+private:
+    typedef scheduler::ready_queue_type rqueue_type;
+    typedef intrusive::set_member_hook<
+        intrusive::link_mode< intrusive::safe_link >
+    >                                   hook_type;
+
+    struct group {
+        hook_type                   hook{};
+        rqueue_type                 rqueue{};
+        std::uint32_t               id;
+        std::uint32_t               weight;
+        std::uint64_t               vruntime{ 0 };
+        std::chrono::nanoseconds    runtime{ 0 };
+
+        group( std::uint32_t id_, std::uint32_t weight_) noexcept :
+            id{ id_ },
+            weight{ weight_ } {
+        }
+
+        friend bool operator<( group const& l, group const& r) noexcept {
+            return l.vruntime < r.vruntime || ( l.vruntime == r.vruntime && l.id < r.id);
+        }
+    };
+
+    typedef intrusive::set<
+        group,
+        intrusive::member_hook< group, hook_type, & group::hook >,
+        intrusive::constant_time_size< false >
+    >                                   gqueue_type;
+
+    std::vector< std::unique_ptr< group > >     groups_{};
+    // groups with ready fibers
+    gqueue_type                                 gqueue_{};
+    std::uint64_t                               min_vruntime_{ 0 };
+    std::size_t                                 ready_{ 0 };
+    // group of the fiber returned by the last pick_next()
+    group                                   *   running_{ nullptr };
+    std::chrono::steady_clock::time_point       last_{};
+    // the dispatcher-context runs after `budget_` fibers have been picked
+    context                                 *   dispatcher_{ nullptr };
+    std::size_t                                 budget_{ 0 };
+    std::mutex                                  mtx_{};
+    std::condition_variable                     cnd_{};
+    bool                                        flag_{ false };
+
+    group & group_( std::uint32_t) const;
+
+    void push_( context *, fair_share_props &) noexcept;
+
+    void charge_( std::chrono::steady_clock::time_point const&) noexcept;
+
+public:
+    // algorithm installed on the calling thread, nullptr if the thread
+    // uses another algorithm
+    static fair_share * current() noexcept;
+
+    fair_share();
+
+    ~fair_share() override;
+
+    fair_share( fair_share const&) = delete;
+    fair_share & operator=( fair_share const&) = delete;
+
+    // returns the id of the new group
+    std::uint32_t create_group( std::uint32_t weight = default_weight);
+
+    std::size_t group_count() const noexcept {
+        return groups_.size();
+    }
+
+    // weights are clamped to [1, 1 << 20]
+    void set_weight( std::uint32_t, std::uint32_t);
+
+    std::uint32_t get_weight( std::uint32_t) const;
+
+    // run time consumed by the fibers of a group
+    std::chrono::nanoseconds get_runtime( std::uint32_t) const;
+
+    void awakened( context *, fair_share_props &) noexcept override;
+
+    context * pick_next() noexcept override;
+
+    bool has_ready_fibers() const noexcept override;
+
+    void property_change( context *, fair_share_props &) noexcept override;
+
+    std::size_t properties_size() const noexcept override;
+
+    void suspend_until( std::chrono::steady_clock::time_point const&) noexcept override;
+
+    void notify() noexcept override;
+};
+
+}}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_ALGO_FAIR_SHARE_H
@@ -0,0 +1,102 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_ALGO_LOCKFREE_SHARED_WORK_H
+#define BOOST_FIBERS_ALGO_LOCKFREE_SHARED_WORK_H
+
+#include <atomic>
+#include <condition_variable>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/algo/algorithm.hpp>
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/context_mpmc_queue.hpp>
+#include <boost/fiber/scheduler.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace boost {
+namespace fibers {
+namespace algo {
+
+// like shared_work, but the ready fibers are shared through a bounded
+// lock-free MPMC queue (BOOST_FIBERS_MPMC_QUEUE_CAPACITY entries); fibers
+// that do not fit are kept in an overflow queue protected by a mutex
+class BOOST_FIBERS_DECL lockfree_shared_work : public algorithm {
+private:
+    typedef std::deque< context * >  oqueue_type;
+    typedef scheduler::ready_queue_type lqueue_type;
+
+    static detail::context_mpmc_queue   rqueue_;
+    static oqueue_type                  oqueue_;
+    static std::mutex                   oqueue_mtx_;
+    // size of the overflow queue, read without lock
+    static std::atomic< std::size_t >   oqueue_size_;
+
+    // main- and dispatcher-context, run if no other fiber is ready
+    lqueue_type             lqueue_{};
+    // worker fibers bound to this thread, take turns with the shared queues
+    lqueue_type             pinned_{};
+    bool                    pinned_turn_{ false };
+    std::mutex              mtx_{};
+    std::condition_variable cnd_{};
+    bool                    flag_{ false };
+    bool                    suspend_{ false };
+
+    static context * pop_overflow_() noexcept;
+
+public:
+    lockfree_shared_work() = default;
+
+    lockfree_shared_work( bool suspend) :
+        suspend_{ suspend } {
+    }
+
+    lockfree_shared_work( lockfree_shared_work const&) = delete;
+    lockfree_shared_work( lockfree_shared_work &&) = delete;
+
+    lockfree_shared_work & operator=( lockfree_shared_work const&) = delete;
+    lockfree_shared_work & operator=( lockfree_shared_work &&) = delete;
+
+    void awakened( context * ctx) noexcept override;
+
+    context * pick_next() noexcept override;
+
+    bool has_ready_fibers() const noexcept override {
+        return ! rqueue_.empty() ||
+               0 != oqueue_size_.load( std::memory_order_relaxed) ||
+               ! lqueue_.empty() ||
+               ! pinned_.empty();
+    }
+
+    void suspend_until( std::chrono::steady_clock::time_point const& time_point) noexcept override;
+
+    void notify() noexcept override;
+};
+
+}}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_ALGO_LOCKFREE_SHARED_WORK_H
@@ -0,0 +1,110 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_ALGO_PRIORITY_H
+#define BOOST_FIBERS_ALGO_PRIORITY_H
+
+#include <condition_variable>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/algo/algorithm.hpp>
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/properties.hpp>
+#include <boost/fiber/scheduler.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace boost {
+namespace fibers {
+namespace algo {
+
+class priority;
+
+class BOOST_FIBERS_DECL priority_props : public fiber_properties {
+private:
+    friend class priority;
+
+    int             priority_;
+    // level of the ready-queue the fiber is linked to
+    std::size_t     level_{ 0 };
+
+public:
+    // fibers with higher priority values are preferred; values are clamped
+    // to [0, priority::levels)
+    explicit priority_props( context * ctx, int p = 0) noexcept;
+
+    int get_priority() const noexcept {
+        return priority_;
+    }
+
+    void set_priority( int) noexcept;
+};
+
+// strict priority scheduling with a fixed number of priority levels,
+// round-robin among fibers of the same level
+// each level has a FIFO of ready fibers, a bitmap marks the non-empty levels;
+// awakened(), pick_next() and a change of the priority are O(1)
+class BOOST_FIBERS_DECL priority : public algorithm_with_properties< priority_props > {
+public:
+    static constexpr std::size_t levels = 32;
+
+private:
+    typedef scheduler::ready_queue_type rqueue_type;
+
+    rqueue_type                 rqueues_[levels]{};
+    std::uint32_t               bitmap_{ 0 };
+    std::mutex                  mtx_{};
+    std::condition_variable     cnd_{};
+    bool                        flag_{ false };
+
+    std::size_t highest_level_() const noexcept;
+
+    void push_( context *, priority_props &, std::size_t) noexcept;
+
+public:
+    priority() = default;
+
+    priority( priority const&) = delete;
+    priority & operator=( priority const&) = delete;
+
+    void awakened( context *, priority_props &) noexcept override;
+
+    context * pick_next() noexcept override;
+
+    bool has_ready_fibers() const noexcept override;
+
+    void property_change( context *, priority_props &) noexcept override;
+
+    std::size_t properties_size() const noexcept override;
+
+    void suspend_until( std::chrono::steady_clock::time_point const&) noexcept override;
+
+    void notify() noexcept override;
+};
+
+}}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_ALGO_PRIORITY_H
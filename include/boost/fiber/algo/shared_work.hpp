@@ -40,7 +40,11 @@ private:
     static rqueue_type     	rqueue_;
     static std::mutex   	rqueue_mtx_;
 
+    // main- and dispatcher-context, run if no other fiber is ready
     lqueue_type            	lqueue_{};
+    // worker fibers bound to this thread, take turns with the shared queue
+    lqueue_type             pinned_{};
+    bool                    pinned_turn_{ false };
     std::mutex              mtx_{};
     std::condition_variable cnd_{};
     bool                    flag_{ false };
@@ -61,11 +65,13 @@ public:
 
     void awakened( context * ctx) noexcept override;
 
+    void awakened_n( context ** ctxs, std::size_t n) noexcept override;
+
     context * pick_next() noexcept override;
 
     bool has_ready_fibers() const noexcept override {
         std::unique_lock< std::mutex > lock{ rqueue_mtx_ };
-        return ! rqueue_.empty() || ! lqueue_.empty();
+        return ! rqueue_.empty() || ! lqueue_.empty() || ! pinned_.empty();
     }
 
 	void suspend_until( std::chrono::steady_clock::time_point const& time_point) noexcept override;
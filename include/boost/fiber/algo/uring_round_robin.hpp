@@ -0,0 +1,70 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_ALGO_URING_ROUND_ROBIN_H
+#define BOOST_FIBERS_ALGO_URING_ROUND_ROBIN_H
+
+#include <chrono>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/algo/algorithm.hpp>
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/uring_reactor.hpp>
+#include <boost/fiber/scheduler.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace boost {
+namespace fibers {
+namespace algo {
+
+// round robin scheduling with completion based I/O (io_uring), the thread
+// blocks in io_uring_enter() while no fiber is ready; I/O operations of the
+// fibers (fibers::uring::read() etc.) are submitted in one batch per
+// iteration of the dispatcher-context
+class BOOST_FIBERS_DECL uring_round_robin : public algorithm {
+private:
+    typedef scheduler::ready_queue_type rqueue_type;
+
+    rqueue_type                 rqueue_{};
+    detail::uring_reactor       reactor_;
+
+public:
+    explicit uring_round_robin( unsigned entries = 256);
+
+    uring_round_robin( uring_round_robin const&) = delete;
+    uring_round_robin & operator=( uring_round_robin const&) = delete;
+
+    void awakened( context *) noexcept override;
+
+    context * pick_next() noexcept override;
+
+    bool has_ready_fibers() const noexcept override;
+
+    void suspend_until( std::chrono::steady_clock::time_point const&) noexcept override;
+
+    void notify() noexcept override;
+};
+
+}}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_ALGO_URING_ROUND_ROBIN_H
@@ -9,12 +9,10 @@
 #define BOOST_FIBERS_ALGO_WORK_STEALING_H
 
 #include <atomic>
-#include <condition_variable>
 #include <chrono>
 #include <cstddef>
 #include <cstdint>
-#include <mutex>
-#include <vector>
+#include <memory>
 
 #include <boost/config.hpp>
 #include <boost/intrusive_ptr.hpp>
@@ -24,38 +22,106 @@
 #include <boost/fiber/detail/config.hpp>
 #include <boost/fiber/detail/context_spinlock_queue.hpp>
 #include <boost/fiber/detail/context_spmc_queue.hpp>
+#include <boost/fiber/detail/peer_registry.hpp>
+#include <boost/fiber/detail/stealing_peer.hpp>
 #include <boost/fiber/scheduler.hpp>
 
 #ifdef BOOST_HAS_ABI_HEADERS
 #  include BOOST_ABI_PREFIX
 #endif
 
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
 namespace boost {
 namespace fibers {
 namespace algo {
 
+class work_stealing;
+
+// a set of `thread_count` threads stealing ready fibers from each other
+// a thread joins the pool by installing work_stealing( pool), the pool is
+// released after the pool handle and the schedulers of all its threads
+// have been destroyed; independent pools might coexist
+class BOOST_FIBERS_DECL work_stealing_pool {
+private:
+    friend class work_stealing;
+
+    std::uint32_t                                   thread_count_;
+    std::atomic< std::uint32_t >                    counter_{ 0 };
+    detail::peer_registry< work_stealing >          registry_;
+
+public:
+    explicit work_stealing_pool( std::uint32_t);
+
+    work_stealing_pool( work_stealing_pool const&) = delete;
+    work_stealing_pool & operator=( work_stealing_pool const&) = delete;
+
+    std::uint32_t thread_count() const noexcept {
+        return thread_count_;
+    }
+};
+
 class BOOST_FIBERS_DECL work_stealing : public algorithm {
+public:
+    // max. number of contexts taken from a peer at once
+    static constexpr std::size_t steal_batch_size = 32;
+
 private:
-    static std::atomic< std::uint32_t >                     counter_;
-    static std::vector< intrusive_ptr< work_stealing > >    schedulers_;
+    template< typename >
+    friend class detail::stealing_peer;
 
-    std::uint32_t                                           id_;
+    std::shared_ptr< work_stealing_pool >                   pool_;
     std::uint32_t                                           thread_count_;
+    detail::stealing_peer< work_stealing >                  peer_;
 #ifdef BOOST_FIBERS_USE_SPMC_QUEUE
     detail::context_spmc_queue                              rqueue_{};
 #else
     detail::context_spinlock_queue                          rqueue_{};
 #endif
-    std::mutex                                              mtx_{};
-    std::condition_variable                                 cnd_{};
-    bool                                                    flag_{ false };
-    bool                                                    suspend_;
+    // main-/dispatcher-context and fibers bound to this thread; kept apart,
+    // peers never see them and steal the fibers queued behind them
+    scheduler::ready_queue_type                             pinned_{};
+    // both ready-queues take turns, neither starves the other
+    bool                                                    pinned_turn_{ false };
+    bool                                                    joined_{ true };
 
-    static void init_( std::uint32_t, std::vector< intrusive_ptr< work_stealing > > &);
+    static std::shared_ptr< work_stealing_pool > const& default_pool_( std::uint32_t);
+
+    bool stealable_() const noexcept {
+        return rqueue_.stealable();
+    }
+
+    context * pop_pinned_() noexcept;
+
+protected:
+    // leave the pool before members accessed by peers (e.g. by notify())
+    // are destroyed
+    void leave_() noexcept;
+
+    // registers this worker as parked, peers pushing stealable work wake it
+    // by notify(); returns false if work can already be stolen (the worker
+    // must not block)
+    bool park_() noexcept {
+        return peer_.park();
+    }
+
+    // must follow park_() after the worker has been woken or timed out
+    void unpark_() noexcept {
+        peer_.unpark();
+    }
 
 public:
+    // joins the pool shared by all threads using this constructor, created
+    // by the first call
     work_stealing( std::uint32_t, bool = false);
 
+    work_stealing( std::shared_ptr< work_stealing_pool >, bool = false);
+
+    ~work_stealing() override;
+
     work_stealing( work_stealing const&) = delete;
     work_stealing( work_stealing &&) = delete;
 
@@ -64,14 +130,22 @@ public:
 
     void awakened( context *) noexcept override;
 
+    // pushes all contexts under one lock, wakes at most one parked peer
+    void awakened_n( context **, std::size_t) noexcept override;
+
     context * pick_next() noexcept override;
 
     virtual context * steal() noexcept {
         return rqueue_.steal();
     }
 
+    // steals up to half of the ready contexts at once
+    virtual std::size_t steal_batch( context ** ctxs, std::size_t max) noexcept {
+        return rqueue_.steal_half( ctxs, max);
+    }
+
     bool has_ready_fibers() const noexcept override {
-        return ! rqueue_.empty();
+        return ! rqueue_.empty() || ! pinned_.empty();
     }
 
     void suspend_until( std::chrono::steady_clock::time_point const&) noexcept override;
@@ -81,6 +155,10 @@ public:
 
 }}}
 
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
 #ifdef BOOST_HAS_ABI_HEADERS
 #  include BOOST_ABI_SUFFIX
 #endif
@@ -8,11 +8,17 @@
 #define BOOST_FIBERS_H
 
 #include <boost/fiber/algo/algorithm.hpp>
+#include <boost/fiber/algo/edf.hpp>
+#include <boost/fiber/algo/edf_work_stealing.hpp>
+#include <boost/fiber/algo/fair_share.hpp>
+#include <boost/fiber/algo/lockfree_shared_work.hpp>
+#include <boost/fiber/algo/priority.hpp>
 #include <boost/fiber/algo/round_robin.hpp>
 #include <boost/fiber/algo/shared_work.hpp>
 #include <boost/fiber/algo/work_stealing.hpp>
 #include <boost/fiber/barrier.hpp>
 #include <boost/fiber/buffered_channel.hpp>
+#include <boost/fiber/cached_clock.hpp>
 #include <boost/fiber/channel_op_status.hpp>
 #include <boost/fiber/condition_variable.hpp>
 #include <boost/fiber/context.hpp>
@@ -21,7 +27,10 @@
 #include <boost/fiber/fixedsize_stack.hpp>
 #include <boost/fiber/fss.hpp>
 #include <boost/fiber/future.hpp>
+#include <boost/fiber/huge_page_stack.hpp>
 #include <boost/fiber/mutex.hpp>
+#include <boost/fiber/numa_pooled_stack.hpp>
+#include <boost/fiber/offload.hpp>
 #include <boost/fiber/operations.hpp>
 #include <boost/fiber/policy.hpp>
 #include <boost/fiber/pooled_fixedsize_stack.hpp>
@@ -31,6 +40,9 @@
 #include <boost/fiber/recursive_timed_mutex.hpp>
 #include <boost/fiber/scheduler.hpp>
 #include <boost/fiber/segmented_stack.hpp>
+#include <boost/fiber/spawn.hpp>
+#include <boost/fiber/stack_profile.hpp>
+#include <boost/fiber/statistics.hpp>
 #include <boost/fiber/timed_mutex.hpp>
 #include <boost/fiber/type.hpp>
 #include <boost/fiber/unbuffered_channel.hpp>
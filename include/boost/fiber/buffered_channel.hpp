@@ -17,6 +17,7 @@
 
 #include <boost/config.hpp>
 
+#include <boost/fiber/cached_clock.hpp>
 #include <boost/fiber/channel_op_status.hpp>
 #include <boost/fiber/context.hpp>
 #include <boost/fiber/waker.hpp>
@@ -191,14 +192,14 @@ public:
     channel_op_status push_wait_for( value_type const& value,
                                      std::chrono::duration< Rep, Period > const& timeout_duration) {
         return push_wait_until( value,
-                                std::chrono::steady_clock::now() + timeout_duration);
+                                detail::timeout_clock::now() + timeout_duration);
     }
 
     template< typename Rep, typename Period >
     channel_op_status push_wait_for( value_type && value,
                                      std::chrono::duration< Rep, Period > const& timeout_duration) {
         return push_wait_until( std::forward< value_type >( value),
-                                std::chrono::steady_clock::now() + timeout_duration);
+                                detail::timeout_clock::now() + timeout_duration);
     }
 
     template< typename Clock, typename Duration >
@@ -324,7 +325,7 @@ public:
     channel_op_status pop_wait_for( value_type & value,
                                     std::chrono::duration< Rep, Period > const& timeout_duration) {
         return pop_wait_until( value,
-                               std::chrono::steady_clock::now() + timeout_duration);
+                               detail::timeout_clock::now() + timeout_duration);
     }
 
     template< typename Clock, typename Duration >
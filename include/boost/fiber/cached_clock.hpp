@@ -0,0 +1,59 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_CACHED_CLOCK_H
+#define BOOST_FIBERS_CACHED_CLOCK_H
+
+#include <chrono>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+// coarse steady clock: returns the time cached by the scheduler of the
+// calling thread, refreshed once per iteration of the dispatcher-context
+// (e.g. after the thread has been resumed from algorithm::suspend_until())
+// and when a fiber returns from a timed wait
+// time points are std::chrono::steady_clock time points, the value lags
+// behind std::chrono::steady_clock::now() by at most the time the fibers
+// of this thread run without passing control to the dispatcher-context
+struct BOOST_FIBERS_DECL cached_clock {
+    typedef std::chrono::steady_clock::rep          rep;
+    typedef std::chrono::steady_clock::period       period;
+    typedef std::chrono::steady_clock::duration     duration;
+    typedef std::chrono::steady_clock::time_point   time_point;
+
+    static constexpr bool is_steady = true;
+
+    static time_point now() noexcept;
+};
+
+namespace detail {
+
+// clock used to convert relative timeouts (`*_wait_for()`, sleep_for()) to
+// deadlines; with BOOST_FIBERS_COARSE_TIMEOUTS a timeout might expire early
+// by the lag of cached_clock
+#if defined(BOOST_FIBERS_COARSE_TIMEOUTS)
+typedef cached_clock                timeout_clock;
+#else
+typedef std::chrono::steady_clock   timeout_clock;
+#endif
+
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_CACHED_CLOCK_H
@@ -17,6 +17,7 @@
 #include <boost/config.hpp>
 #include <boost/context/detail/config.hpp>
 
+#include <boost/fiber/cached_clock.hpp>
 #include <boost/fiber/context.hpp>
 #include <boost/fiber/detail/config.hpp>
 #include <boost/fiber/detail/convert.hpp>
@@ -62,6 +63,13 @@ public:
 
     void notify_all() noexcept;
 
+    // a woken fiber of this thread is resumed at once, the calling fiber is
+    // put into the ready-queue; should be called without holding the lock
+    // the waiter has to re-acquire
+    void notify_one_and_yield() noexcept;
+
+    void notify_all_and_yield() noexcept;
+
     template< typename LockType >
     void wait( LockType & lt) {
         context * active_ctx = context::active();
@@ -130,13 +138,13 @@ public:
     template< typename LockType, typename Rep, typename Period >
     cv_status wait_for( LockType & lt, std::chrono::duration< Rep, Period > const& timeout_duration) {
         return wait_until( lt,
-                           std::chrono::steady_clock::now() + timeout_duration);
+                           detail::timeout_clock::now() + timeout_duration);
     }
 
     template< typename LockType, typename Rep, typename Period, typename Pred >
     bool wait_for( LockType & lt, std::chrono::duration< Rep, Period > const& timeout_duration, Pred pred) {
         return wait_until( lt,
-                           std::chrono::steady_clock::now() + timeout_duration,
+                           detail::timeout_clock::now() + timeout_duration,
                            pred);
     }
 };
@@ -159,6 +167,14 @@ public:
         cnd_.notify_all();
     }
 
+    void notify_one_and_yield() noexcept {
+        cnd_.notify_one_and_yield();
+    }
+
+    void notify_all_and_yield() noexcept {
+        cnd_.notify_all_and_yield();
+    }
+
     void wait( std::unique_lock< mutex > & lt) {
         // pre-condition
         BOOST_ASSERT( lt.owns_lock() );
@@ -9,15 +9,16 @@
 
 #include <atomic>
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <exception>
 #include <functional>
 #include <iostream>
-#include <map>
 #include <memory>
 #include <tuple>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include <boost/assert.hpp>
 #include <boost/config.hpp>
@@ -38,6 +39,7 @@
 #include <boost/fiber/detail/decay_copy.hpp>
 #include <boost/fiber/detail/fss.hpp>
 #include <boost/fiber/detail/spinlock.hpp>
+#include <boost/fiber/detail/stack_cache.hpp>
 #include <boost/fiber/exceptions.hpp>
 #include <boost/fiber/fixedsize_stack.hpp>
 #include <boost/fiber/policy.hpp>
@@ -82,6 +84,14 @@ typedef intrusive::set_member_hook<
     >
 >                                       sleep_hook;
 
+struct timer_tag;
+typedef intrusive::list_member_hook<
+    intrusive::tag< timer_tag >,
+    intrusive::link_mode<
+        intrusive::auto_unlink
+    >
+>                                       timer_hook;
+
 struct worker_tag;
 typedef intrusive::list_member_hook<
     intrusive::tag< worker_tag >,
@@ -98,13 +108,33 @@ typedef intrusive::slist_member_hook<
     >
 >                                       terminated_hook;
 
-struct remote_ready_tag;
-typedef intrusive::slist_member_hook<
-    intrusive::tag< remote_ready_tag >,
-    intrusive::link_mode<
-        intrusive::safe_link
-    >
->                                       remote_ready_hook;
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+class context_mpsc_queue;
+
+// node of the intrusive MPSC remote-ready queue
+// unlinked nodes point to themselves
+class remote_ready_hook {
+private:
+    friend class context_mpsc_queue;
+
+    std::atomic< remote_ready_hook * >  next_;
+
+public:
+    remote_ready_hook() noexcept :
+        next_{ this } {
+    }
+
+    remote_ready_hook( remote_ready_hook const&) = delete;
+    remote_ready_hook & operator=( remote_ready_hook const&) = delete;
+
+    bool is_linked() const noexcept {
+        return this != next_.load( std::memory_order_relaxed);
+    }
+};
+#endif
+
+class timer_wheel;
+struct context_layout;
 
 }
 
@@ -114,17 +144,26 @@ private:
     friend class main_context;
     template< typename Fn, typename ... Arg > friend class worker_context;
     friend class scheduler;
+    friend class detail::timer_wheel;
+    friend struct detail::context_layout;
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+    friend class detail::context_mpsc_queue;
+#endif
 
     struct fss_data {
         void                                *   vp{ nullptr };
         detail::fss_cleanup_function::ptr_t     cleanup_function{};
+        // generation of the key the value was stored for, 0 if unused
+        std::size_t                             generation{ 0 };
 
         fss_data() = default;
 
         fss_data( void * vp_,
-                  detail::fss_cleanup_function::ptr_t fn) noexcept :
+                  detail::fss_cleanup_function::ptr_t fn,
+                  std::size_t generation_) noexcept :
             vp( vp_),
-            cleanup_function(std::move( fn)) {
+            cleanup_function(std::move( fn)),
+            generation( generation_) {
             BOOST_ASSERT( cleanup_function);
         }
 
@@ -133,42 +172,69 @@ private:
         }
     };
 
-    typedef std::map< uintptr_t, fss_data >             fss_data_t;
-
+    // members are grouped by access pattern; worker- and dispatcher-contexts
+    // are placed at a 256 byte boundary on top of their stack, so the groups
+    // map to cachelines:
+    //  - hot: read/written by the owning thread at each context switch
+    //  - remote wakeup: written by other threads waking the fiber
+    //  - join/terminate: locked by other threads joining the fiber
+    //  - cold: sleep, fss, bookkeeping of the scheduler
+    // hot
+    boost::context::fiber                               c_{};
+    scheduler                                       *   scheduler_{ nullptr };
+    detail::ready_hook                                  ready_hook_{};
+    fiber_properties                                *   properties_{ nullptr };
+    type                                                type_;
+    launch                                              policy_;
+    // set by the fiber itself (or before it is launched); read by thieves
+    // peeking at a ready queue, hence atomic
 #if ! defined(BOOST_FIBERS_NO_ATOMICS)
-    std::atomic< std::size_t >                          use_count_;
+    std::atomic< bool >                                 thread_affinity_{ false };
 #else
-    std::size_t                                         use_count_;
+    bool                                                thread_affinity_{ false };
 #endif
+    // properties_ constructed on top of the fiber's stack, not on the heap
+    bool                                                properties_in_place_{ false };
+    char                                                pad0_[cacheline_length];
+    // remote wakeup
 #if ! defined(BOOST_FIBERS_NO_ATOMICS)
+    std::atomic< std::size_t >                          use_count_;
     detail::remote_ready_hook                           remote_ready_hook_{};
+public:
+    std::atomic<size_t>                                 waker_epoch_{ 0 };
+private:
+#else
+    std::size_t                                         use_count_;
 #endif
+    char                                                pad1_[cacheline_length];
+    // join/terminate
     detail::spinlock                                    splk_{};
     bool                                                terminated_{ false };
     wait_queue                                          wait_queue_{};
-public:
-#if ! defined(BOOST_FIBERS_NO_ATOMICS)
-    std::atomic<size_t>                                 waker_epoch_{ 0 };
-#endif
-private:
-    scheduler                                       *   scheduler_{ nullptr };
-    fss_data_t                                          fss_data_{};
+    char                                                pad2_[cacheline_length];
+    // cold
+    std::chrono::steady_clock::time_point               tp_;
+    // woken by sleep2ready_() because the deadline has been reached
+    bool                                                timed_out_{ false };
     detail::sleep_hook                                  sleep_hook_{};
+    detail::timer_hook                                  timer_hook_{};
     waker                                               sleep_waker_{};
-    detail::ready_hook                                  ready_hook_{};
-    detail::terminated_hook                             terminated_hook_{};
     detail::worker_hook                                 worker_hook_{};
-    fiber_properties                                *   properties_{ nullptr };
-    boost::context::fiber                               c_{};
-    std::chrono::steady_clock::time_point               tp_;
-    type                                                type_;
-    launch                                              policy_;
+    detail::terminated_hook                             terminated_hook_{};
+    // slots of the first fiber_specific_ptrs are kept inline
+    fss_data                                            fss_data_[BOOST_FIBERS_FSS_INLINE_SLOTS]{};
+    std::vector< fss_data >                             fss_overflow_{};
+    // point in time the context became ready (BOOST_FIBERS_USE_STATISTICS)
+    std::chrono::steady_clock::time_point               ready_tp_{};
+
+    // nullptr if the overflow slots do not cover `index`
+    fss_data * fss_slot_( std::size_t index) noexcept;
 
     context( std::size_t initial_count, type t, launch policy) noexcept :
-        use_count_{ initial_count },
-        tp_{ (std::chrono::steady_clock::time_point::max)() },
         type_{ t },
-        policy_{ policy } {
+        policy_{ policy },
+        use_count_{ initial_count },
+        tp_{ (std::chrono::steady_clock::time_point::max)() } {
     }
 
 public:
@@ -285,6 +351,10 @@ public:
 
     bool wake(const size_t) noexcept;
 
+    bool wake_for_handoff( const size_t, context *&) noexcept;
+
+    void handoff( context *) noexcept;
+
     waker create_waker() noexcept {
         // this operation makes all previously created wakers to be outdated
         return { this, ++waker_epoch_ };
@@ -296,16 +366,46 @@ public:
         return type::none != ( type_ & t);
     }
 
-    void * get_fss_data( void const * vp) const;
+    bool thread_affinity() const noexcept {
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+        return thread_affinity_.load( std::memory_order_relaxed);
+#else
+        return thread_affinity_;
+#endif
+    }
+
+    void thread_affinity( bool affinity) noexcept {
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+        thread_affinity_.store( affinity, std::memory_order_relaxed);
+#else
+        thread_affinity_ = affinity;
+#endif
+    }
+
+    // main-, dispatcher-context or fiber bound to its thread:
+    // must never be detached/migrated
+    bool is_pinned() const noexcept {
+        return is_context( type::pinned_context) || thread_affinity();
+    }
+
+    void * get_fss_data( detail::fss_key const& key) const noexcept;
 
     void set_fss_data(
-        void const * vp,
+        detail::fss_key const& key,
         detail::fss_cleanup_function::ptr_t const& cleanup_fn,
         void * data,
         bool cleanup_existing);
 
     void set_properties( fiber_properties * props) noexcept;
 
+    // size of the properties attached to fibers by the scheduling algorithm
+    // of the running thread; 0 if it does not use properties
+    static std::size_t properties_size() noexcept;
+
+    // constructs the properties of `this` in `storage`, at least
+    // properties_size() bytes aligned for std::max_align_t
+    void construct_properties( void * storage);
+
     fiber_properties * get_properties() const noexcept {
         return properties_;
     }
@@ -338,13 +438,6 @@ public:
         lst.push_back( * this);
     }
 
-    template< typename List >
-    void remote_ready_link( List & lst) noexcept {
-        static_assert( std::is_same< typename List::value_traits::hook_type, detail::remote_ready_hook >::value, "not a remote-ready-queue");
-        BOOST_ASSERT( ! remote_ready_is_linked() );
-        lst.push_back( * this);
-    }
-
     template< typename Set >
     void sleep_link( Set & set) noexcept {
         static_assert( std::is_same< typename Set::value_traits::hook_type,detail::sleep_hook >::value, "not a sleep-queue");
@@ -352,6 +445,13 @@ public:
         set.insert( * this);
     }
 
+    template< typename List >
+    void timer_link( List & lst) noexcept {
+        static_assert( std::is_same< typename List::value_traits::hook_type, detail::timer_hook >::value, "not a timer-wheel slot");
+        BOOST_ASSERT( ! sleep_is_linked() );
+        lst.push_back( * this);
+    }
+
     template< typename List >
     void terminated_link( List & lst) noexcept {
         static_assert( std::is_same< typename List::value_traits::hook_type, detail::terminated_hook >::value, "not a terminated-queue");
@@ -490,24 +590,41 @@ static intrusive_ptr< context > make_worker_context_with_properties( launch poli
                                                      StackAlloc && salloc,
                                                      Fn && fn, Arg ... arg) {
     typedef worker_context< Fn, Arg ... >   context_t;
+    // stacks of some allocators are recycled by the stack-cache
+    typedef detail::stack_cache_adaptor< StackAlloc >  adaptor_t;
 
-    auto sctx = salloc.allocate();
+    typename adaptor_t::type salloc_ = adaptor_t::wrap( std::forward< StackAlloc >( salloc) );
+    auto sctx = salloc_.allocate();
     // reserve space for control structure
     void * storage = reinterpret_cast< void * >(
             ( reinterpret_cast< uintptr_t >( sctx.sp) - static_cast< uintptr_t >( sizeof( context_t) ) )
             & ~ static_cast< uintptr_t >( 0xff) );
+    // reserve space for the properties below the control structure
+    const std::size_t props_size = nullptr == properties ? context::properties_size() : 0;
+    void * props_storage = nullptr;
+    void * stack_top = storage;
+    if ( 0 != props_size) {
+        props_storage = reinterpret_cast< void * >(
+                ( reinterpret_cast< uintptr_t >( storage) - static_cast< uintptr_t >( props_size) )
+                & ~ static_cast< uintptr_t >( alignof( std::max_align_t) - 1) );
+        stack_top = props_storage;
+    }
     void * stack_bottom = reinterpret_cast< void * >(
             reinterpret_cast< uintptr_t >( sctx.sp) - static_cast< uintptr_t >( sctx.size) );
-    const std::size_t size = reinterpret_cast< uintptr_t >( storage) - reinterpret_cast< uintptr_t >( stack_bottom);
+    const std::size_t size = reinterpret_cast< uintptr_t >( stack_top) - reinterpret_cast< uintptr_t >( stack_bottom);
     // placement new of context on top of fiber's stack
-    return intrusive_ptr< context >{ 
+    intrusive_ptr< context > ctx{
             new ( storage) context_t{
                 policy,
                 properties,
-                boost::context::preallocated{ storage, size, sctx },
-                std::forward< StackAlloc >( salloc),
+                boost::context::preallocated{ stack_top, size, sctx },
+                std::forward< typename adaptor_t::type >( salloc_),
                 std::forward< Fn >( fn),
                 std::forward< Arg >( arg) ... } };
+    if ( nullptr != props_storage) {
+        ctx->construct_properties( props_storage);
+    }
+    return ctx;
 }
 
 template< typename StackAlloc, typename Fn, typename ... Arg >
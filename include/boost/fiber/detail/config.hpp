@@ -63,4 +63,16 @@
 # define BOOST_FIBERS_SPIN_BEFORE_YIELD 64
 #endif
 
+#if !defined(BOOST_FIBERS_SPMC_QUEUE_CAPACITY)
+# define BOOST_FIBERS_SPMC_QUEUE_CAPACITY 4096
+#endif
+
+#if !defined(BOOST_FIBERS_MPMC_QUEUE_CAPACITY)
+# define BOOST_FIBERS_MPMC_QUEUE_CAPACITY 16384
+#endif
+
+#if !defined(BOOST_FIBERS_FSS_INLINE_SLOTS)
+# define BOOST_FIBERS_FSS_INLINE_SLOTS 4
+#endif
+
 #endif // BOOST_FIBERS_DETAIL_CONFIG_H
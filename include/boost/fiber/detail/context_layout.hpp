@@ -0,0 +1,118 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_CONTEXT_LAYOUT_H
+#define BOOST_FIBERS_DETAIL_CONTEXT_LAYOUT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <vector>
+
+#include <boost/config.hpp>
+#include <boost/context/detail/config.hpp>
+
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+// reports size of class context and offsets of its members, grouped as
+// declared in context.hpp; used to verify that the members touched at each
+// context switch share one cacheline and that members written by other
+// threads do not share a cacheline with them
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+struct context_layout {
+    enum class group {
+        hot,
+        remote_wakeup,
+        join,
+        cold
+    };
+
+    struct member {
+        char const  *   name;
+        group           grp;
+        std::size_t     offset;
+        std::size_t     size;
+    };
+
+    static std::size_t size() noexcept {
+        return sizeof( context);
+    }
+
+    // offsets are taken from a living instance because context is not a
+    // standard-layout class (offsetof() is not applicable)
+    static std::vector< member > members( context const* ctx) {
+        std::vector< member > v;
+        auto add = [ctx,&v]( char const* name, group grp, void const* m, std::size_t size) {
+            v.push_back( member{ name, grp,
+                                 static_cast< std::size_t >(
+                                    reinterpret_cast< std::uintptr_t >( m) - reinterpret_cast< std::uintptr_t >( ctx) ),
+                                 size });
+        };
+#define BOOST_FIBERS_CONTEXT_MEMBER(m, grp) add( # m, grp, & ctx->m, sizeof( ctx->m) )
+        BOOST_FIBERS_CONTEXT_MEMBER( c_, group::hot);
+        BOOST_FIBERS_CONTEXT_MEMBER( scheduler_, group::hot);
+        BOOST_FIBERS_CONTEXT_MEMBER( ready_hook_, group::hot);
+        BOOST_FIBERS_CONTEXT_MEMBER( properties_, group::hot);
+        BOOST_FIBERS_CONTEXT_MEMBER( type_, group::hot);
+        BOOST_FIBERS_CONTEXT_MEMBER( policy_, group::hot);
+        BOOST_FIBERS_CONTEXT_MEMBER( thread_affinity_, group::hot);
+        BOOST_FIBERS_CONTEXT_MEMBER( properties_in_place_, group::hot);
+        BOOST_FIBERS_CONTEXT_MEMBER( use_count_, group::remote_wakeup);
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+        BOOST_FIBERS_CONTEXT_MEMBER( remote_ready_hook_, group::remote_wakeup);
+        BOOST_FIBERS_CONTEXT_MEMBER( waker_epoch_, group::remote_wakeup);
+#endif
+        BOOST_FIBERS_CONTEXT_MEMBER( splk_, group::join);
+        BOOST_FIBERS_CONTEXT_MEMBER( terminated_, group::join);
+        BOOST_FIBERS_CONTEXT_MEMBER( wait_queue_, group::join);
+        BOOST_FIBERS_CONTEXT_MEMBER( tp_, group::cold);
+        BOOST_FIBERS_CONTEXT_MEMBER( sleep_hook_, group::cold);
+        BOOST_FIBERS_CONTEXT_MEMBER( timer_hook_, group::cold);
+        BOOST_FIBERS_CONTEXT_MEMBER( sleep_waker_, group::cold);
+        BOOST_FIBERS_CONTEXT_MEMBER( worker_hook_, group::cold);
+        BOOST_FIBERS_CONTEXT_MEMBER( terminated_hook_, group::cold);
+        BOOST_FIBERS_CONTEXT_MEMBER( fss_data_, group::cold);
+        BOOST_FIBERS_CONTEXT_MEMBER( fss_overflow_, group::cold);
+        BOOST_FIBERS_CONTEXT_MEMBER( ready_tp_, group::cold);
+#undef BOOST_FIBERS_CONTEXT_MEMBER
+        return v;
+    }
+
+    // cacheline (relative to the first cacheline of `ctx`) a member starts in
+    static std::size_t line( context const* ctx, member const& m) noexcept {
+        return ( reinterpret_cast< std::uintptr_t >( ctx) + m.offset) / cacheline_length
+            - reinterpret_cast< std::uintptr_t >( ctx) / cacheline_length;
+    }
+
+    static void report( std::ostream & os, context const* ctx) {
+        static char const* names[] = { "hot", "remote wakeup", "join", "cold" };
+        os << "sizeof(context): " << size() << '\n';
+        for ( member const& m : members( ctx) ) {
+            os << std::left << std::setw( 20) << m.name
+               << std::setw( 15) << names[static_cast< int >( m.grp)]
+               << std::right << " offset " << std::setw( 4) << m.offset
+               << " size " << std::setw( 3) << m.size
+               << " line " << line( ctx, m) << '\n';
+        }
+    }
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_CONTEXT_LAYOUT_H
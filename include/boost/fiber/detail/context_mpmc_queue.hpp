@@ -0,0 +1,143 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_CONTEXT_MPMC_QUEUE_H
+#define BOOST_FIBERS_DETAIL_CONTEXT_MPMC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/context/detail/config.hpp>
+
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+// Dmitry Vyukov. Bounded MPMC queue.
+// http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+//
+// FIFO ring buffer, each slot carries a sequence number telling producers
+// and consumers whether the slot is free or filled for the current lap;
+// push() and pop() claim a slot with one CAS on the enqueue-/dequeue-position
+// the capacity is rounded up to a power of two, push() fails if the queue is
+// full
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+class context_mpmc_queue {
+private:
+    struct slot {
+        std::atomic< std::size_t >      sequence{ 0 };
+        context                     *   ctx{ nullptr };
+    };
+
+    std::size_t                                     mask_;
+    std::unique_ptr< slot[] >                       slots_;
+    char                                            pad0_[cacheline_length];
+    // written by producers
+    std::atomic< std::size_t >                      enqueue_pos_{ 0 };
+    char                                            pad1_[cacheline_length];
+    // written by consumers
+    std::atomic< std::size_t >                      dequeue_pos_{ 0 };
+    char                                            pad2_[cacheline_length];
+
+    static std::size_t round_up_( std::size_t capacity) noexcept {
+        std::size_t n = 2;
+        while ( n < capacity) {
+            n <<= 1;
+        }
+        return n;
+    }
+
+public:
+    context_mpmc_queue( std::size_t capacity) :
+        mask_{ round_up_( capacity) - 1 },
+        slots_{ new slot[mask_ + 1] } {
+        for ( std::size_t i = 0; i <= mask_; ++i) {
+            slots_[i].sequence.store( i, std::memory_order_relaxed);
+        }
+    }
+
+    context_mpmc_queue( context_mpmc_queue const&) = delete;
+    context_mpmc_queue & operator=( context_mpmc_queue const&) = delete;
+
+    std::size_t capacity() const noexcept {
+        return mask_ + 1;
+    }
+
+    // might be stale if other threads push or pop concurrently
+    bool empty() const noexcept {
+        return dequeue_pos_.load( std::memory_order_relaxed) >=
+               enqueue_pos_.load( std::memory_order_relaxed);
+    }
+
+    // returns false if the queue is full
+    bool push( context * ctx) noexcept {
+        BOOST_ASSERT( nullptr != ctx);
+        std::size_t pos = enqueue_pos_.load( std::memory_order_relaxed);
+        for (;;) {
+            slot & s = slots_[pos & mask_];
+            std::size_t seq = s.sequence.load( std::memory_order_acquire);
+            std::intptr_t diff = static_cast< std::intptr_t >( seq) - static_cast< std::intptr_t >( pos);
+            if ( 0 == diff) {
+                // slot is free in this lap
+                if ( enqueue_pos_.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed) ) {
+                    s.ctx = ctx;
+                    // publish the context
+                    s.sequence.store( pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if ( 0 > diff) {
+                // slot still filled from the previous lap
+                return false;
+            } else {
+                // another producer has claimed the slot
+                pos = enqueue_pos_.load( std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // returns nullptr if the queue is empty
+    context * pop() noexcept {
+        std::size_t pos = dequeue_pos_.load( std::memory_order_relaxed);
+        for (;;) {
+            slot & s = slots_[pos & mask_];
+            std::size_t seq = s.sequence.load( std::memory_order_acquire);
+            std::intptr_t diff = static_cast< std::intptr_t >( seq) - static_cast< std::intptr_t >( pos + 1);
+            if ( 0 == diff) {
+                // slot is filled in this lap
+                if ( dequeue_pos_.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed) ) {
+                    context * ctx = s.ctx;
+                    // free the slot for the next lap
+                    s.sequence.store( pos + mask_ + 1, std::memory_order_release);
+                    return ctx;
+                }
+            } else if ( 0 > diff) {
+                // queue is empty (or a producer has not published yet)
+                return nullptr;
+            } else {
+                // another consumer has claimed the slot
+                pos = dequeue_pos_.load( std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_CONTEXT_MPMC_QUEUE_H
@@ -0,0 +1,118 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_CONTEXT_MPSC_QUEUE_H
+#define BOOST_FIBERS_DETAIL_CONTEXT_MPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/context/detail/config.hpp>
+#include <boost/intrusive/parent_from_member.hpp>
+
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+// Dmitry Vyukov. Intrusive MPSC node-based queue.
+// http://www.1024cores.net/home/lock-free-algorithms/queues/intrusive-mpsc-node-based-queue
+//
+// push() is wait-free (one atomic exchange), pop() is lock-free and must be
+// called only by the thread owning the queue
+// the queue is intrusive, nodes are the remote_ready_hook_ members of context
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+class context_mpsc_queue {
+private:
+    // written by producers
+    std::atomic< remote_ready_hook * >      head_;
+    char                                    pad_[cacheline_length];
+    // owned by the consumer
+    remote_ready_hook                   *   tail_;
+    remote_ready_hook                       stub_{};
+
+    static context * to_context_( remote_ready_hook * n) noexcept {
+        return intrusive::get_parent_from_member< context, remote_ready_hook >(
+                n, & context::remote_ready_hook_);
+    }
+
+    void push_( remote_ready_hook * n) noexcept {
+        n->next_.store( nullptr, std::memory_order_relaxed);
+        remote_ready_hook * prev = head_.exchange( n, std::memory_order_acq_rel);
+        // the queue is inconsistent until the link is published
+        prev->next_.store( n, std::memory_order_release);
+    }
+
+public:
+    context_mpsc_queue() noexcept :
+        head_{ & stub_ },
+        tail_{ & stub_ } {
+        stub_.next_.store( nullptr, std::memory_order_relaxed);
+    }
+
+    context_mpsc_queue( context_mpsc_queue const&) = delete;
+    context_mpsc_queue & operator=( context_mpsc_queue const&) = delete;
+
+    // might be called from any thread
+    void push( context * ctx) noexcept {
+        BOOST_ASSERT( nullptr != ctx);
+        BOOST_ASSERT( ! ctx->remote_ready_is_linked() );
+        push_( & ctx->remote_ready_hook_);
+    }
+
+    // consumer only; one relaxed load of a cacheline that is only written
+    // by producers if the queue was empty before
+    bool empty() const noexcept {
+        return & stub_ == tail_ &&
+               nullptr == stub_.next_.load( std::memory_order_relaxed);
+    }
+
+    // consumer only; returns nullptr if the queue is empty or if a producer
+    // has not yet finished its push()
+    context * pop() noexcept {
+        remote_ready_hook * tail = tail_;
+        remote_ready_hook * next = tail->next_.load( std::memory_order_acquire);
+        if ( & stub_ == tail) {
+            if ( nullptr == next) {
+                return nullptr;
+            }
+            tail_ = next;
+            tail = next;
+            next = next->next_.load( std::memory_order_acquire);
+        }
+        if ( nullptr == next) {
+            if ( tail != head_.load( std::memory_order_acquire) ) {
+                // a producer is in the middle of push()
+                return nullptr;
+            }
+            // re-insert stub so that tail can be dequeued
+            push_( & stub_);
+            next = tail->next_.load( std::memory_order_acquire);
+            if ( nullptr == next) {
+                return nullptr;
+            }
+        }
+        tail_ = next;
+        // mark node as unlinked
+        tail->next_.store( tail, std::memory_order_relaxed);
+        return to_context_( tail);
+    }
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_CONTEXT_MPSC_QUEUE_H
@@ -8,6 +8,7 @@
 #ifndef BOOST_FIBERS_DETAIL_SPINLOCK_QUEUE_H
 #define BOOST_FIBERS_DETAIL_SPINLOCK_QUEUE_H
 
+#include <algorithm>
 #include <cstddef>
 #include <cstring>
 #include <mutex>
@@ -85,6 +86,18 @@ public:
 		pidx_ = (pidx_ + 1) % capacity_;
 	}
 
+    // pushes `n` contexts under one lock
+    void push_n( context ** ctxs, std::size_t n) {
+        spinlock_lock lk{ splk_ };
+        for ( std::size_t i = 0; i < n; ++i) {
+            if ( is_full_() ) {
+                resize_();
+            }
+            slots_[pidx_] = ctxs[i];
+            pidx_ = (pidx_ + 1) % capacity_;
+        }
+    }
+
 	context * pop() {
         spinlock_lock lk{ splk_ };
 		context * c = nullptr;
@@ -100,13 +113,37 @@ public:
 		context * c = nullptr;
 		if ( ! is_empty_() ) {
 			c = slots_[cidx_];
-            if ( c->is_context( type::pinned_context) ) {
+            if ( c->is_pinned() ) {
                 return nullptr;
             }
 			cidx_ = (cidx_ + 1) % capacity_;
 		}
 		return c;
 	}
+
+    // steal() would succeed
+    bool stealable() const noexcept {
+        spinlock_lock lk{ splk_ };
+        return ! is_empty_() && ! slots_[cidx_]->is_pinned();
+    }
+
+    // steals half of the queued contexts (rounded up), at most `max`,
+    // under one lock; stops at the first pinned context
+    std::size_t steal_half( context ** ctxs, std::size_t max) {
+        spinlock_lock lk{ splk_ };
+        std::size_t size = (pidx_ + capacity_ - cidx_) % capacity_;
+        std::size_t n = (std::min)( (size + 1) / 2, max);
+        std::size_t i = 0;
+        for ( ; i < n; ++i) {
+            context * c = slots_[cidx_];
+            if ( c->is_pinned() ) {
+                break;
+            }
+            ctxs[i] = c;
+            cidx_ = (cidx_ + 1) % capacity_;
+        }
+        return i;
+    }
 };
 
 }}}
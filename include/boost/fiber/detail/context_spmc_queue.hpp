@@ -7,12 +7,14 @@
 #ifndef BOOST_FIBERS_DETAIL_CONTEXT_SPMC_QUEUE_H
 #define BOOST_FIBERS_DETAIL_CONTEXT_SPMC_QUEUE_H
 
+#include <algorithm>
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include <boost/assert.hpp>
 #include <boost/config.hpp>
@@ -29,6 +31,13 @@
 // Correct and efficient work-stealing for weak memory models.
 // In Proceedings of the 18th ACM SIGPLAN symposium on Principles and practice
 // of parallel programming (PPoPP '13). ACM, New York, NY, USA, 69-80.
+//
+// arrays replaced by growing or shrinking are retired and released by the
+// owner after all thieves that might still read them have finished
+// (epoch-based reclamation): a thief announces itself in the reader counter
+// of the current epoch; the owner advances the epoch only if the readers of
+// the previous epoch have finished, an array retired in epoch `e` is
+// released in epoch `e + 2`
 
 #if BOOST_COMP_CLANG
 #pragma clang diagnostic push
@@ -81,8 +90,9 @@ private:
                     ->load( std::memory_order_relaxed);
         }
 
-        array * resize( std::size_t bottom, std::size_t top) {
-            std::unique_ptr< array > tmp{ new array{ 2 * capacity_ } };
+        array * resize( std::size_t capacity, std::size_t bottom, std::size_t top) {
+            BOOST_ASSERT( bottom - top < capacity);
+            std::unique_ptr< array > tmp{ new array{ capacity } };
             for ( std::size_t i = top; i != bottom; ++i) {
                 tmp->push( i, pop( i) );
             }
@@ -90,21 +100,92 @@ private:
         }
     };
 
+    struct retired_array {
+        array       *   a;
+        std::size_t     epoch;
+    };
+
     std::atomic< std::size_t >     top_{ 0 };
     std::atomic< std::size_t >     bottom_{ 0 };
     std::atomic< array * >         array_;
-    std::vector< array * >                                  old_arrays_{};
+    std::size_t                                             min_capacity_;
+    // number of consecutive pops with low occupancy
+    std::size_t                                             low_occupancy_{ 0 };
+    std::vector< retired_array >                                retired_{};
+    std::atomic< std::size_t >                              epoch_{ 0 };
+    mutable std::atomic< std::size_t >                      readers_[2];
     char                                                    padding_[cacheline_length];
 
+    std::size_t enter_() const noexcept {
+        std::size_t epoch = epoch_.load( std::memory_order_seq_cst);
+        readers_[epoch & 1].fetch_add( 1, std::memory_order_seq_cst);
+        return epoch;
+    }
+
+    void leave_( std::size_t epoch) const noexcept {
+        readers_[epoch & 1].fetch_sub( 1, std::memory_order_release);
+    }
+
+    void replace_( array * a, std::size_t capacity, std::size_t bottom, std::size_t top) {
+        retired_.reserve( retired_.size() + 1);
+        array * tmp = a->resize( capacity, bottom, top);
+        // a thief entering after reclaim_() has checked the reader counters
+        // loads `tmp`
+        array_.store( tmp, std::memory_order_seq_cst);
+        retired_.push_back( retired_array{ a, epoch_.load( std::memory_order_relaxed) });
+        low_occupancy_ = 0;
+    }
+
+    void reclaim_() noexcept {
+        std::size_t epoch = epoch_.load( std::memory_order_relaxed);
+        // advance only if the counter reused by the next epoch has drained
+        if ( 0 == readers_[( epoch + 1) & 1].load( std::memory_order_seq_cst) ) {
+            epoch_.store( ++epoch, std::memory_order_seq_cst);
+        }
+        std::size_t n = 0;
+        while ( n < retired_.size() && retired_[n].epoch + 2 <= epoch) {
+            delete retired_[n].a;
+            ++n;
+        }
+        retired_.erase( retired_.begin(), retired_.begin() + n);
+    }
+
+    // shrink if less than a quarter of the array was occupied during as many
+    // pops as the array has slots (amortizes the copy)
+    void shrink_() noexcept {
+        array * a = array_.load( std::memory_order_relaxed);
+        std::size_t capacity = a->capacity();
+        if ( capacity <= min_capacity_) {
+            return;
+        }
+        std::size_t bottom = bottom_.load( std::memory_order_relaxed);
+        std::size_t top = top_.load( std::memory_order_acquire);
+        if ( capacity / 4 <= bottom - top) {
+            low_occupancy_ = 0;
+            return;
+        }
+        if ( ++low_occupancy_ < capacity) {
+            return;
+        }
+        try {
+            replace_( a, (std::max)( capacity / 2, min_capacity_), bottom, top);
+        } catch (...) {
+            // keep the larger array
+            low_occupancy_ = 0;
+        }
+    }
+
 public:
-    context_spmc_queue( std::size_t capacity = 4096) :
-        array_{ new array{ capacity } } {
-        old_arrays_.reserve( 32);
+    context_spmc_queue( std::size_t capacity = BOOST_FIBERS_SPMC_QUEUE_CAPACITY) :
+        array_{ new array{ (std::max)( capacity, std::size_t{ 2 }) } },
+        min_capacity_{ (std::max)( capacity, std::size_t{ 2 }) } {
+        readers_[0].store( 0, std::memory_order_relaxed);
+        readers_[1].store( 0, std::memory_order_relaxed);
     }
 
     ~context_spmc_queue() {
-        for ( array * a : old_arrays_) {
-            delete a;
+        for ( retired_array & r : retired_) {
+            delete r.a;
         }
         delete array_.load();
     }
@@ -112,6 +193,16 @@ public:
     context_spmc_queue( context_spmc_queue const&) = delete;
     context_spmc_queue & operator=( context_spmc_queue const&) = delete;
 
+    // slots of the current array
+    std::size_t capacity() const noexcept {
+        return array_.load( std::memory_order_relaxed)->capacity();
+    }
+
+    // arrays waiting for thieves to finish
+    std::size_t retired() const noexcept {
+        return retired_.size();
+    }
+
     bool empty() const noexcept {
         std::size_t bottom = bottom_.load( std::memory_order_relaxed);
         std::size_t top = top_.load( std::memory_order_relaxed);
@@ -125,18 +216,42 @@ public:
         if ( (a->capacity() - 1) < (bottom - top) ) {
             // queue is full
             // resize
-            array * tmp = a->resize( bottom, top);
-            old_arrays_.push_back( a);
-            std::swap( a, tmp);
-            array_.store( a, std::memory_order_relaxed);
+            replace_( a, 2 * a->capacity(), bottom, top);
+            a = array_.load( std::memory_order_relaxed);
         }
         a->push( bottom, ctx);
         std::atomic_thread_fence( std::memory_order_release);
         bottom_.store( bottom + 1, std::memory_order_relaxed);
     }
 
+    // pushes `n` contexts, published to thieves by a single store of bottom
+    void push_n( context ** ctxs, std::size_t n) {
+        if ( 0 == n) {
+            return;
+        }
+        std::size_t bottom = bottom_.load( std::memory_order_relaxed);
+        std::size_t top = top_.load( std::memory_order_acquire);
+        array * a = array_.load( std::memory_order_relaxed);
+        while ( (a->capacity() - 1) < (bottom - top + n - 1) ) {
+            // queue would overflow
+            // resize
+            replace_( a, 2 * a->capacity(), bottom, top);
+            a = array_.load( std::memory_order_relaxed);
+        }
+        for ( std::size_t i = 0; i < n; ++i) {
+            a->push( bottom + i, ctxs[i]);
+        }
+        std::atomic_thread_fence( std::memory_order_release);
+        bottom_.store( bottom + n, std::memory_order_relaxed);
+    }
+
     context * pop() {
-        std::size_t bottom = bottom_.load( std::memory_order_relaxed) - 1;
+        std::size_t bottom = bottom_.load( std::memory_order_relaxed);
+        if ( 0 == bottom) {
+            // nothing pushed yet, `bottom - 1` would wrap around
+            return nullptr;
+        }
+        --bottom;
         array * a = array_.load( std::memory_order_relaxed);
         bottom_.store( bottom, std::memory_order_relaxed);
         std::atomic_thread_fence( std::memory_order_seq_cst);
@@ -160,32 +275,75 @@ public:
             // queue is empty
             bottom_.store( bottom + 1, std::memory_order_relaxed);
         }
+        shrink_();
+        if ( ! retired_.empty() ) {
+            reclaim_();
+        }
         return ctx;
     }
 
     context * steal() {
+        std::size_t epoch = enter_();
         std::size_t top = top_.load( std::memory_order_acquire);
         std::atomic_thread_fence( std::memory_order_seq_cst);
         std::size_t bottom = bottom_.load( std::memory_order_acquire);
         context * ctx = nullptr;
         if ( top < bottom) {
             // queue is not empty
-            array * a = array_.load( std::memory_order_consume);
+            array * a = array_.load( std::memory_order_seq_cst);
             ctx = a->pop( top);
-            BOOST_ASSERT( nullptr != ctx);
-            // do not steal pinned context (e.g. main-/dispatcher-context)
-            if ( ctx->is_context( type::pinned_context) ) {
-                return nullptr;
-            }
-            if ( ! top_.compare_exchange_strong( top, top + 1,
-                                                 std::memory_order_seq_cst,
-                                                 std::memory_order_relaxed) ) {
+            // nullptr: `top` was taken and the array replaced meanwhile
+            // do not steal pinned context (main-/dispatcher-context, fiber bound to its thread)
+            if ( nullptr == ctx || ctx->is_pinned() ) {
+                ctx = nullptr;
+            } else if ( ! top_.compare_exchange_strong( top, top + 1,
+                                                        std::memory_order_seq_cst,
+                                                        std::memory_order_relaxed) ) {
                 // lose the race
-                return nullptr;
+                ctx = nullptr;
             }
         }
+        leave_( epoch);
         return ctx;
     }
+
+    // steal() would succeed, if not raced by the owner or another thief
+    bool stealable() const noexcept {
+        std::size_t epoch = enter_();
+        std::size_t top = top_.load( std::memory_order_acquire);
+        std::atomic_thread_fence( std::memory_order_seq_cst);
+        std::size_t bottom = bottom_.load( std::memory_order_acquire);
+        bool result = false;
+        if ( top < bottom) {
+            context * ctx = array_.load( std::memory_order_seq_cst)->pop( top);
+            result = nullptr != ctx && ! ctx->is_pinned();
+        }
+        leave_( epoch);
+        return result;
+    }
+
+    // steals half of the queued contexts (rounded up), at most `max`;
+    // a batch can not be claimed by one CAS on `top_` because the owner
+    // pops from the bottom without CAS as long as more than one context is
+    // queued, hence the contexts are stolen one by one
+    std::size_t steal_half( context ** ctxs, std::size_t max) {
+        std::size_t top = top_.load( std::memory_order_acquire);
+        std::atomic_thread_fence( std::memory_order_seq_cst);
+        std::size_t bottom = bottom_.load( std::memory_order_acquire);
+        if ( bottom <= top) {
+            return 0;
+        }
+        std::size_t n = (std::min)( (bottom - top + 1) / 2, max);
+        std::size_t i = 0;
+        for ( ; i < n; ++i) {
+            context * ctx = steal();
+            if ( nullptr == ctx) {
+                break;
+            }
+            ctxs[i] = ctx;
+        }
+        return i;
+    }
 };
 
 }}}
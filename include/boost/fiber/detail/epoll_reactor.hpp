@@ -0,0 +1,109 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_EPOLL_REACTOR_H
+#define BOOST_FIBERS_DETAIL_EPOLL_REACTOR_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <unordered_map>
+
+#include <boost/config.hpp>
+#include <boost/predef.h>
+
+#include <boost/fiber/detail/config.hpp>
+
+#if ! BOOST_OS_LINUX
+# error "boost fiber: the epoll reactor is available only on Linux"
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace boost {
+namespace fibers {
+
+class waker;
+
+namespace detail {
+
+// waits for readiness of file descriptors via epoll(7)
+//
+// owned by the scheduling algorithm of one thread (epoll_round_robin,
+// epoll_work_stealing); fibers running on this thread park on a file
+// descriptor with wait(), the algorithm calls poll() while it looks for ready
+// fibers and if it suspends the thread
+// descriptors are registered with EPOLLONESHOT, e.g. a descriptor is
+// re-armed only while a fiber waits on it; the entry of a descriptor is kept
+// till forget() is called
+class BOOST_FIBERS_DECL epoll_reactor {
+private:
+    struct descriptor {
+        waker       *   reader{ nullptr };
+        waker       *   writer{ nullptr };
+        bool            registered{ false };
+    };
+
+    int                                     epfd_;
+    int                                     efd_;
+    std::atomic< bool >                     notified_{ false };
+    std::size_t                             waiting_{ 0 };
+    std::unordered_map< int, descriptor >   descriptors_{};
+
+    bool arm_( int, descriptor &) noexcept;
+
+public:
+    // reactor of the calling thread, nullptr if the scheduling algorithm of
+    // this thread is not epoll based
+    static epoll_reactor * current() noexcept;
+
+    epoll_reactor();
+
+    ~epoll_reactor();
+
+    epoll_reactor( epoll_reactor const&) = delete;
+    epoll_reactor & operator=( epoll_reactor const&) = delete;
+
+    // true if at least one fiber waits for a descriptor
+    bool waiting() const noexcept {
+        return 0 != waiting_;
+    }
+
+    // waits at most `timeout_ms` milliseconds (-1: infinite) for ready
+    // descriptors or a call of notify() and wakes the waiting fibers
+    void poll( int timeout_ms) noexcept;
+
+    void run_until( std::chrono::steady_clock::time_point const&) noexcept;
+
+    // interrupts poll(), might be called from any thread
+    void notify() noexcept;
+
+    // suspends the active fiber till `fd` becomes readable (writable) or
+    // `timeout_time` has been reached; returns false on timeout
+    bool wait( int fd, bool writable, std::chrono::steady_clock::time_point const& timeout_time);
+
+    // erases the entry of `fd` and its registration, to be called before `fd`
+    // is closed; throws if a fiber waits for `fd`
+    void forget( int fd);
+};
+
+}}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_EPOLL_REACTOR_H
@@ -15,6 +15,8 @@
 #include <boost/config.hpp>
 #include <boost/intrusive_ptr.hpp>
 
+#include <boost/fiber/detail/config.hpp>
+
 #ifdef BOOST_HAS_ABI_HEADERS
 #  include BOOST_ABI_PREFIX
 #endif
@@ -50,6 +52,31 @@ public:
     }
 };
 
+// dense slot index of a fiber_specific_ptr; indices of destroyed keys are
+// reused, the generation tells values stored for a previous owner of the
+// slot apart
+class BOOST_FIBERS_DECL fss_key {
+private:
+    std::size_t     index_;
+    std::size_t     generation_;
+
+public:
+    fss_key();
+
+    ~fss_key();
+
+    fss_key( fss_key const&) = delete;
+    fss_key & operator=( fss_key const&) = delete;
+
+    std::size_t index() const noexcept {
+        return index_;
+    }
+
+    std::size_t generation() const noexcept {
+        return generation_;
+    }
+};
+
 }}}
 
 #ifdef BOOST_HAS_ABI_HEADERS
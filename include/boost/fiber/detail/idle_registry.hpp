@@ -0,0 +1,114 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_IDLE_REGISTRY_H
+#define BOOST_FIBERS_DETAIL_IDLE_REGISTRY_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+// parked workers of a work-stealing pool (modeled on the spinning threads of
+// the Go runtime): a worker pushing stealable work wakes one parked peer,
+// unless a woken peer is still searching for work; a searching peer that
+// finds work wakes the next one, hence wake-ups propagate with the amount of
+// surplus work instead of waking all peers at once
+//
+// lost wake-ups are prevented by Dekker-style ordering: a worker registers
+// as parked and re-checks its peers for stealable work before it sleeps, a
+// worker pushing work issues a full fence before it looks for parked peers
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+class idle_registry {
+private:
+    spinlock                        splk_{};
+    std::vector< std::uint32_t >    ids_{};
+    std::atomic< std::size_t >      parked_{ 0 };
+    std::atomic< std::size_t >      searching_{ 0 };
+
+public:
+    idle_registry() = default;
+
+    idle_registry( idle_registry const&) = delete;
+    idle_registry & operator=( idle_registry const&) = delete;
+
+    // park() must not allocate
+    void reserve( std::size_t n) {
+        spinlock_lock lk{ splk_ };
+        ids_.reserve( n);
+    }
+
+    void park( std::uint32_t id) noexcept {
+        spinlock_lock lk{ splk_ };
+        BOOST_ASSERT( ids_.size() < ids_.capacity() );
+        BOOST_ASSERT( ids_.end() == std::find( ids_.begin(), ids_.end(), id) );
+        ids_.push_back( id);
+        parked_.fetch_add( 1, std::memory_order_seq_cst);
+        lk.unlock();
+        std::atomic_thread_fence( std::memory_order_seq_cst);
+    }
+
+    // returns false if the worker was taken by wake_one() meanwhile, the
+    // worker is searching then
+    bool unpark( std::uint32_t id) noexcept {
+        spinlock_lock lk{ splk_ };
+        auto i = std::find( ids_.begin(), ids_.end(), id);
+        if ( ids_.end() == i) {
+            return false;
+        }
+        ids_.erase( i);
+        parked_.fetch_sub( 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // selects a parked worker to be woken by the caller; the selected
+    // worker counts as searching
+    bool wake_one( std::uint32_t & id) noexcept {
+        std::atomic_thread_fence( std::memory_order_seq_cst);
+        if ( 0 == parked_.load( std::memory_order_relaxed) ||
+             0 != searching_.load( std::memory_order_relaxed) ) {
+            return false;
+        }
+        spinlock_lock lk{ splk_ };
+        if ( ids_.empty() ) {
+            return false;
+        }
+        // most recently parked worker, its caches are still warm
+        id = ids_.back();
+        ids_.pop_back();
+        parked_.fetch_sub( 1, std::memory_order_relaxed);
+        searching_.fetch_add( 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // a woken worker has found work or parks again
+    void searched() noexcept {
+        BOOST_ASSERT( 0 < searching_.load( std::memory_order_relaxed) );
+        searching_.fetch_sub( 1, std::memory_order_relaxed);
+    }
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_IDLE_REGISTRY_H
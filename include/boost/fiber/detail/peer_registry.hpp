@@ -0,0 +1,116 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_PEER_REGISTRY_H
+#define BOOST_FIBERS_DETAIL_PEER_REGISTRY_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <system_error>
+#include <thread>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/context/detail/config.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/idle_registry.hpp>
+#include <boost/fiber/detail/thread_barrier.hpp>
+#include <boost/fiber/exceptions.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+// schedulers of a work-stealing pool, indexed by id
+//
+// a scheduler leaves the pool if its thread terminates; peers access a
+// scheduler only between acquire() and release(), leave() waits till no
+// peer accesses the scheduler anymore (peers may be stealing concurrently)
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+template< typename Peer >
+class peer_registry {
+private:
+    struct slot {
+        std::atomic< Peer * >           peer{ nullptr };
+        std::atomic< std::size_t >      users{ 0 };
+        char                            padding[cacheline_length];
+    };
+
+    std::size_t                         size_;
+    std::unique_ptr< slot[] >           slots_;
+    thread_barrier                      barrier_;
+    idle_registry                       idle_{};
+
+public:
+    peer_registry( std::size_t size, std::size_t thread_count) :
+        size_{ size },
+        slots_{ new slot[size] },
+        barrier_{ thread_count } {
+        idle_.reserve( size);
+    }
+
+    peer_registry( peer_registry const&) = delete;
+    peer_registry & operator=( peer_registry const&) = delete;
+
+    std::size_t size() const noexcept {
+        return size_;
+    }
+
+    void join( std::uint32_t id, Peer * peer) {
+        Peer * expected = nullptr;
+        if ( BOOST_UNLIKELY( size_ <= id ||
+                             ! slots_[id].peer.compare_exchange_strong( expected, peer) ) ) {
+            throw fiber_error{ std::make_error_code( std::errc::invalid_argument),
+                               "boost fiber: work-stealing pool has no free slot" };
+        }
+    }
+
+    void leave( std::uint32_t id) noexcept {
+        slot & s = slots_[id];
+        s.peer.store( nullptr, std::memory_order_seq_cst);
+        while ( 0 != s.users.load( std::memory_order_seq_cst) ) {
+            std::this_thread::yield();
+        }
+    }
+
+    // returns nullptr if the scheduler has left (or not yet joined)
+    Peer * acquire( std::uint32_t id) noexcept {
+        slot & s = slots_[id];
+        s.users.fetch_add( 1, std::memory_order_seq_cst);
+        Peer * peer = s.peer.load( std::memory_order_seq_cst);
+        if ( nullptr == peer) {
+            s.users.fetch_sub( 1, std::memory_order_release);
+        }
+        return peer;
+    }
+
+    void release( std::uint32_t id) noexcept {
+        slots_[id].users.fetch_sub( 1, std::memory_order_release);
+    }
+
+    // all threads of the pool have joined
+    void wait() {
+        barrier_.wait();
+    }
+
+    idle_registry & idle() noexcept {
+        return idle_;
+    }
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_PEER_REGISTRY_H
@@ -0,0 +1,197 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_STACK_CACHE_H
+#define BOOST_FIBERS_DETAIL_STACK_CACHE_H
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/config.hpp>
+#include <boost/context/fixedsize_stack.hpp>
+#include <boost/context/protected_fixedsize_stack.hpp>
+#include <boost/context/stack_context.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+class statistics_counters;
+
+// stack allocators whose stacks might be recycled by the stack-cache
+// a cached stack is handed out only to an allocator of the same type with
+// the same state (`key()`); `deallocate()` must release a stack without the
+// allocator instance that has allocated it
+template< typename StackAlloc >
+struct stack_cache_traits {
+    static constexpr bool cacheable = false;
+};
+
+template< typename StackAlloc >
+struct stateless_stack_cache_traits {
+    static constexpr bool cacheable = true;
+
+    // the allocator stores nothing but the requested stack size
+    static std::size_t key( StackAlloc const& salloc) noexcept {
+        static_assert( sizeof( StackAlloc) == sizeof( std::size_t), "unexpected stack allocator layout");
+        static_assert( std::is_trivially_copyable< StackAlloc >::value, "unexpected stack allocator layout");
+        std::size_t k;
+        std::memcpy( & k, & salloc, sizeof( k) );
+        return k;
+    }
+
+    // deallocation depends only on the stack_context
+    static void deallocate( boost::context::stack_context & sctx) noexcept {
+        StackAlloc{}.deallocate( sctx);
+    }
+};
+
+template< typename Traits >
+struct stack_cache_traits< boost::context::basic_fixedsize_stack< Traits > > :
+    public stateless_stack_cache_traits< boost::context::basic_fixedsize_stack< Traits > > {
+};
+
+template< typename Traits >
+struct stack_cache_traits< boost::context::basic_protected_fixedsize_stack< Traits > > :
+    public stateless_stack_cache_traits< boost::context::basic_protected_fixedsize_stack< Traits > > {
+};
+
+// bounded cache of stacks released by terminated fibers of one thread
+// if the number of cached stacks reaches the high watermark, the oldest
+// stacks are returned to their allocator till the low watermark is reached
+class BOOST_FIBERS_DECL stack_cache {
+public:
+    typedef void ( * deallocate_fn)( boost::context::stack_context &);
+
+private:
+    struct entry {
+        deallocate_fn                   deallocate;
+        std::size_t                     key;
+        boost::context::stack_context   sctx;
+    };
+
+    std::vector< entry >                entries_{};
+    std::size_t                         high_watermark_{ 0 };
+    std::size_t                         low_watermark_{ 0 };
+    // hits/misses are counted only with BOOST_FIBERS_USE_STATISTICS
+    statistics_counters             *   stats_{ nullptr };
+
+    void shrink_( std::size_t) noexcept;
+
+public:
+    // stack-cache of the calling thread, nullptr if the thread has no scheduler
+    static stack_cache * current() noexcept;
+
+    static void current( stack_cache *) noexcept;
+
+    stack_cache() = default;
+
+    ~stack_cache();
+
+    stack_cache( stack_cache const&) = delete;
+    stack_cache & operator=( stack_cache const&) = delete;
+
+    void counters( statistics_counters * stats) noexcept {
+        stats_ = stats;
+    }
+
+    // a zero high watermark disables the cache
+    void set_watermarks( std::size_t high_watermark, std::size_t low_watermark);
+
+    std::size_t size() const noexcept {
+        return entries_.size();
+    }
+
+    // returns false on a miss
+    bool get( deallocate_fn, std::size_t key, boost::context::stack_context &) noexcept;
+
+    // returns false if the stack was not taken
+    bool put( deallocate_fn, std::size_t key, boost::context::stack_context &) noexcept;
+
+    void clear() noexcept;
+};
+
+// stack allocator passed to boost::context::fiber, serves stacks from the
+// stack-cache of the calling thread
+template< typename StackAlloc >
+class cached_stack_allocator {
+private:
+    typedef stack_cache_traits< StackAlloc >    traits_type;
+
+    StackAlloc          salloc_;
+
+public:
+    explicit cached_stack_allocator( StackAlloc && salloc) :
+        salloc_( std::move( salloc) ) {
+    }
+
+    explicit cached_stack_allocator( StackAlloc const& salloc) :
+        salloc_( salloc) {
+    }
+
+    boost::context::stack_context allocate() {
+        stack_cache * cache = stack_cache::current();
+        boost::context::stack_context sctx;
+        if ( nullptr != cache && cache->get( & traits_type::deallocate, traits_type::key( salloc_), sctx) ) {
+            return sctx;
+        }
+        return salloc_.allocate();
+    }
+
+    void deallocate( boost::context::stack_context & sctx) noexcept {
+        // the stack might be released on a thread different from the
+        // one that has allocated it
+        stack_cache * cache = stack_cache::current();
+        if ( nullptr != cache && cache->put( & traits_type::deallocate, traits_type::key( salloc_), sctx) ) {
+            return;
+        }
+        salloc_.deallocate( sctx);
+    }
+};
+
+template< typename StackAlloc,
+          bool = stack_cache_traits< typename std::decay< StackAlloc >::type >::cacheable >
+struct stack_cache_adaptor {
+    typedef StackAlloc &&   type;
+
+    static type wrap( StackAlloc && salloc) noexcept {
+        return std::forward< StackAlloc >( salloc);
+    }
+};
+
+template< typename StackAlloc >
+struct stack_cache_adaptor< StackAlloc, true > {
+    typedef cached_stack_allocator< typename std::decay< StackAlloc >::type >   type;
+
+    static type wrap( StackAlloc && salloc) {
+        return type{ std::forward< StackAlloc >( salloc) };
+    }
+};
+
+}}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_STACK_CACHE_H
@@ -0,0 +1,105 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_STATISTICS_H
+#define BOOST_FIBERS_DETAIL_STATISTICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include <boost/config.hpp>
+#include <boost/intrusive/list.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/statistics.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+// counter with a single writer (the thread owning the scheduler)
+// readers on other threads see a (relaxed) recent value
+class statistics_counter {
+private:
+    std::atomic< std::uint64_t >    value_{ 0 };
+
+public:
+    void add( std::uint64_t n = 1) noexcept {
+        value_.store( value_.load( std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    void sub( std::uint64_t n = 1) noexcept {
+        value_.store( value_.load( std::memory_order_relaxed) - n, std::memory_order_relaxed);
+    }
+
+    std::uint64_t load() const noexcept {
+        return value_.load( std::memory_order_relaxed);
+    }
+};
+
+// per scheduler counters, registered in a process-wide list
+// (registration neither allocates nor throws)
+class BOOST_FIBERS_DECL statistics_counters {
+public:
+    typedef intrusive::list_member_hook<
+        intrusive::link_mode< intrusive::safe_link >
+    >                                                       hook_type;
+
+    hook_type                       hook_{};
+    statistics_counter              context_switches{};
+    statistics_counter              yields{};
+    statistics_counter              local_wakeups{};
+    statistics_counter              remote_wakeups{};
+    statistics_counter              steals_attempted{};
+    statistics_counter              steals_succeeded{};
+    statistics_counter              sleeping{};
+    statistics_counter              suspends{};
+    statistics_counter              suspend_ns{};
+    statistics_counter              stack_cache_hits{};
+    statistics_counter              stack_cache_misses{};
+    statistics_counter              ready_delay[scheduler_statistics::histogram_buckets]{};
+
+    statistics_counters() noexcept;
+
+    ~statistics_counters();
+
+    statistics_counters( statistics_counters const&) = delete;
+    statistics_counters & operator=( statistics_counters const&) = delete;
+
+    void record_ready_delay( std::chrono::steady_clock::duration const& d) noexcept {
+        std::int64_t ns = std::chrono::duration_cast< std::chrono::nanoseconds >( d).count();
+        std::uint64_t v = 0 < ns ? static_cast< std::uint64_t >( ns) : 1;
+        // floor(log2(v))
+#if defined(__GNUC__) || defined(__clang__)
+        std::size_t bucket = 63 - static_cast< std::size_t >( __builtin_clzll( v) );
+#else
+        std::size_t bucket = 0;
+        while ( 1 < v) {
+            v >>= 1;
+            ++bucket;
+        }
+#endif
+        if ( scheduler_statistics::histogram_buckets <= bucket) {
+            bucket = scheduler_statistics::histogram_buckets - 1;
+        }
+        ready_delay[bucket].add();
+    }
+
+    void collect( scheduler_statistics &) const noexcept;
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_STATISTICS_H
@@ -0,0 +1,239 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_STEALING_PEER_H
+#define BOOST_FIBERS_DETAIL_STEALING_PEER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <random>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/idle_registry.hpp>
+#include <boost/fiber/detail/peer_registry.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+// the part of a work-stealing algorithm shared by work_stealing,
+// edf_work_stealing and numa::work_stealing: victim selection, waking
+// parked peers and parking
+//
+// `Peer` (the algorithm) provides
+//   Peer::steal_batch_size
+//   std::size_t steal_batch( context **, std::size_t) noexcept
+//   bool stealable_() const noexcept, steal_batch() would succeed
+//   void notify() noexcept, wakes the peer parked in suspend_until()
+
+namespace boost {
+namespace fibers {
+
+class context;
+
+namespace detail {
+
+template< typename Peer >
+class stealing_peer {
+private:
+    peer_registry< Peer >           &   registry_;
+    std::uint32_t                       id_;
+    // peer of the last successful steal, tried first; id_ if none
+    std::uint32_t                       last_victim_;
+    std::mutex                          mtx_{};
+    std::condition_variable             cnd_{};
+    bool                                flag_{ false };
+    // woken by a peer, looking for work to steal
+    bool                                searching_{ false };
+    bool                                suspend_;
+
+public:
+    stealing_peer( peer_registry< Peer > & registry, std::uint32_t id, bool suspend) noexcept :
+        registry_{ registry },
+        id_{ id },
+        last_victim_{ id },
+        suspend_{ suspend } {
+    }
+
+    stealing_peer( stealing_peer const&) = delete;
+    stealing_peer & operator=( stealing_peer const&) = delete;
+
+    std::uint32_t id() const noexcept {
+        return id_;
+    }
+
+    bool suspend() const noexcept {
+        return suspend_;
+    }
+
+    // id() if no steal has succeeded yet or the last victim had nothing left
+    std::uint32_t last_victim() const noexcept {
+        return last_victim_;
+    }
+
+    // new stealable work has been queued, a parked peer might run it
+    void pushed() noexcept {
+        if ( suspend_) {
+            wake_peer();
+        }
+    }
+
+    void wake_peer() noexcept {
+        idle_registry & idle = registry_.idle();
+        std::uint32_t id = 0;
+        if ( idle.wake_one( id) ) {
+            BOOST_ASSERT( id != id_);
+            Peer * peer = registry_.acquire( id);
+            if ( nullptr != peer) {
+                peer->notify();
+                registry_.release( id);
+            } else {
+                // the peer has left the pool
+                idle.searched();
+            }
+        }
+    }
+
+    // any other peer has stealable work
+    bool peers_stealable() const noexcept {
+        for ( std::uint32_t id = 0; id < registry_.size(); ++id) {
+            if ( id == id_) {
+                continue;
+            }
+            // empty slot if the peer has left (or never joined)
+            Peer * peer = registry_.acquire( id);
+            if ( nullptr != peer) {
+                bool stealable = peer->stealable_();
+                registry_.release( id);
+                if ( stealable) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    std::size_t steal_from( std::uint32_t id, context ** batch) noexcept {
+        Peer * peer = registry_.acquire( id);
+        if ( nullptr == peer) {
+            // the peer has left the pool
+            return 0;
+        }
+        std::size_t n = peer->steal_batch( batch, Peer::steal_batch_size);
+        registry_.release( id);
+        return n;
+    }
+
+    // a peer that had surplus contexts recently probably still has some;
+    // forgotten if it has none left
+    std::size_t steal_from_last_victim( context ** batch, std::size_t & count) noexcept {
+        if ( last_victim_ == id_) {
+            return 0;
+        }
+        ++count;
+        std::size_t n = steal_from( last_victim_, batch);
+        if ( 0 == n) {
+            last_victim_ = id_;
+        }
+        return n;
+    }
+
+    // steals from randomly selected candidates `id_of( 0)` .. `id_of( size - 1)`
+    // (this peer excluded) till a steal succeeds, at most `size` attempts;
+    // the victim of a successful steal becomes the last victim
+    template< typename IdOf >
+    std::size_t steal_from_random( std::size_t size, IdOf && id_of,
+                                   context ** batch, std::size_t & count) noexcept {
+        if ( 0 == size) {
+            return 0;
+        }
+        static thread_local std::minstd_rand generator{ std::random_device{}() };
+        std::uniform_int_distribution< std::size_t > distribution{ 0, size - 1 };
+        std::size_t n = 0;
+        for ( std::size_t i = 0; 0 == n && i < size; ++i) {
+            ++count;
+            std::uint32_t id = id_of( distribution( generator) );
+            // prevent stealing from own scheduler
+            if ( id != id_) {
+                n = steal_from( id, batch);
+                if ( 0 < n) {
+                    last_victim_ = id;
+                }
+            }
+        }
+        return n;
+    }
+
+    // a fiber that might have been stolen has been picked; if a woken peer
+    // found more work than it can take (`surplus` local fibers or stealable
+    // peers), the next parked peer continues the search
+    void found_work( bool surplus) noexcept {
+        if ( searching_) {
+            searching_ = false;
+            registry_.idle().searched();
+            if ( surplus || peers_stealable() ) {
+                wake_peer();
+            }
+        }
+    }
+
+    // registers this peer as parked, peers pushing stealable work wake it
+    // by Peer::notify(); returns false if work can already be stolen (the
+    // peer must not block)
+    bool park() noexcept {
+        if ( searching_) {
+            searching_ = false;
+            registry_.idle().searched();
+        }
+        registry_.idle().park( id_);
+        // a peer pushing work before this peer was registered as parked
+        // has not woken anybody
+        return ! peers_stealable();
+    }
+
+    // must follow park() after the peer has been woken or timed out
+    void unpark() noexcept {
+        // not registered anymore if woken by a peer
+        searching_ = ! registry_.idle().unpark( id_);
+    }
+
+    void suspend_until( std::chrono::steady_clock::time_point const& time_point) noexcept {
+        if ( suspend_) {
+            if ( park() ) {
+                std::unique_lock< std::mutex > lk{ mtx_ };
+                if ( (std::chrono::steady_clock::time_point::max)() == time_point) {
+                    cnd_.wait( lk, [this](){ return flag_; });
+                } else {
+                    cnd_.wait_until( lk, time_point, [this](){ return flag_; });
+                }
+                flag_ = false;
+            }
+            unpark();
+        }
+    }
+
+    void notify() noexcept {
+        if ( suspend_) {
+            std::unique_lock< std::mutex > lk{ mtx_ };
+            flag_ = true;
+            lk.unlock();
+            cnd_.notify_all();
+        }
+    }
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_STEALING_PEER_H
@@ -0,0 +1,304 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_TIMER_WHEEL_H
+#define BOOST_FIBERS_DETAIL_TIMER_WHEEL_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/intrusive/list.hpp>
+
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+// hierarchical hashed timer wheel
+//
+// George Varghese and Tony Lauck. 1987.
+// Hashed and hierarchical timing wheels: data structures for the efficient
+// implementation of a timer facility.
+// In Proceedings of the eleventh ACM Symposium on Operating systems
+// principles (SOSP '87). ACM, New York, NY, USA, 25-38.
+//
+// level `l` consists of 64 slots, each slot covers 64^l ticks; a deadline is
+// stored in the lowest level whose range still contains it (relative to
+// the current tick) - insert and cancel (auto-unlink) are O(1), entries
+// of higher levels are cascaded to lower levels while time advances
+// deadlines are rounded up to the next tick, e.g. all deadlines that fall
+// into the same tick expire together (the tick is the timer slack)
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+class timer_wheel {
+public:
+    typedef std::chrono::steady_clock::time_point   time_point;
+    typedef std::chrono::steady_clock::duration     duration;
+
+private:
+    typedef intrusive::list<
+                context,
+                intrusive::member_hook<
+                    context, detail::timer_hook, & context::timer_hook_ >,
+                intrusive::constant_time_size< false >
+            >                                       slot_type;
+
+    enum : std::uint64_t {
+        slot_bits = 6,
+        slot_count = 1 << slot_bits,
+        level_count = 6
+    };
+
+    // bitmap of (probably) non-empty slots per level
+    // a bit might be stale because contexts auto-unlink from a slot
+    // (scheduler::schedule()); stale bits are cleared while advancing
+    std::uint64_t                                   occupied_[level_count]{};
+    slot_type                                       slots_[level_count][slot_count]{};
+    // deadlines beyond the range of the wheel
+    slot_type                                       overflow_{};
+    time_point                                      origin_;
+    duration                                        tick_;
+    // elapsed ticks since origin_
+    std::uint64_t                                   now_{ 0 };
+    // tick at which overflowed deadlines are re-examined
+    std::uint64_t                                   overflow_tick_{ max_ticks() / 2 };
+
+    static constexpr std::uint64_t max_ticks() noexcept {
+        return static_cast< std::uint64_t >( 1) << ( slot_bits * level_count);
+    }
+
+    static std::uint64_t level_range( std::size_t level) noexcept {
+        return static_cast< std::uint64_t >( 1) << ( slot_bits * ( level + 1) );
+    }
+
+    static std::uint64_t slot_range( std::size_t level) noexcept {
+        return static_cast< std::uint64_t >( 1) << ( slot_bits * level);
+    }
+
+    static std::size_t level_for( std::uint64_t now, std::uint64_t when) noexcept {
+        // highest bit that differs between now and deadline
+        std::uint64_t masked = ( now ^ when) | ( slot_count - 1);
+#if defined(__GNUC__) || defined(__clang__)
+        std::size_t significant = 63 - static_cast< std::size_t >( __builtin_clzll( masked) );
+#else
+        std::size_t significant = 63;
+        while ( 0 == ( masked & ( static_cast< std::uint64_t >( 1) << significant) ) ) {
+            --significant;
+        }
+#endif
+        return significant / slot_bits;
+    }
+
+    static std::size_t ctz( std::uint64_t v) noexcept {
+        BOOST_ASSERT( 0 != v);
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast< std::size_t >( __builtin_ctzll( v) );
+#else
+        std::size_t n = 0;
+        while ( 0 == ( v & 1) ) {
+            v >>= 1;
+            ++n;
+        }
+        return n;
+#endif
+    }
+
+    // tick at which a context must expire, rounded up
+    // returns max_ticks() + now_ if the deadline is out of range
+    std::uint64_t to_tick_( time_point const& tp) const noexcept {
+        if ( tp <= origin_) {
+            return 0;
+        }
+        duration const d = tp - origin_;
+        std::uint64_t const q = static_cast< std::uint64_t >( d.count() / tick_.count() );
+        if ( q >= now_ + max_ticks() - 1) {
+            return now_ + max_ticks();
+        }
+        return 0 == d.count() % tick_.count() ? q : q + 1;
+    }
+
+    void link_( context * ctx, std::uint64_t when) noexcept {
+        if ( when < now_) {
+            // already expired, fire at next advance
+            when = now_;
+        }
+        if ( when - now_ >= max_ticks() ) {
+            ctx->timer_link( overflow_);
+            return;
+        }
+        std::size_t level = level_for( now_, when);
+        if ( level >= level_count) {
+            // the deadline lies beyond the next 64^level_count boundary
+            // (e.g. now_ = 2^36 - 1, when = 2^36 + 5): the slot of the top
+            // level is expired in its next rotation, before the deadline,
+            // and its entries are cascaded to the lower levels
+            level = level_count - 1;
+        }
+        std::size_t slot = static_cast< std::size_t >( ( when >> ( level * slot_bits) ) & ( slot_count - 1) );
+        ctx->timer_link( slots_[level][slot]);
+        occupied_[level] |= static_cast< std::uint64_t >( 1) << slot;
+    }
+
+    // next tick at which slot entries have to be expired or cascaded
+    bool next_expiration_( std::size_t & level, std::size_t & slot, std::uint64_t & when) noexcept {
+        for ( std::size_t l = 0; l < level_count; ++l) {
+            while ( 0 != occupied_[l]) {
+                std::size_t pos = static_cast< std::size_t >( ( now_ >> ( l * slot_bits) ) & ( slot_count - 1) );
+                std::uint64_t rotated = ( occupied_[l] >> pos) | ( 0 == pos ? 0 : occupied_[l] << ( slot_count - pos) );
+                std::size_t s = ( ctz( rotated) + pos) & ( slot_count - 1);
+                if ( slots_[l][s].empty() ) {
+                    // stale bit, context was unlinked
+                    occupied_[l] &= ~( static_cast< std::uint64_t >( 1) << s);
+                    continue;
+                }
+                std::uint64_t start = now_ & ~( level_range( l) - 1);
+                std::uint64_t t = start + s * slot_range( l);
+                if ( t < now_) {
+                    // slot belongs to the next rotation of this level
+                    t += level_range( l);
+                }
+                level = l;
+                slot = s;
+                when = t;
+                return true;
+            }
+        }
+        return false;
+    }
+
+public:
+    timer_wheel( duration const& tick,
+                 time_point const& origin = std::chrono::steady_clock::now() ) noexcept :
+        origin_{ origin },
+        tick_{ tick } {
+        BOOST_ASSERT( tick_ > duration::zero() );
+    }
+
+    timer_wheel( timer_wheel const&) = delete;
+    timer_wheel & operator=( timer_wheel const&) = delete;
+
+    ~timer_wheel() {
+        BOOST_ASSERT( empty() );
+    }
+
+    duration tick() const noexcept {
+        return tick_;
+    }
+
+    bool empty() const noexcept {
+        if ( ! overflow_.empty() ) {
+            return false;
+        }
+        for ( std::size_t l = 0; l < level_count; ++l) {
+            std::uint64_t bits = occupied_[l];
+            while ( 0 != bits) {
+                std::size_t s = ctz( bits);
+                if ( ! slots_[l][s].empty() ) {
+                    return false;
+                }
+                bits &= bits - 1;
+            }
+        }
+        return true;
+    }
+
+    void insert( context * ctx) noexcept {
+        BOOST_ASSERT( nullptr != ctx);
+        link_( ctx, to_tick_( ctx->tp_) );
+    }
+
+    // earliest point in time the wheel needs to be advanced
+    // might be earlier than the earliest deadline (cascading of higher levels)
+    time_point next_deadline() noexcept {
+        std::size_t level = 0, slot = 0;
+        std::uint64_t when = 0;
+        if ( next_expiration_( level, slot, when) ) {
+            return origin_ + tick_ * static_cast< duration::rep >( when);
+        }
+        if ( ! overflow_.empty() ) {
+            return origin_ + tick_ * static_cast< duration::rep >( overflow_tick_);
+        }
+        return (time_point::max)();
+    }
+
+    // advances the wheel to `now` and calls `fn` for each expired context
+    template< typename Fn >
+    void expire( time_point const& now, Fn && fn) noexcept {
+        if ( now < origin_) {
+            return;
+        }
+        std::uint64_t const target = static_cast< std::uint64_t >( ( now - origin_).count() / tick_.count() );
+        std::size_t level = 0, slot = 0;
+        std::uint64_t when = 0;
+        while ( next_expiration_( level, slot, when) && when <= target) {
+            now_ = when;
+            occupied_[level] &= ~( static_cast< std::uint64_t >( 1) << slot);
+            slot_type tmp;
+            tmp.swap( slots_[level][slot]);
+            while ( ! tmp.empty() ) {
+                context * ctx = & tmp.front();
+                tmp.pop_front();
+                if ( 0 == level) {
+                    fn( ctx);
+                } else {
+                    // cascade to a lower level
+                    link_( ctx, to_tick_( ctx->tp_) );
+                }
+            }
+        }
+        if ( target > now_) {
+            now_ = target;
+        }
+        if ( now_ >= overflow_tick_) {
+            // deadlines might have moved into the range of the wheel
+            overflow_tick_ = now_ + max_ticks() / 2;
+            if ( ! overflow_.empty() ) {
+                slot_type tmp;
+                tmp.swap( overflow_);
+                while ( ! tmp.empty() ) {
+                    context * ctx = & tmp.front();
+                    tmp.pop_front();
+                    link_( ctx, to_tick_( ctx->tp_) );
+                }
+            }
+        }
+    }
+
+    // removes all contexts from the wheel and calls `fn` for each of them
+    template< typename Fn >
+    void clear( Fn && fn) noexcept {
+        for ( std::size_t l = 0; l < level_count; ++l) {
+            for ( std::size_t s = 0; s < slot_count; ++s) {
+                while ( ! slots_[l][s].empty() ) {
+                    context * ctx = & slots_[l][s].front();
+                    slots_[l][s].pop_front();
+                    fn( ctx);
+                }
+            }
+            occupied_[l] = 0;
+        }
+        while ( ! overflow_.empty() ) {
+            context * ctx = & overflow_.front();
+            overflow_.pop_front();
+            fn( ctx);
+        }
+    }
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_TIMER_WHEEL_H
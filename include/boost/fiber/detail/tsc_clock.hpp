@@ -0,0 +1,171 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_TSC_CLOCK_H
+#define BOOST_FIBERS_DETAIL_TSC_CLOCK_H
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include <boost/config.hpp>
+#include <boost/predef.h>
+
+#include <boost/fiber/detail/config.hpp>
+
+#if BOOST_ARCH_X86
+# if BOOST_COMP_MSVC
+#  include <intrin.h>
+# else
+#  include <x86intrin.h>
+# endif
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+// steady clock derived from the time-stamp counter
+//
+// used only if the kernel reports an invariant TSC (flags `constant_tsc` and
+// `nonstop_tsc` in /proc/cpuinfo), otherwise std::chrono::steady_clock::now()
+// is returned
+// the TSC frequency is calibrated against std::chrono::steady_clock during
+// the first 10ms and re-calibrated every second; the returned time never goes
+// backwards
+// between two calibrations the time may run ahead of (or lag behind)
+// std::chrono::steady_clock by the error of the measured frequency, at most
+// the resolution of steady_clock per calibration interval (the first second
+// after the 10ms calibration has the largest skew); a deadline compared
+// against this clock may therefore expire early by that skew
+// /proc/cpuinfo is read once per process, on the first call of now()
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+class tsc_clock {
+public:
+    typedef std::chrono::steady_clock::time_point   time_point;
+    typedef std::chrono::steady_clock::duration     duration;
+
+private:
+    bool                initialized_{ false };
+    bool                invariant_{ false };
+    bool                calibrated_{ false };
+    std::uint64_t       tsc0_{ 0 };
+    time_point          tp0_{};
+    time_point          last_{};
+    double              ns_per_tick_{ 0. };
+
+    static std::uint64_t rdtsc_() noexcept {
+#if BOOST_ARCH_X86
+        return static_cast< std::uint64_t >( __rdtsc() );
+#else
+        return 0;
+#endif
+    }
+
+    static bool read_invariant_tsc_() noexcept {
+#if BOOST_ARCH_X86 && BOOST_OS_LINUX
+        try {
+            std::ifstream cpuinfo{ "/proc/cpuinfo" };
+            std::string line;
+            while ( std::getline( cpuinfo, line) ) {
+                if ( 0 != line.compare( 0, 5, "flags") ) {
+                    continue;
+                }
+                line += ' ';
+                return std::string::npos != line.find( " constant_tsc ") &&
+                       std::string::npos != line.find( " nonstop_tsc ");
+            }
+        } catch (...) {
+        }
+#endif
+        return false;
+    }
+
+    static bool has_invariant_tsc_() noexcept {
+        static bool const invariant = read_invariant_tsc_();
+        return invariant;
+    }
+
+    void init_() noexcept {
+        initialized_ = true;
+        invariant_ = has_invariant_tsc_();
+        if ( invariant_) {
+            tp0_ = std::chrono::steady_clock::now();
+            tsc0_ = rdtsc_();
+            last_ = tp0_;
+        }
+    }
+
+    void calibrate_( std::uint64_t tsc, time_point const& tp) noexcept {
+        if ( tsc > tsc0_) {
+            ns_per_tick_ = static_cast< double >(
+                    std::chrono::duration_cast< std::chrono::nanoseconds >( tp - tp0_).count() ) /
+                static_cast< double >( tsc - tsc0_);
+        }
+        tsc0_ = tsc;
+        tp0_ = tp;
+    }
+
+    static constexpr std::chrono::milliseconds calibration() noexcept {
+        return std::chrono::milliseconds{ 10 };
+    }
+
+    static constexpr std::chrono::seconds recalibration() noexcept {
+        return std::chrono::seconds{ 1 };
+    }
+
+public:
+    tsc_clock() noexcept = default;
+
+    tsc_clock( tsc_clock const&) = delete;
+    tsc_clock & operator=( tsc_clock const&) = delete;
+
+    bool invariant() const noexcept {
+        return has_invariant_tsc_();
+    }
+
+    time_point now() noexcept {
+        if ( ! initialized_) {
+            init_();
+        }
+        if ( ! invariant_) {
+            return std::chrono::steady_clock::now();
+        }
+        std::uint64_t const tsc = rdtsc_();
+        if ( ! calibrated_) {
+            time_point const tp = std::chrono::steady_clock::now();
+            if ( tp - tp0_ >= calibration() ) {
+                calibrate_( tsc, tp);
+                calibrated_ = true;
+            }
+            return last_ = tp;
+        }
+        time_point tp = tp0_ + std::chrono::duration_cast< duration >(
+                std::chrono::duration< double, std::nano >{
+                    static_cast< double >( tsc - tsc0_) * ns_per_tick_ });
+        if ( tp - tp0_ >= recalibration() ) {
+            // compensate the drift between TSC and steady_clock
+            calibrate_( tsc, std::chrono::steady_clock::now() );
+            tp = tp0_;
+        }
+        if ( tp < last_) {
+            tp = last_;
+        }
+        return last_ = tp;
+    }
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_TSC_CLOCK_H
@@ -0,0 +1,132 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_DETAIL_URING_REACTOR_H
+#define BOOST_FIBERS_DETAIL_URING_REACTOR_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include <boost/config.hpp>
+#include <boost/predef.h>
+
+#include <boost/fiber/detail/config.hpp>
+
+#if ! BOOST_OS_LINUX
+# error "boost fiber: the io_uring reactor is available only on Linux"
+#endif
+
+extern "C" {
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+// completion based I/O via io_uring(7)
+//
+// owned by the scheduling algorithm of one thread (uring_round_robin);
+// fibers running on this thread prepare a submission queue entry and suspend
+// till its completion is reaped, the entries of all fibers are submitted
+// together by the dispatcher-context (poll(), run_until()) - one
+// io_uring_enter() per iteration of the dispatcher instead of one system call
+// per operation
+class BOOST_FIBERS_DECL uring_reactor {
+private:
+    int                         ring_fd_{ -1 };
+    int                         efd_{ -1 };
+    void                    *   sq_ptr_{ nullptr };
+    std::size_t                 sq_size_{ 0 };
+    void                    *   cq_ptr_{ nullptr };
+    std::size_t                 cq_size_{ 0 };
+    ::io_uring_sqe          *   sqes_{ nullptr };
+    std::size_t                 sqes_size_{ 0 };
+    ::io_uring_cqe          *   cqes_{ nullptr };
+    unsigned                *   sq_head_{ nullptr };
+    unsigned                *   sq_tail_{ nullptr };
+    unsigned                *   sq_array_{ nullptr };
+    unsigned                *   cq_head_{ nullptr };
+    unsigned                *   cq_tail_{ nullptr };
+    unsigned                    sq_mask_{ 0 };
+    unsigned                    sq_entries_{ 0 };
+    unsigned                    cq_mask_{ 0 };
+    // tail of the submission queue not yet published to the kernel
+    unsigned                    sq_local_tail_{ 0 };
+    // operations submitted (or prepared) but not completed
+    std::size_t                 inflight_{ 0 };
+    bool                        efd_armed_{ false };
+    std::uint64_t               efd_value_{ 0 };
+    ::__kernel_timespec         ts_{};
+    std::atomic< bool >         notified_{ false };
+
+    void release_() noexcept;
+
+    ::io_uring_sqe * get_sqe_() noexcept;
+
+    unsigned flush_() noexcept;
+
+    int enter_( unsigned, unsigned, unsigned, void *, std::size_t) noexcept;
+
+    void reap_() noexcept;
+
+public:
+    // reactor of the calling thread, nullptr if the scheduling algorithm of
+    // this thread is not io_uring based
+    static uring_reactor * current() noexcept;
+
+    explicit uring_reactor( unsigned entries);
+
+    ~uring_reactor();
+
+    uring_reactor( uring_reactor const&) = delete;
+    uring_reactor & operator=( uring_reactor const&) = delete;
+
+    // true if operations wait to be submitted or completed
+    bool busy() const noexcept {
+        return 0 != inflight_;
+    }
+
+    // submits prepared operations and wakes the fibers of completed
+    // operations, does not block
+    void poll() noexcept;
+
+    // submits prepared operations and blocks till at least one operation has
+    // been completed, notify() has been called or `time_point` is reached
+    void run_until( std::chrono::steady_clock::time_point const&) noexcept;
+
+    // interrupts run_until(), might be called from any thread
+    void notify() noexcept;
+
+    // prepares an operation and suspends the active fiber till the operation
+    // has been completed; returns the result of the completion entry
+    // (negative errno on failure)
+    std::int32_t execute( std::uint8_t opcode, int fd, std::uint64_t addr,
+                          std::uint32_t len, std::uint64_t off, std::uint32_t op_flags);
+};
+
+}}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_DETAIL_URING_REACTOR_H
@@ -0,0 +1,89 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_EPOLL_H
+#define BOOST_FIBERS_EPOLL_H
+
+#include <chrono>
+#include <system_error>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/algo/epoll_round_robin.hpp>
+#include <boost/fiber/algo/epoll_work_stealing.hpp>
+#include <boost/fiber/cached_clock.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/epoll_reactor.hpp>
+#include <boost/fiber/exceptions.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+inline
+epoll_reactor & active_reactor() {
+    epoll_reactor * reactor = epoll_reactor::current();
+    if ( BOOST_UNLIKELY( nullptr == reactor) ) {
+        throw fiber_error{ std::make_error_code( std::errc::operation_not_supported),
+                           "boost fiber: scheduling algorithm of this thread is not epoll based" };
+    }
+    return * reactor;
+}
+
+}}
+
+namespace this_fiber {
+
+// suspends the calling fiber till `fd` becomes readable
+// requires algo::epoll_round_robin or algo::epoll_work_stealing
+inline
+void wait_readable( int fd) {
+    fibers::detail::active_reactor().wait(
+            fd, false, (std::chrono::steady_clock::time_point::max)() );
+}
+
+// returns false if `fd` has not become readable within `timeout_duration`
+template< typename Rep, typename Period >
+bool wait_readable( int fd, std::chrono::duration< Rep, Period > const& timeout_duration) {
+    return fibers::detail::active_reactor().wait(
+            fd, false, fibers::detail::timeout_clock::now() + timeout_duration);
+}
+
+// suspends the calling fiber till `fd` becomes writable
+// requires algo::epoll_round_robin or algo::epoll_work_stealing
+inline
+void wait_writable( int fd) {
+    fibers::detail::active_reactor().wait(
+            fd, true, (std::chrono::steady_clock::time_point::max)() );
+}
+
+// returns false if `fd` has not become writable within `timeout_duration`
+template< typename Rep, typename Period >
+bool wait_writable( int fd, std::chrono::duration< Rep, Period > const& timeout_duration) {
+    return fibers::detail::active_reactor().wait(
+            fd, true, fibers::detail::timeout_clock::now() + timeout_duration);
+}
+
+// releases the state kept for `fd` by the reactor of the calling thread,
+// to be called before `fd` is closed
+inline
+void forget_descriptor( int fd) {
+    fibers::detail::epoll_reactor * reactor = fibers::detail::epoll_reactor::current();
+    if ( nullptr != reactor) {
+        reactor->forget( fd);
+    }
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_EPOLL_H
@@ -36,10 +36,16 @@
 
 namespace boost {
 namespace fibers {
+namespace detail {
+
+class fiber_batch;
+
+}
 
 class BOOST_FIBERS_DECL fiber {
 private:
     friend class context;
+    friend class detail::fiber_batch;
 
     using ptr_t = intrusive_ptr<context>;
 
@@ -70,7 +76,8 @@ public:
 
     template< typename Fn,
               typename ... Arg,
-              typename = detail::disable_overload< fiber, Fn >
+              typename = detail::disable_overload< fiber, Fn >,
+              typename = detail::disable_overload< pinned_to_thread_t, Fn >
     >
 #if BOOST_COMP_GNUC < 50000000
     fiber( launch policy, Fn && fn, Arg && ... arg) :
@@ -171,6 +178,36 @@ public:
         start_();
     }
 
+    template< typename Fn,
+              typename ... Arg,
+              typename = detail::disable_overload< fiber, Fn >,
+              typename = detail::disable_overload< std::allocator_arg_t, Fn >
+    >
+#if BOOST_COMP_GNUC < 50000000
+    fiber( launch policy, pinned_to_thread_t tag, Fn && fn, Arg && ... arg) :
+#else
+    fiber( launch policy, pinned_to_thread_t tag, Fn && fn, Arg ... arg) :
+#endif
+        fiber{ policy, tag,
+               std::allocator_arg, default_stack(),
+               std::forward< Fn >( fn), std::forward< Arg >( arg) ... } {
+    }
+
+    template< typename StackAllocator,
+              typename Fn,
+              typename ... Arg
+    >
+#if BOOST_COMP_GNUC < 50000000
+    fiber( launch policy, pinned_to_thread_t, std::allocator_arg_t, StackAllocator && salloc, Fn && fn, Arg && ... arg) :
+#else
+    fiber( launch policy, pinned_to_thread_t, std::allocator_arg_t, StackAllocator && salloc, Fn && fn, Arg ... arg) :
+#endif
+        impl_{ make_worker_context_with_properties( policy, nullptr, std::forward< StackAllocator >( salloc), std::forward< Fn >( fn), std::forward< Arg >( arg) ... ) } {
+        // must be set before the scheduler sees the context for the first time
+        impl_->thread_affinity( true);
+        start_();
+    }
+
     ~fiber() {
         if ( joinable() ) {
             std::terminate();
@@ -44,6 +44,7 @@ private:
         }
     };
 
+    detail::fss_key                     key_{};
     detail::fss_cleanup_function::ptr_t cleanup_fn_;
 
 public:
@@ -61,7 +62,7 @@ public:
         context * active_ctx = context::active();
         if ( nullptr != active_ctx) {
             active_ctx->set_fss_data(
-                this, cleanup_fn_, nullptr, true);
+                key_, cleanup_fn_, nullptr, true);
         }
     }
 
@@ -70,7 +71,7 @@ public:
 
     T * get() const noexcept {
         BOOST_ASSERT( context::active() );
-        void * vp = context::active()->get_fss_data( this);
+        void * vp = context::active()->get_fss_data( key_);
         return static_cast< T * >( vp);
     }
 
@@ -85,7 +86,7 @@ public:
     T * release() {
         T * tmp = get();
         context::active()->set_fss_data(
-            this, cleanup_fn_, nullptr, false);
+            key_, cleanup_fn_, nullptr, false);
         return tmp;
     }
 
@@ -93,7 +94,7 @@ public:
         T * c = get();
         if ( BOOST_LIKELY( c != t) ) {
             context::active()->set_fss_data(
-                this, cleanup_fn_, t, true);
+                key_, cleanup_fn_, t, true);
         }
     }
 };
@@ -44,11 +44,16 @@ protected:
     bool                ready_{ false };
     std::exception_ptr  except_{};
 
-    void mark_ready_and_notify_( std::unique_lock< mutex > & lk) noexcept {
+    // with `handoff` a waiting fiber of this thread is resumed at once
+    void mark_ready_and_notify_( std::unique_lock< mutex > & lk, bool handoff = false) noexcept {
         BOOST_ASSERT( lk.owns_lock() );
         ready_ = true;
         lk.unlock();
-        waiters_.notify_all();
+        if ( handoff) {
+            waiters_.notify_all_and_yield();
+        } else {
+            waiters_.notify_all();
+        }
     }
 
     void owner_destroyed_( std::unique_lock< mutex > & lk) {
@@ -159,22 +164,22 @@ class shared_state : public shared_state_base {
 private:
     alignas(alignof( R)) unsigned char storage_[sizeof( R)]{};
 
-    void set_value_( R const& value, std::unique_lock< mutex > & lk) {
+    void set_value_( R const& value, std::unique_lock< mutex > & lk, bool handoff) {
         BOOST_ASSERT( lk.owns_lock() );
         if ( BOOST_UNLIKELY( ready_) ) {
             throw promise_already_satisfied{};
         }
         ::new ( static_cast< void * >( std::addressof( storage_) ) ) R( value );
-        mark_ready_and_notify_( lk);
+        mark_ready_and_notify_( lk, handoff);
     }
 
-    void set_value_( R && value, std::unique_lock< mutex > & lk) {
+    void set_value_( R && value, std::unique_lock< mutex > & lk, bool handoff) {
         BOOST_ASSERT( lk.owns_lock() );
         if ( BOOST_UNLIKELY( ready_) ) {
             throw promise_already_satisfied{};
         }
         ::new ( static_cast< void * >( std::addressof( storage_) ) ) R( std::move( value) );
-        mark_ready_and_notify_( lk);
+        mark_ready_and_notify_( lk, handoff);
     }
 
     R & get_( std::unique_lock< mutex > & lk) {
@@ -200,14 +205,14 @@ public:
     shared_state( shared_state const&) = delete;
     shared_state & operator=( shared_state const&) = delete;
 
-    void set_value( R const& value) {
+    void set_value( R const& value, bool handoff = false) {
         std::unique_lock< mutex > lk{ mtx_ };
-        set_value_( value, lk);
+        set_value_( value, lk, handoff);
     }
 
-    void set_value( R && value) {
+    void set_value( R && value, bool handoff = false) {
         std::unique_lock< mutex > lk{ mtx_ };
-        set_value_( std::move( value), lk);
+        set_value_( std::move( value), lk, handoff);
     }
 
     R & get() {
@@ -221,13 +226,13 @@ class shared_state< R & > : public shared_state_base {
 private:
     R   *   value_{ nullptr };
 
-    void set_value_( R & value, std::unique_lock< mutex > & lk) {
+    void set_value_( R & value, std::unique_lock< mutex > & lk, bool handoff) {
         BOOST_ASSERT( lk.owns_lock() );
         if ( BOOST_UNLIKELY( ready_) ) {
             throw promise_already_satisfied();
         }
         value_ = std::addressof( value);
-        mark_ready_and_notify_( lk);
+        mark_ready_and_notify_( lk, handoff);
     }
 
     R & get_( std::unique_lock< mutex > & lk) {
@@ -249,9 +254,9 @@ public:
     shared_state( shared_state const&) = delete;
     shared_state & operator=( shared_state const&) = delete;
 
-    void set_value( R & value) {
+    void set_value( R & value, bool handoff = false) {
         std::unique_lock< mutex > lk{ mtx_ };
-        set_value_( value, lk);
+        set_value_( value, lk, handoff);
     }
 
     R & get() {
@@ -264,12 +269,12 @@ template<>
 class shared_state< void > : public shared_state_base {
 private:
     inline
-    void set_value_( std::unique_lock< mutex > & lk) {
+    void set_value_( std::unique_lock< mutex > & lk, bool handoff) {
         BOOST_ASSERT( lk.owns_lock() );
         if ( BOOST_UNLIKELY( ready_) ) {
             throw promise_already_satisfied();
         }
-        mark_ready_and_notify_( lk);
+        mark_ready_and_notify_( lk, handoff);
     }
 
     inline
@@ -292,9 +297,9 @@ public:
     shared_state & operator=( shared_state const&) = delete;
 
     inline
-    void set_value() {
+    void set_value( bool handoff = false) {
         std::unique_lock< mutex > lk{ mtx_ };
-        set_value_( lk);
+        set_value_( lk, handoff);
     }
 
     inline
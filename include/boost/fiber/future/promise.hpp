@@ -134,6 +134,22 @@ public:
         base_type::future_->set_value( std::move( value) );
     }
 
+    // a fiber of this thread waiting for the value is resumed at once,
+    // the calling fiber is put into the ready-queue
+    void set_value_and_yield( R const& value) {
+        if ( BOOST_UNLIKELY( ! base_type::future_) ) {
+            throw promise_uninitialized{};
+        }
+        base_type::future_->set_value( value, true);
+    }
+
+    void set_value_and_yield( R && value) {
+        if ( BOOST_UNLIKELY( ! base_type::future_) ) {
+            throw promise_uninitialized{};
+        }
+        base_type::future_->set_value( std::move( value), true);
+    }
+
     void swap( promise & other) noexcept {
         base_type::swap( other);
     }
@@ -168,6 +184,13 @@ public:
         base_type::future_->set_value( value);
     }
 
+    void set_value_and_yield( R & value) {
+        if ( BOOST_UNLIKELY( ! base_type::future_) ) {
+            throw promise_uninitialized{};
+        }
+        base_type::future_->set_value( value, true);
+    }
+
     void swap( promise & other) noexcept {
         base_type::swap( other);
     }
@@ -203,6 +226,14 @@ public:
         base_type::future_->set_value();
     }
 
+    inline
+    void set_value_and_yield() {
+        if ( BOOST_UNLIKELY( ! base_type::future_) ) {
+            throw promise_uninitialized{};
+        }
+        base_type::future_->set_value( true);
+    }
+
     inline
     void swap( promise & other) noexcept {
         base_type::swap( other);
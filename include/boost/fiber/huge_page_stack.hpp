@@ -0,0 +1,91 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_HUGE_PAGE_STACK_H
+#define BOOST_FIBERS_HUGE_PAGE_STACK_H
+
+#include <cstddef>
+#include <memory>
+
+#include <boost/config.hpp>
+#include <boost/context/stack_context.hpp>
+#include <boost/context/stack_traits.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace boost {
+namespace fibers {
+
+// how the pages of an arena are backed
+enum class huge_page_backing {
+    // MADV_HUGEPAGE, the kernel collapses the arena into huge pages
+    transparent,
+    // hugetlbfs (MAP_HUGETLB), falls back to transparent huge pages if no
+    // huge pages are reserved
+    hugetlbfs
+};
+
+struct huge_page_stack_statistics {
+    // size of each stack (rounded up to whole pages)
+    std::size_t     stack_size{ 0 };
+    // size of each arena (rounded up to whole huge pages)
+    std::size_t     arena_size{ 0 };
+    std::size_t     arenas{ 0 };
+    // arenas backed by hugetlbfs resp. advised for transparent huge pages;
+    // the others are backed by normal pages
+    std::size_t     hugetlbfs_arenas{ 0 };
+    std::size_t     transparent_arenas{ 0 };
+    std::size_t     used_stacks{ 0 };
+    std::size_t     free_stacks{ 0 };
+};
+
+// stacks are carved from arenas aligned to 2 MiB, so that the stacks of
+// many fibers share the TLB entries of a few huge pages; an arena holds
+// arena_size / stack_size adjacent stacks, only the bottom of an arena is
+// protected by a guard page
+class BOOST_FIBERS_DECL huge_page_stack {
+public:
+    typedef boost::context::stack_traits    traits_type;
+
+    static constexpr std::size_t    huge_page_size = 2 * 1024 * 1024;
+
+    class pool;
+
+private:
+    std::shared_ptr< pool >     pool_;
+
+public:
+    huge_page_stack( std::size_t stack_size = traits_type::default_size(),
+                     std::size_t arena_size = 16 * huge_page_size,
+                     huge_page_backing backing = huge_page_backing::transparent,
+                     bool guard_page = true);
+
+    boost::context::stack_context allocate();
+
+    void deallocate( boost::context::stack_context &) noexcept;
+
+    huge_page_stack_statistics statistics() const noexcept;
+};
+
+}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_HUGE_PAGE_STACK_H
@@ -54,6 +54,10 @@ public:
     bool try_lock();
 
     void unlock();
+
+    // a fiber of this thread waiting for the mutex is resumed at once,
+    // the calling fiber is put into the ready-queue
+    void unlock_and_yield();
 };
 
 }}
@@ -8,11 +8,10 @@
 #ifndef BOOST_FIBERS_NUMA_ALGO_WORK_STEALING_H
 #define BOOST_FIBERS_NUMA_ALGO_WORK_STEALING_H
 
-#include <condition_variable>
 #include <chrono>
 #include <cstddef>
 #include <cstdint>
-#include <mutex>
+#include <memory>
 #include <vector>
 
 #include <boost/config.hpp>
@@ -23,6 +22,8 @@
 #include <boost/fiber/detail/config.hpp>
 #include <boost/fiber/detail/context_spinlock_queue.hpp>
 #include <boost/fiber/detail/context_spmc_queue.hpp>
+#include <boost/fiber/detail/peer_registry.hpp>
+#include <boost/fiber/detail/stealing_peer.hpp>
 #include <boost/fiber/numa/pin_thread.hpp>
 #include <boost/fiber/numa/topology.hpp>
 #include <boost/fiber/scheduler.hpp>
@@ -31,36 +32,93 @@
 #  include BOOST_ABI_PREFIX
 #endif
 
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
 namespace boost {
 namespace fibers {
 namespace numa {
 namespace algo {
 
+class work_stealing;
+
+// the logical cpus of `topology` stealing ready fibers from each other, one
+// thread pinned to each cpu; independent pools might coexist
+class BOOST_FIBERS_DECL work_stealing_pool {
+private:
+    friend class work_stealing;
+
+    std::vector< boost::fibers::numa::node >                topology_;
+    // indexed by logical cpu
+    boost::fibers::detail::peer_registry< work_stealing >   registry_;
+
+public:
+    explicit work_stealing_pool( std::vector< boost::fibers::numa::node > const&);
+
+    work_stealing_pool( work_stealing_pool const&) = delete;
+    work_stealing_pool & operator=( work_stealing_pool const&) = delete;
+
+    std::vector< boost::fibers::numa::node > const& topology() const noexcept {
+        return topology_;
+    }
+};
+
 class BOOST_FIBERS_DECL work_stealing : public boost::fibers::algo::algorithm {
+public:
+    // max. number of contexts taken from a peer at once
+    static constexpr std::size_t steal_batch_size = 32;
+
 private:
-    static std::vector< intrusive_ptr< work_stealing > >    schedulers_;
+    template< typename >
+    friend class boost::fibers::detail::stealing_peer;
 
-    std::uint32_t                                           cpu_id_;
+    std::shared_ptr< work_stealing_pool >                   pool_;
     std::vector< std::uint32_t >                            local_cpus_;
     std::vector< std::uint32_t >                            remote_cpus_;
+    boost::fibers::detail::stealing_peer< work_stealing >   peer_;
+    // the last victim is tried first among the cpus of its NUMA node
+    bool                                                    last_victim_local_{ false };
 #ifdef BOOST_FIBERS_USE_SPMC_QUEUE
     detail::context_spmc_queue                              rqueue_{};
 #else
     detail::context_spinlock_queue                          rqueue_{};
 #endif
-    std::mutex                                              mtx_{};
-    std::condition_variable                                 cnd_{};
-    bool                                                    flag_{ false };
-    bool                                                    suspend_;
+    // main-/dispatcher-context and fibers bound to this thread; kept apart,
+    // peers never see them and steal the fibers queued behind them
+    scheduler::ready_queue_type                             pinned_{};
+    // both ready-queues take turns, neither starves the other
+    bool                                                    pinned_turn_{ false };
+    bool                                                    joined_{ true };
+
+    static std::shared_ptr< work_stealing_pool > const& default_pool_(
+            std::vector< boost::fibers::numa::node > const&);
+
+    bool stealable_() const noexcept {
+        return rqueue_.stealable();
+    }
 
-    static void init_( std::vector< boost::fibers::numa::node > const&,
-                       std::vector< intrusive_ptr< work_stealing > > &);
+    context * pop_pinned_() noexcept;
+
+protected:
+    // leave the pool before members accessed by peers (e.g. by notify())
+    // are destroyed
+    void leave_() noexcept;
 
 public:
+    // joins the pool shared by all threads using this constructor, created
+    // by the first call
     work_stealing( std::uint32_t, std::uint32_t,
                    std::vector< boost::fibers::numa::node > const&,
                    bool = false);
 
+    work_stealing( std::shared_ptr< work_stealing_pool >,
+                   std::uint32_t, std::uint32_t,
+                   bool = false);
+
+    ~work_stealing() override;
+
     work_stealing( work_stealing const&) = delete;
     work_stealing( work_stealing &&) = delete;
 
@@ -69,14 +127,22 @@ public:
 
     virtual void awakened( context *) noexcept;
 
+    // pushes all contexts under one lock, wakes at most one parked peer
+    virtual void awakened_n( context **, std::size_t) noexcept;
+
     virtual context * pick_next() noexcept;
 
     virtual context * steal() noexcept {
         return rqueue_.steal();
     }
 
+    // steals up to half of the ready contexts at once
+    virtual std::size_t steal_batch( context ** ctxs, std::size_t max) noexcept {
+        return rqueue_.steal_half( ctxs, max);
+    }
+
     virtual bool has_ready_fibers() const noexcept {
-        return ! rqueue_.empty();
+        return ! rqueue_.empty() || ! pinned_.empty();
     }
 
     virtual void suspend_until( std::chrono::steady_clock::time_point const&) noexcept;
@@ -86,6 +152,10 @@ public:
 
 }}}}
 
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
 #ifdef BOOST_HAS_ABI_HEADERS
 #  include BOOST_ABI_SUFFIX
 #endif
@@ -0,0 +1,88 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_NUMA_POOLED_STACK_H
+#define BOOST_FIBERS_NUMA_POOLED_STACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include <boost/config.hpp>
+#include <boost/context/stack_context.hpp>
+#include <boost/context/stack_traits.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace boost {
+namespace fibers {
+
+struct numa_pooled_stack_statistics {
+    // size of each stack (rounded up to whole pages)
+    std::size_t     stack_size{ 0 };
+    // stacks mapped from the operating system, in use or pooled
+    std::size_t     mapped_stacks{ 0 };
+    // stacks kept in the free lists of all threads and in the overflow list
+    std::size_t     pooled_stacks{ 0 };
+    std::size_t     pooled_bytes{ 0 };
+    // stacks moved to the overflow list and returned with MADV_FREE
+    std::uint64_t   cold_stacks{ 0 };
+    // pages touched by prefaulting and the page faults taken meanwhile by
+    // the allocating thread (zero where getrusage() can not count them)
+    std::uint64_t   prefaulted_pages{ 0 };
+    std::uint64_t   prefault_faults{ 0 };
+};
+
+// stacks are kept in free lists of the threads releasing them; a thread
+// keeps at most `thread_cache_size` stacks, surplus stacks and the stacks
+// of exiting threads are moved to a shared overflow list of at most
+// `overflow_size` stacks after their pages were returned by MADV_FREE
+// new stacks are placed on the NUMA node of the allocating thread and the
+// top `prefault_size` bytes of a stack taken from the operating system or
+// from the overflow list are faulted in before the fiber runs
+// with `guard_page` an inaccessible page is mapped below each stack
+class BOOST_FIBERS_DECL numa_pooled_stack {
+public:
+    typedef boost::context::stack_traits    traits_type;
+
+    class pool;
+
+private:
+    std::shared_ptr< pool >     pool_;
+
+public:
+    numa_pooled_stack( std::size_t stack_size = traits_type::default_size(),
+                       std::size_t prefault_size = 0,
+                       std::size_t thread_cache_size = 64,
+                       std::size_t overflow_size = 1024,
+                       bool guard_page = true);
+
+    boost::context::stack_context allocate();
+
+    void deallocate( boost::context::stack_context &) noexcept;
+
+    numa_pooled_stack_statistics statistics() const noexcept;
+};
+
+}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_NUMA_POOLED_STACK_H
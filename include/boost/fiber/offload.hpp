@@ -0,0 +1,284 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_OFFLOAD_H
+#define BOOST_FIBERS_OFFLOAD_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#if defined(BOOST_NO_CXX17_STD_APPLY)
+#include <boost/context/detail/apply.hpp>
+#endif
+#include <boost/intrusive/slist.hpp>
+
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/spinlock.hpp>
+#include <boost/fiber/future/async.hpp>
+#include <boost/fiber/waker.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace boost {
+namespace fibers {
+
+struct offload_statistics {
+    // helper threads started (at most `max_threads`)
+    std::size_t     threads{ 0 };
+    // helper threads running a function, utilization is busy / threads
+    std::size_t     busy{ 0 };
+    // functions waiting for a helper thread (queue depth)
+    std::size_t     queued{ 0 };
+    // highest queue depth observed
+    std::size_t     max_queued{ 0 };
+    std::size_t     max_threads{ 0 };
+    // functions executed
+    std::uint64_t   completed{ 0 };
+};
+
+namespace detail {
+
+typedef intrusive::slist_member_hook<
+    intrusive::link_mode< intrusive::safe_link >
+>                                                   offload_hook;
+
+// function passed to offload(), lives on the stack of the suspended fiber;
+// queuing does not allocate
+class BOOST_FIBERS_DECL offload_task {
+public:
+    offload_hook        hook_{};
+    detail::spinlock    splk_{};
+    waker               w_{};
+
+    virtual ~offload_task() = default;
+
+    // executed by a helper thread
+    virtual void run() noexcept = 0;
+
+    // executed by a helper thread after run()
+    void complete() noexcept {
+        // the fiber releases splk_ after it has been suspended; the task must
+        // not be accessed after wake(), the fiber might destroy it already
+        {
+            detail::spinlock_lock lk{ splk_ };
+        }
+        waker w{ std::move( w_) };
+        w.wake();
+    }
+};
+
+template< typename R >
+class offload_result {
+private:
+    typename std::aligned_storage< sizeof( R), alignof( R) >::type  storage_;
+    bool                                                            ready_{ false };
+    std::exception_ptr                                              except_{};
+
+public:
+    offload_result() = default;
+
+    offload_result( offload_result const&) = delete;
+    offload_result & operator=( offload_result const&) = delete;
+
+    ~offload_result() {
+        if ( ready_) {
+            reinterpret_cast< R * >( std::addressof( storage_) )->~R();
+        }
+    }
+
+    template< typename Fn >
+    void set( Fn && fn) noexcept {
+        try {
+            ::new ( static_cast< void * >( std::addressof( storage_) ) ) R( std::forward< Fn >( fn)() );
+            ready_ = true;
+        } catch (...) {
+            except_ = std::current_exception();
+        }
+    }
+
+    R get() {
+        if ( except_) {
+            std::rethrow_exception( except_);
+        }
+        BOOST_ASSERT( ready_);
+        return std::move( * reinterpret_cast< R * >( std::addressof( storage_) ) );
+    }
+};
+
+template< typename R >
+class offload_result< R & > {
+private:
+    R                   *   value_{ nullptr };
+    std::exception_ptr      except_{};
+
+public:
+    template< typename Fn >
+    void set( Fn && fn) noexcept {
+        try {
+            value_ = std::addressof( std::forward< Fn >( fn)() );
+        } catch (...) {
+            except_ = std::current_exception();
+        }
+    }
+
+    R & get() {
+        if ( except_) {
+            std::rethrow_exception( except_);
+        }
+        return * value_;
+    }
+};
+
+template<>
+class offload_result< void > {
+private:
+    std::exception_ptr      except_{};
+
+public:
+    template< typename Fn >
+    void set( Fn && fn) noexcept {
+        try {
+            std::forward< Fn >( fn)();
+        } catch (...) {
+            except_ = std::current_exception();
+        }
+    }
+
+    void get() {
+        if ( except_) {
+            std::rethrow_exception( except_);
+        }
+    }
+};
+
+template< typename R, typename Fn, typename ... Args >
+class offload_task_impl final : public offload_task {
+private:
+    // the caller stays suspended till run() has returned, no copies
+    Fn                          &&  fn_;
+    std::tuple< Args && ... >       args_;
+    offload_result< R >             result_{};
+
+public:
+    offload_task_impl( Fn && fn, Args && ... args) :
+        fn_( std::forward< Fn >( fn) ),
+        args_( std::forward< Args >( args) ... ) {
+    }
+
+    void run() noexcept override final {
+        result_.set( [this]() -> R {
+#if defined(BOOST_NO_CXX17_STD_APPLY)
+            return boost::context::detail::apply( std::forward< Fn >( fn_), std::move( args_) );
+#else
+            return std::apply( std::forward< Fn >( fn_), std::move( args_) );
+#endif
+        });
+    }
+
+    R get() {
+        return result_.get();
+    }
+};
+
+// bounded pool of helper threads executing offload_tasks in FIFO order;
+// helper threads are started on demand
+class BOOST_FIBERS_DECL offload_pool {
+private:
+    typedef intrusive::slist<
+        offload_task,
+        intrusive::member_hook<
+            offload_task, offload_hook, & offload_task::hook_ >,
+        intrusive::constant_time_size< true >,
+        intrusive::cache_last< true >
+    >                                                   queue_type;
+
+    mutable std::mutex          mtx_{};
+    std::condition_variable     cnd_{};
+    queue_type                  queue_{};
+    std::vector< std::thread >  threads_{};
+    std::size_t                 max_threads_;
+    std::size_t                 idle_{ 0 };
+    std::size_t                 busy_{ 0 };
+    std::size_t                 max_queued_{ 0 };
+    std::uint64_t               completed_{ 0 };
+    bool                        shutdown_{ false };
+
+    void worker_() noexcept;
+
+public:
+    static offload_pool & instance();
+
+    offload_pool();
+
+    ~offload_pool();
+
+    offload_pool( offload_pool const&) = delete;
+    offload_pool & operator=( offload_pool const&) = delete;
+
+    // throws if no helper thread could be started
+    void submit( offload_task &);
+
+    void max_threads( std::size_t);
+
+    offload_statistics statistics() const;
+};
+
+}
+
+// runs fn( args...) on a helper thread, only the calling fiber is suspended
+// till fn has returned; returns its result or rethrows its exception
+template< typename Fn, typename ... Args >
+typename result_of< Fn && ( Args && ... ) >::type
+offload( Fn && fn, Args && ... args) {
+    typedef typename result_of< Fn && ( Args && ... ) >::type   result_type;
+    detail::offload_task_impl< result_type, Fn, Args ... > task{
+        std::forward< Fn >( fn), std::forward< Args >( args) ... };
+    context * active_ctx = context::active();
+    detail::spinlock_lock lk{ task.splk_ };
+    task.w_ = active_ctx->create_waker();
+    detail::offload_pool::instance().submit( task);
+    active_ctx->suspend( lk);
+    return task.get();
+}
+
+// upper bound of helper threads (default: max( 4, number of cpus)); helper
+// threads already started are kept
+BOOST_FIBERS_DECL
+void set_offload_threads( std::size_t);
+
+BOOST_FIBERS_DECL
+offload_statistics get_offload_statistics();
+
+}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_OFFLOAD_H
@@ -7,10 +7,12 @@
 #define BOOST_THIS_FIBER_OPERATIONS_H
 
 #include <chrono>
+#include <cstddef>
 
 #include <boost/config.hpp> 
 
 #include <boost/fiber/algo/algorithm.hpp>
+#include <boost/fiber/cached_clock.hpp>
 #include <boost/fiber/context.hpp>
 #include <boost/fiber/detail/config.hpp>
 #include <boost/fiber/detail/convert.hpp>
@@ -45,7 +47,7 @@ void sleep_until( std::chrono::time_point< Clock, Duration > const& sleep_time_)
 template< typename Rep, typename Period >
 void sleep_for( std::chrono::duration< Rep, Period > const& timeout_duration) {
     fibers::context * active_ctx = fibers::context::active();
-    active_ctx->wait_until( std::chrono::steady_clock::now() + timeout_duration);
+    active_ctx->wait_until( fibers::detail::timeout_clock::now() + timeout_duration);
 }
 
 template< typename PROPS >
@@ -67,6 +69,19 @@ PROPS & properties() {
     return dynamic_cast< PROPS & >( * props );
 }
 
+// true if the running fiber never migrates away from the current thread
+inline
+bool thread_affinity() noexcept {
+    return fibers::context::active()->thread_affinity();
+}
+
+// binds the running fiber to (or releases it from) the current thread; takes
+// effect the next time the fiber is passed to the scheduling algorithm
+inline
+void thread_affinity( bool affinity) noexcept {
+    fibers::context::active()->thread_affinity( affinity);
+}
+
 }
 
 namespace fibers {
@@ -81,6 +96,24 @@ inline bool initialize_thread(algo::algorithm::ptr_t algo, stack_allocator_wrapp
     return boost::fibers::context::initialize_thread(algo, std::move(salloc));
 }
 
+// Replaces the sleep-queue of this thread's scheduler by a hierarchical
+// timer-wheel; deadlines are rounded up to multiples of `tick`.
+// A zero `tick` restores the (ordered) sleep-queue.
+template< typename Rep, typename Period >
+void use_timer_wheel( std::chrono::duration< Rep, Period > const& tick) {
+    context::active()->get_scheduler()->use_timer_wheel(
+        std::chrono::duration_cast< std::chrono::steady_clock::duration >( tick) );
+}
+
+// Stacks of terminated fibers (fixedsize_stack, protected_fixedsize_stack) are
+// kept for fibers spawned later on this thread. If `high_watermark` stacks are
+// cached, the oldest are released till `low_watermark` remain.
+// A zero `high_watermark` disables the cache.
+inline
+void use_stack_cache( std::size_t high_watermark, std::size_t low_watermark) {
+    context::active()->get_scheduler()->use_stack_cache( high_watermark, low_watermark);
+}
+
 template< typename SchedAlgo, typename ... Args >
 void use_scheduling_algorithm( Args && ... args) noexcept {
     initialize_thread(new SchedAlgo(std::forward< Args >( args) ... ), make_stack_allocator_wrapper<boost::fibers::default_stack>());
@@ -25,6 +25,13 @@ enum class launch {
     post
 };
 
+// tag: the launched fiber never migrates away from the launching thread
+struct pinned_to_thread_t {
+    explicit pinned_to_thread_t() = default;
+};
+
+BOOST_CONSTEXPR_OR_CONST pinned_to_thread_t pinned_to_thread{};
+
 namespace detail {
 
 template< typename Fn >
@@ -16,6 +16,7 @@
 
 #include <boost/assert.hpp>
 
+#include <boost/fiber/cached_clock.hpp>
 #include <boost/fiber/context.hpp>
 #include <boost/fiber/detail/config.hpp>
 #include <boost/fiber/detail/convert.hpp>
@@ -71,7 +72,7 @@ public:
 
     template< typename Rep, typename Period >
     bool try_lock_for( std::chrono::duration< Rep, Period > const& timeout_duration) {
-        return try_lock_until_( std::chrono::steady_clock::now() + timeout_duration);
+        return try_lock_until_( detail::timeout_clock::now() + timeout_duration);
     }
 
     void unlock();
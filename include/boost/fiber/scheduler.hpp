@@ -20,10 +20,19 @@
 #include <boost/intrusive/slist.hpp>
 
 #include <boost/fiber/algo/algorithm.hpp>
+#include <boost/fiber/cached_clock.hpp>
 #include <boost/fiber/context.hpp>
 #include <boost/fiber/detail/config.hpp>
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+#include <boost/fiber/detail/context_mpsc_queue.hpp>
+#endif
 #include <boost/fiber/detail/data.hpp>
 #include <boost/fiber/detail/spinlock.hpp>
+#include <boost/fiber/detail/stack_cache.hpp>
+#include <boost/fiber/detail/statistics.hpp>
+#include <boost/fiber/detail/timer_wheel.hpp>
+#include <boost/fiber/detail/tsc_clock.hpp>
+#include <boost/fiber/statistics.hpp>
 
 #ifdef BOOST_HAS_ABI_HEADERS
 #  include BOOST_ABI_PREFIX
@@ -72,24 +81,20 @@ private:
                 intrusive::linear< true >,
                 intrusive::cache_last< true >
             >                                               terminated_queue_type;
-    typedef intrusive::slist<
-                context,
-                intrusive::member_hook<
-                    context, detail::remote_ready_hook, & context::remote_ready_hook_ >,
-                intrusive::linear< true >,
-                intrusive::cache_last< true >
-            >                                               remote_ready_queue_type;
 
 #if ! defined(BOOST_FIBERS_NO_ATOMICS)
     // remote ready-queue contains context' signaled by schedulers
     // running in other threads
-    detail::spinlock                                            remote_ready_splk_{};
-    remote_ready_queue_type                                     remote_ready_queue_{};
+    detail::context_mpsc_queue                                  remote_ready_queue_{};
 #endif
     algo::algorithm::ptr_t             algo_;
+    // algo_ if it attaches properties to fibers, nullptr otherwise
+    algo::algorithm_with_properties_base                    *   props_algo_{ nullptr };
     // sleep-queue contains context' which have been called
     // scheduler::wait_until()
     sleep_queue_type                                            sleep_queue_{};
+    // optional timer-wheel, replaces the sleep-queue if set
+    std::unique_ptr< detail::timer_wheel >                      timer_wheel_{};
     // worker-queue contains all context' managed by this scheduler
     // except main-context and dispatcher-context
     // unlink happens on destruction of a context
@@ -99,15 +104,33 @@ private:
     intrusive_ptr< context >                                    dispatcher_ctx_{};
     context                                                 *   main_ctx_{ nullptr };
     bool                                                        shutdown_{ false };
+    // stacks of terminated fibers, reused by fibers spawned on this thread
+    detail::stack_cache                                         stack_cache_{};
+    // used only with BOOST_FIBERS_USE_TSC_CLOCK, member in any case
+    detail::tsc_clock                                           clock_{};
+    // time cached by the dispatcher-context, see cached_clock
+    std::chrono::steady_clock::time_point                       now_;
+    // maintained only with BOOST_FIBERS_USE_STATISTICS, member in any case
+    detail::statistics_counters                                 stats_{};
 
     void release_terminated_() noexcept;
 
+    void refresh_now_() noexcept;
+
 #if ! defined(BOOST_FIBERS_NO_ATOMICS)
     void remote_ready2ready_() noexcept;
 #endif
 
+    void timeout_( context *) noexcept;
+
     void sleep2ready_() noexcept;
 
+    void sleep_link_( context *) noexcept;
+
+    void awakened_( context *) noexcept;
+
+    context * pick_next_() noexcept;
+
 public:
     scheduler(algo::algorithm::ptr_t algo) noexcept;
 
@@ -118,6 +141,9 @@ public:
 
     void schedule( context *) noexcept;
 
+    // schedules newly attached contexts not blocked in any queue
+    void schedule_n( context **, std::size_t) noexcept;
+
 #if ! defined(BOOST_FIBERS_NO_ATOMICS)
     void schedule_from_remote( context *) noexcept;
 #endif
@@ -128,6 +154,8 @@ public:
 
     void yield( context *) noexcept;
 
+    void handoff( context *, context *) noexcept;
+
     bool wait_until( context *,
                      std::chrono::steady_clock::time_point const&) noexcept;
 
@@ -143,6 +171,25 @@ public:
 
     void set_algo( algo::algorithm::ptr_t) noexcept;
 
+    algo::algorithm_with_properties_base * get_properties_algo() const noexcept {
+        return props_algo_;
+    }
+
+    std::chrono::steady_clock::time_point now() const noexcept {
+        return now_;
+    }
+
+    void use_timer_wheel( std::chrono::steady_clock::duration const&,
+                          std::chrono::steady_clock::time_point const& origin = std::chrono::steady_clock::now() );
+
+    void use_stack_cache( std::size_t, std::size_t);
+
+    scheduler_statistics statistics() const noexcept;
+
+    detail::statistics_counters & counters() noexcept {
+        return stats_;
+    }
+
     void attach_main_context( context *) noexcept;
 
     void attach_dispatcher_context( intrusive_ptr< context >) noexcept;
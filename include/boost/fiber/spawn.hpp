@@ -0,0 +1,122 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_SPAWN_H
+#define BOOST_FIBERS_SPAWN_H
+
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/intrusive_ptr.hpp>
+
+#include <boost/fiber/context.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/fiber.hpp>
+#include <boost/fiber/fixedsize_stack.hpp>
+#include <boost/fiber/policy.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+// collects the worker contexts created by spawn_n()/spawn_range(); launch()
+// attaches all of them to the scheduler of the calling fiber in one pass and
+// makes them ready with one call of algorithm::awakened_n()
+class BOOST_FIBERS_DECL fiber_batch {
+private:
+    std::vector< context * >    ctxs_{};
+    std::vector< fiber >        fibers_{};
+
+public:
+    explicit fiber_batch( std::size_t n) {
+        ctxs_.reserve( n);
+        fibers_.reserve( n);
+    }
+
+    fiber_batch( fiber_batch const&) = delete;
+    fiber_batch & operator=( fiber_batch const&) = delete;
+
+    void add( intrusive_ptr< context > ctx) noexcept {
+        // storage was reserved by the constructor
+        BOOST_ASSERT( ctxs_.size() < ctxs_.capacity() );
+        ctxs_.push_back( ctx.get() );
+        fibers_.emplace_back();
+        fibers_.back().impl_ = std::move( ctx);
+    }
+
+    // if `ex` is set (creating a context has thrown), the fibers created
+    // before are launched and joined - they might refer to objects of the
+    // caller - and `ex` is rethrown
+    std::vector< fiber > launch( std::exception_ptr ex = nullptr);
+};
+
+}
+
+template< typename StackAllocator, typename Fn >
+std::vector< fiber > spawn_n( std::allocator_arg_t, StackAllocator && salloc, std::size_t count, Fn && fn) {
+    detail::fiber_batch batch{ count };
+    std::exception_ptr ex;
+    try {
+        // stacks are allocated back to back, before any fiber runs
+        for ( std::size_t i = 0; i < count; ++i) {
+            batch.add( make_worker_context( launch::post, salloc, fn, i) );
+        }
+    } catch (...) {
+        ex = std::current_exception();
+    }
+    return batch.launch( ex);
+}
+
+template< typename Fn >
+std::vector< fiber > spawn_n( std::size_t count, Fn && fn) {
+    return spawn_n( std::allocator_arg, default_stack(), count, std::forward< Fn >( fn) );
+}
+
+template< typename StackAllocator, typename ForwardIt, typename Fn >
+std::vector< fiber > spawn_range( std::allocator_arg_t, StackAllocator && salloc, ForwardIt first, ForwardIt last, Fn && fn) {
+    detail::fiber_batch batch{ static_cast< std::size_t >( std::distance( first, last) ) };
+    std::exception_ptr ex;
+    try {
+        for ( ; first != last; ++first) {
+            batch.add( make_worker_context( launch::post, salloc, fn,
+                                            typename std::iterator_traits< ForwardIt >::value_type( * first) ) );
+        }
+    } catch (...) {
+        ex = std::current_exception();
+    }
+    return batch.launch( ex);
+}
+
+template< typename ForwardIt, typename Fn >
+std::vector< fiber > spawn_range( ForwardIt first, ForwardIt last, Fn && fn) {
+    return spawn_range( std::allocator_arg, default_stack(), first, last, std::forward< Fn >( fn) );
+}
+
+}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_SPAWN_H
@@ -0,0 +1,250 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_STACK_PROFILE_H
+#define BOOST_FIBERS_STACK_PROFILE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/config/helper_macros.hpp>
+#include <boost/context/fixedsize_stack.hpp>
+#include <boost/context/protected_fixedsize_stack.hpp>
+#include <boost/context/stack_context.hpp>
+#include <boost/context/stack_traits.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/stack_cache.hpp>
+#include <boost/fiber/fixedsize_stack.hpp>
+#include <boost/fiber/protected_fixedsize_stack.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif
+
+// tag identifying the launching call-site, e.g.
+// profiled_stack<>{ BOOST_FIBERS_CALL_SITE }
+#define BOOST_FIBERS_CALL_SITE __FILE__ ":" BOOST_STRINGIZE(__LINE__)
+
+namespace boost {
+namespace fibers {
+
+// stack usage of the fibers launched with one tag
+struct stack_usage {
+    // histogram[i] counts fibers using at most (1 KiB << i) bytes of stack,
+    // the last bucket counts all fibers using more
+    static constexpr std::size_t    buckets = 16;
+
+    std::string     tag{};
+    std::uint64_t   samples{ 0 };
+    std::size_t     max_used{ 0 };
+    std::size_t     mean_used{ 0 };
+    std::uint64_t   histogram[buckets]{};
+};
+
+namespace detail {
+
+class BOOST_FIBERS_DECL stack_usage_counters {
+public:
+    std::string                     tag;
+    std::atomic< std::uint64_t >    samples{ 0 };
+    std::atomic< std::uint64_t >    sum{ 0 };
+    std::atomic< std::size_t >      max_used{ 0 };
+    std::atomic< std::uint64_t >    histogram[stack_usage::buckets];
+    // allocations of adaptive_stack, selects the stacks to be painted
+    std::atomic< std::uint64_t >    allocations{ 0 };
+
+    explicit stack_usage_counters( std::string const&);
+
+    void record( std::size_t used) noexcept;
+
+    void reset() noexcept;
+
+    stack_usage usage() const;
+};
+
+// bytes at the bottom of a stack not to be painted (guard page)
+template< typename StackAlloc >
+struct stack_profile_traits {
+    static std::size_t guard_size() noexcept {
+        return 0;
+    }
+};
+
+template< typename Traits >
+struct stack_profile_traits< boost::context::basic_protected_fixedsize_stack< Traits > > {
+    static std::size_t guard_size() noexcept {
+        return Traits::page_size();
+    }
+};
+
+// fills the stack, except `guard` bytes at its bottom, with a pattern
+BOOST_FIBERS_DECL
+void paint_stack( boost::context::stack_context const&, std::size_t guard) noexcept;
+
+// bytes of a painted stack overwritten since paint_stack() (high-water mark)
+BOOST_FIBERS_DECL
+std::size_t measure_stack( boost::context::stack_context const&, std::size_t guard) noexcept;
+
+}
+
+// stack usage per tag, collected by profiled_stack and adaptive_stack
+class BOOST_FIBERS_DECL stack_profile {
+private:
+    mutable std::mutex                                                      mtx_{};
+    std::map< std::string, std::unique_ptr< detail::stack_usage_counters > > counters_{};
+
+public:
+    // profile used by default, lives till the end of the program
+    static stack_profile & global();
+
+    stack_profile() = default;
+
+    stack_profile( stack_profile const&) = delete;
+    stack_profile & operator=( stack_profile const&) = delete;
+
+    // counters of `tag`, valid for the lifetime of the profile
+    detail::stack_usage_counters * counters( std::string const& tag);
+
+    std::vector< stack_usage > usage() const;
+
+    void reset() noexcept;
+
+    void report( std::ostream &) const;
+};
+
+// paints each stack at allocation and records its high-water mark at
+// deallocation, i.e. when the scheduler releases the terminated fiber
+template< typename StackAlloc = fixedsize_stack >
+class profiled_stack {
+private:
+    typedef detail::stack_profile_traits< StackAlloc >  traits_type;
+
+    StackAlloc                          salloc_;
+    detail::stack_usage_counters    *   counters_;
+
+public:
+    explicit profiled_stack( std::string const& tag,
+                             StackAlloc salloc = StackAlloc{},
+                             stack_profile & profile = stack_profile::global() ) :
+        salloc_( std::move( salloc) ),
+        counters_{ profile.counters( tag) } {
+    }
+
+    boost::context::stack_context allocate() {
+        boost::context::stack_context sctx = salloc_.allocate();
+        detail::paint_stack( sctx, traits_type::guard_size() );
+        return sctx;
+    }
+
+    void deallocate( boost::context::stack_context & sctx) noexcept {
+        counters_->record( detail::measure_stack( sctx, traits_type::guard_size() ) );
+        salloc_.deallocate( sctx);
+    }
+};
+
+// picks the stack size for the fibers launched with `tag` from the recorded
+// high-water marks: `margin` times the largest one, at least `min_size`;
+// stacks of `max_size` bytes are used till `learn_samples` fibers have
+// terminated, afterwards every `sample_period`-th stack is still painted
+// (the profile keeps growing with deeper usage)
+// StackAlloc must be stateless, constructible from the stack size
+template< typename StackAlloc = protected_fixedsize_stack >
+class adaptive_stack {
+private:
+    typedef detail::stack_cache_traits< StackAlloc >    cache_traits_type;
+    typedef detail::stack_profile_traits< StackAlloc >  traits_type;
+
+    static_assert( cache_traits_type::cacheable, "adaptive_stack requires a stateless stack allocator");
+
+    // painted stacks are handed out marker bytes smaller than their size,
+    // a multiple of the page size
+    static constexpr std::size_t    marker = 64;
+
+    detail::stack_usage_counters    *   counters_;
+    std::size_t                         max_size_;
+    std::size_t                         min_size_;
+    double                              margin_;
+    std::uint64_t                       learn_samples_;
+    std::uint64_t                       sample_period_;
+
+    static std::size_t round_up_( std::size_t size) noexcept {
+        std::size_t page = boost::context::stack_traits::page_size();
+        return ( size + page - 1) / page * page;
+    }
+
+public:
+    explicit adaptive_stack( std::string const& tag,
+                             std::size_t max_size = boost::context::stack_traits::default_size(),
+                             std::size_t min_size = boost::context::stack_traits::minimum_size(),
+                             double margin = 2.0,
+                             std::uint64_t learn_samples = 32,
+                             std::uint64_t sample_period = 16,
+                             stack_profile & profile = stack_profile::global() ) :
+        counters_{ profile.counters( tag) },
+        max_size_{ round_up_( max_size) },
+        min_size_{ round_up_( min_size) },
+        margin_{ margin },
+        learn_samples_{ learn_samples },
+        sample_period_{ 0 < sample_period ? sample_period : 1 } {
+        BOOST_ASSERT( min_size_ <= max_size_);
+        BOOST_ASSERT( 1.0 <= margin_);
+    }
+
+    // stack size used for the next fiber
+    std::size_t stack_size() const noexcept {
+        if ( counters_->samples.load( std::memory_order_relaxed) < learn_samples_) {
+            return max_size_;
+        }
+        std::size_t size = round_up_( static_cast< std::size_t >(
+                    margin_ * counters_->max_used.load( std::memory_order_relaxed) ) );
+        return size < min_size_ ? min_size_ : ( max_size_ < size ? max_size_ : size);
+    }
+
+    boost::context::stack_context allocate() {
+        bool painted = counters_->samples.load( std::memory_order_relaxed) < learn_samples_ ||
+            0 == counters_->allocations.fetch_add( 1, std::memory_order_relaxed) % sample_period_;
+        boost::context::stack_context sctx = StackAlloc{ stack_size() }.allocate();
+        if ( painted) {
+            detail::paint_stack( sctx, traits_type::guard_size() );
+            sctx.size -= marker;
+        }
+        return sctx;
+    }
+
+    void deallocate( boost::context::stack_context & sctx) noexcept {
+        if ( 0 != sctx.size % boost::context::stack_traits::page_size() ) {
+            sctx.size += marker;
+            counters_->record( detail::measure_stack( sctx, traits_type::guard_size() ) );
+        }
+        cache_traits_type::deallocate( sctx);
+    }
+};
+
+}}
+
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_STACK_PROFILE_H
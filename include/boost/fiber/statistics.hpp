@@ -0,0 +1,72 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_STATISTICS_H
+#define BOOST_FIBERS_STATISTICS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+// runtime statistics of one or more schedulers
+// counters are only maintained if the library is compiled with
+// BOOST_FIBERS_USE_STATISTICS, otherwise all values are zero
+struct BOOST_FIBERS_DECL scheduler_statistics {
+    // bucket `i` of the histogram counts delays in [2^i, 2^(i+1)) ns
+    static constexpr std::size_t histogram_buckets = 32;
+
+    // number of schedulers that contributed to this snapshot
+    std::uint64_t   schedulers{ 0 };
+    // context switches (resumed contexts, including the dispatcher-context)
+    std::uint64_t   context_switches{ 0 };
+    // calls of this_fiber::yield()
+    std::uint64_t   yields{ 0 };
+    // contexts made ready by the owning thread (scheduler::schedule())
+    std::uint64_t   local_wakeups{ 0 };
+    // contexts made ready by other threads (scheduler::schedule_from_remote())
+    std::uint64_t   remote_wakeups{ 0 };
+    // work-stealing schedulers: steal attempts and successful steals
+    std::uint64_t   steals_attempted{ 0 };
+    std::uint64_t   steals_succeeded{ 0 };
+    // contexts currently waiting in the sleep-queue
+    std::uint64_t   sleeping{ 0 };
+    // calls of algorithm::suspend_until() and time spent blocked in it
+    std::uint64_t   suspends{ 0 };
+    std::uint64_t   suspend_ns{ 0 };
+    // stacks served from and missed by the stack-cache (use_stack_cache())
+    std::uint64_t   stack_cache_hits{ 0 };
+    std::uint64_t   stack_cache_misses{ 0 };
+    // log2-bucketed histogram of the time a context was ready before it
+    // has been resumed
+    std::uint64_t   ready_delay[histogram_buckets]{};
+
+    scheduler_statistics & operator+=( scheduler_statistics const&) noexcept;
+};
+
+// statistics of the scheduler running on the calling thread
+BOOST_FIBERS_DECL scheduler_statistics this_thread_statistics() noexcept;
+
+// aggregated statistics of all schedulers of this process (including
+// schedulers that have already been destroyed); running schedulers are not
+// stopped, the snapshot is not atomic across counters
+BOOST_FIBERS_DECL scheduler_statistics process_statistics() noexcept;
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_STATISTICS_H
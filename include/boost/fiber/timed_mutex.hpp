@@ -12,6 +12,7 @@
 #include <boost/assert.hpp>
 #include <boost/config.hpp>
 
+#include <boost/fiber/cached_clock.hpp>
 #include <boost/fiber/context.hpp>
 #include <boost/fiber/detail/config.hpp>
 #include <boost/fiber/detail/convert.hpp>
@@ -65,10 +66,14 @@ public:
 
     template< typename Rep, typename Period >
     bool try_lock_for( std::chrono::duration< Rep, Period > const& timeout_duration) {
-        return try_lock_until_( std::chrono::steady_clock::now() + timeout_duration);
+        return try_lock_until_( detail::timeout_clock::now() + timeout_duration);
     }
 
     void unlock();
+
+    // a fiber of this thread waiting for the mutex is resumed at once,
+    // the calling fiber is put into the ready-queue
+    void unlock_and_yield();
 };
 
 }}
@@ -0,0 +1,91 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_URING_H
+#define BOOST_FIBERS_URING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <system_error>
+
+extern "C" {
+#include <sys/socket.h>
+}
+
+#include <boost/config.hpp>
+
+#include <boost/fiber/algo/uring_round_robin.hpp>
+#include <boost/fiber/detail/config.hpp>
+#include <boost/fiber/detail/uring_reactor.hpp>
+#include <boost/fiber/exceptions.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+inline
+uring_reactor & active_uring_reactor() {
+    uring_reactor * reactor = uring_reactor::current();
+    if ( BOOST_UNLIKELY( nullptr == reactor) ) {
+        throw fiber_error{ std::make_error_code( std::errc::operation_not_supported),
+                           "boost fiber: scheduling algorithm of this thread is not io_uring based" };
+    }
+    return * reactor;
+}
+
+}
+
+// I/O operations suspending the calling fiber till the operation has been
+// completed; require algo::uring_round_robin
+// the result of the completion is returned, a negative errno on failure
+
+namespace uring {
+
+// `offset` -1 reads from (writes to) the current file position
+inline
+std::int32_t read( int fd, void * buffer, std::uint32_t size, std::uint64_t offset = static_cast< std::uint64_t >( -1) ) {
+    return detail::active_uring_reactor().execute(
+            IORING_OP_READ, fd, reinterpret_cast< std::uintptr_t >( buffer), size, offset, 0);
+}
+
+inline
+std::int32_t write( int fd, void const* buffer, std::uint32_t size, std::uint64_t offset = static_cast< std::uint64_t >( -1) ) {
+    return detail::active_uring_reactor().execute(
+            IORING_OP_WRITE, fd, reinterpret_cast< std::uintptr_t >( buffer), size, offset, 0);
+}
+
+inline
+std::int32_t accept( int fd, ::sockaddr * addr = nullptr, ::socklen_t * addrlen = nullptr, int flags = 0) {
+    return detail::active_uring_reactor().execute(
+            IORING_OP_ACCEPT, fd, reinterpret_cast< std::uintptr_t >( addr), 0,
+            reinterpret_cast< std::uintptr_t >( addrlen), static_cast< std::uint32_t >( flags) );
+}
+
+inline
+std::int32_t connect( int fd, ::sockaddr const* addr, ::socklen_t addrlen) {
+    return detail::active_uring_reactor().execute(
+            IORING_OP_CONNECT, fd, reinterpret_cast< std::uintptr_t >( addr), 0, addrlen, 0);
+}
+
+// `datasync` skips the flush of metadata (fdatasync())
+inline
+std::int32_t fsync( int fd, bool datasync = false) {
+    return detail::active_uring_reactor().execute(
+            IORING_OP_FSYNC, fd, 0, 0, 0, datasync ? IORING_FSYNC_DATASYNC : 0);
+}
+
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_FIBERS_URING_H
@@ -36,6 +36,11 @@ public:
     {}
 
     bool wake() const noexcept;
+
+    // like wake(), but a context of the calling thread's scheduler is not
+    // scheduled; it is stored in `ctx` so that the caller can switch to it
+    // (context::handoff())
+    bool wake_for_handoff( context *& ctx) const noexcept;
 };
 
 
@@ -79,6 +84,11 @@ public:
                                  std::chrono::steady_clock::time_point const&);
     void notify_one();
     void notify_all();
+    // return a woken context of the calling thread's scheduler (if any) that
+    // has not been scheduled; the caller must pass it to context::handoff()
+    // after releasing its locks
+    context * notify_one_for_handoff();
+    context * notify_all_for_handoff();
 
     bool empty() const;
 };
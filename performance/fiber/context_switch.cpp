@@ -0,0 +1,172 @@
+//          Copyright Oliver Kowalke 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// prints the layout of class context and measures
+//  - yield: round-robin over `n` fibers, one context switch per yield
+//  - remote wakeup: two threads passing a token between two fibers, each
+//    hand-off wakes a fiber on the other thread
+// L1 data cache read misses are counted via perf_event_open() on Linux
+// (might require kernel.perf_event_paranoid <= 2)
+//
+// usage: context_switch [number of fibers] [number of switches]
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <boost/fiber/all.hpp>
+#include <boost/fiber/detail/context_layout.hpp>
+
+using clock_type = std::chrono::steady_clock;
+using channel_type = boost::fibers::buffered_channel< std::uint64_t >;
+
+// counts L1D read misses of the calling thread; invalid() if not supported
+class l1d_misses {
+private:
+    int fd_{ -1 };
+
+public:
+    l1d_misses() {
+#if defined(__linux__)
+        perf_event_attr attr;
+        std::memset( & attr, 0, sizeof( attr) );
+        attr.size = sizeof( attr);
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_L1D |
+                      ( PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                      ( PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast< int >( ::syscall( __NR_perf_event_open, & attr, 0, -1, -1, 0) );
+#endif
+    }
+
+    ~l1d_misses() {
+#if defined(__linux__)
+        if ( -1 != fd_) {
+            ::close( fd_);
+        }
+#endif
+    }
+
+    bool invalid() const noexcept {
+        return -1 == fd_;
+    }
+
+    void start() noexcept {
+#if defined(__linux__)
+        if ( -1 != fd_) {
+            ::ioctl( fd_, PERF_EVENT_IOC_RESET, 0);
+            ::ioctl( fd_, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    std::uint64_t stop() noexcept {
+        std::uint64_t count{ 0 };
+#if defined(__linux__)
+        if ( -1 != fd_) {
+            ::ioctl( fd_, PERF_EVENT_IOC_DISABLE, 0);
+            if ( sizeof( count) != ::read( fd_, & count, sizeof( count) ) ) {
+                count = 0;
+            }
+        }
+#endif
+        return count;
+    }
+};
+
+void print( char const* name, std::uint64_t switches, clock_type::duration d, l1d_misses & misses, std::uint64_t count) {
+    std::cout << std::left << std::setw( 15) << name << std::right
+              << std::setw( 8)
+              << std::chrono::duration_cast< std::chrono::nanoseconds >( d).count() / switches
+              << " ns/switch";
+    if ( misses.invalid() ) {
+        std::cout << "       n/a L1D misses/switch";
+    } else {
+        std::cout << std::fixed << std::setprecision( 2) << std::setw( 10)
+                  << static_cast< double >( count) / switches << " L1D misses/switch";
+    }
+    std::cout << std::endl;
+}
+
+void yield_switch( std::size_t n, std::uint64_t switches) {
+    std::uint64_t rounds = switches / n;
+    l1d_misses misses;
+    std::vector< boost::fibers::fiber > fibers;
+    for ( std::size_t i = 0; i < n; ++i) {
+        fibers.emplace_back( [rounds](){
+            for ( std::uint64_t j = 0; j < rounds; ++j) {
+                boost::this_fiber::yield();
+            }
+        });
+    }
+    // let the fibers enter their loop
+    boost::this_fiber::yield();
+    clock_type::time_point start = clock_type::now();
+    misses.start();
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+    std::uint64_t count = misses.stop();
+    print( "yield", rounds * n, clock_type::now() - start, misses, count);
+}
+
+void remote_switch( std::uint64_t switches) {
+    channel_type ping{ 2 }, pong{ 2 };
+    std::thread t{ [&ping,&pong](){
+        std::uint64_t v;
+        while ( boost::fibers::channel_op_status::success == ping.pop( v) ) {
+            pong.push( v);
+        }
+    }};
+    l1d_misses misses;
+    clock_type::time_point start = clock_type::now();
+    misses.start();
+    for ( std::uint64_t i = 0; i < switches; ++i) {
+        ping.push( i);
+        pong.value_pop();
+    }
+    std::uint64_t count = misses.stop();
+    clock_type::duration d = clock_type::now() - start;
+    ping.close();
+    t.join();
+    print( "remote wakeup", 2 * switches, d, misses, count);
+}
+
+int main( int argc, char * argv[]) {
+    try {
+        std::size_t n = 1 < argc ? std::stoul( argv[1]) : 1000;
+        std::uint64_t switches = 2 < argc ? std::stoull( argv[2]) : 10000000;
+        boost::fibers::fiber{ [](){
+            boost::fibers::detail::context_layout::report(
+                std::cout, boost::fibers::context::active() );
+        }}.join();
+        std::cout << std::endl;
+        yield_switch( 2, switches);
+        yield_switch( n, switches);
+        remote_switch( switches / 1000);
+        return EXIT_SUCCESS;
+    } catch ( std::exception const& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "unhandled exception" << std::endl;
+    }
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,154 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// requests with deadlines arrive in bursts at a rate exceeding the capacity
+// of one thread; compares completion latency and missed
+// deadlines of round_robin (FIFO) and edf (earliest deadline first)
+//
+// usage: edf_overload [load in percent of the capacity during the burst]
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/fiber/all.hpp>
+
+using clock_type = std::chrono::steady_clock;
+using duration_type = clock_type::duration;
+using time_point_type = clock_type::time_point;
+
+using us = std::chrono::microseconds;
+using ms = std::chrono::milliseconds;
+
+// one unit of work takes `slice`, a request yields between its units
+constexpr us slice{ 20 };
+
+struct request {
+    time_point_type     arrival;
+    time_point_type     deadline;
+    std::size_t         units;
+    bool                interactive;
+    duration_type       latency{};
+};
+
+void burn( us const& d) {
+    time_point_type end{ clock_type::now() + d };
+    while ( clock_type::now() < end) {
+    }
+}
+
+// 80% interactive requests (1 unit, 2ms deadline), 20% batch requests
+// (10 units, 20ms deadline); 20 cycles of a 20ms burst followed by 80ms at
+// 30% of the capacity
+std::vector< request > generate( unsigned int load) {
+    std::minstd_rand generator{ 42 };
+    std::uniform_real_distribution< double > coin{ 0., 1. };
+    std::vector< request > requests;
+    // mean work per request = 0.8 * 1 + 0.2 * 10 units
+    double const mean = ( 0.8 * 1 + 0.2 * 10) * slice.count();
+    time_point_type tp{};
+    for ( int cycle = 0; cycle < 20; ++cycle) {
+        for ( int phase = 0; phase < 2; ++phase) {
+            double const percent = 0 == phase ? load : 30.;
+            us const interval{ static_cast< us::rep >( mean * 100. / percent) };
+            time_point_type const end = tp + ( 0 == phase ? ms( 20) : ms( 80) );
+            for ( ; tp < end; tp += interval) {
+                bool interactive = coin( generator) < 0.8;
+                requests.push_back( request{
+                    tp,
+                    tp + ( interactive ? ms( 2) : ms( 20) ),
+                    interactive ? std::size_t{ 1 } : std::size_t{ 10 },
+                    interactive });
+            }
+        }
+    }
+    return requests;
+}
+
+template< typename Algo >
+void run( std::vector< request > requests, char const* name, bool deadlines) {
+    std::thread t{ [&requests,deadlines](){
+        boost::fibers::use_scheduling_algorithm< Algo >();
+        time_point_type const start{ clock_type::now() + ms( 1) };
+        std::vector< boost::fibers::fiber > fibers;
+        fibers.reserve( requests.size() );
+        boost::fibers::fiber generator{ [&](){
+            for ( request & r : requests) {
+                r.arrival = start + ( r.arrival - time_point_type{} );
+                r.deadline = start + ( r.deadline - time_point_type{} );
+                boost::this_fiber::sleep_until( r.arrival);
+                fibers.emplace_back( boost::fibers::launch::post, [&r](){
+                    for ( std::size_t i = 0; i < r.units; ++i) {
+                        if ( 0 < i) {
+                            boost::this_fiber::yield();
+                        }
+                        burn( slice);
+                    }
+                    r.latency = clock_type::now() - r.arrival;
+                });
+                if ( deadlines) {
+                    fibers.back().properties< boost::fibers::algo::edf_props >().set_deadline( r.deadline);
+                }
+            }
+        }};
+        if ( deadlines) {
+            // the generator emulates the arrival of requests
+            generator.properties< boost::fibers::algo::edf_props >().set_deadline( time_point_type{} );
+        }
+        generator.join();
+        for ( boost::fibers::fiber & f : fibers) {
+            f.join();
+        }
+    }};
+    t.join();
+    for ( int interactive = 1; 0 <= interactive; --interactive) {
+        std::vector< duration_type > latencies;
+        std::size_t missed = 0;
+        for ( request const& r : requests) {
+            if ( r.interactive != ( 1 == interactive) ) {
+                continue;
+            }
+            latencies.push_back( r.latency);
+            if ( r.arrival + r.latency > r.deadline) {
+                ++missed;
+            }
+        }
+        std::sort( latencies.begin(), latencies.end() );
+        auto percentile = [&latencies]( double p) {
+            return std::chrono::duration_cast< us >(
+                    latencies[ static_cast< std::size_t >( p * ( latencies.size() - 1) ) ]).count();
+        };
+        std::cout << std::left << std::setw( 12) << name
+                  << std::setw( 13) << ( 1 == interactive ? "interactive" : "batch")
+                  << "p50: " << std::setw( 8) << percentile( 0.5)
+                  << "p99: " << std::setw( 8) << percentile( 0.99)
+                  << "max: " << std::setw( 8) << percentile( 1.)
+                  << "missed: " << missed << "/" << latencies.size() << std::endl;
+    }
+}
+
+int main( int argc, char * argv[]) {
+    try {
+        unsigned int load = 1 < argc ? static_cast< unsigned int >( std::stoul( argv[1]) ) : 130;
+        std::vector< request > requests = generate( load);
+        std::cout << "requests: " << requests.size() << ", burst load: " << load << "%, latency in us" << std::endl;
+        run< boost::fibers::algo::round_robin >( requests, "round_robin", false);
+        run< boost::fibers::algo::edf >( requests, "edf", true);
+        return EXIT_SUCCESS;
+    } catch ( std::exception const& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "unhandled exception" << std::endl;
+    }
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,123 @@
+//          Copyright Oliver Kowalke 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// based on https://github.com/atemerev/skynet from Alexander Temerev
+//
+// runs skynet_shared_detach with shared_work (one queue guarded by a mutex)
+// and lockfree_shared_work (bounded lock-free MPMC queue) on 1..N threads
+//
+// usage: skynet_shared_scaling [max. number of threads] [number of leaf fibers]
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/fiber/all.hpp>
+#include <boost/fiber/numa/pin_thread.hpp>
+
+#include "barrier.hpp"
+
+using allocator_type = boost::fibers::fixedsize_stack;
+using channel_type = boost::fibers::buffered_channel< std::uint64_t >;
+using clock_type = std::chrono::steady_clock;
+using duration_type = clock_type::duration;
+using lock_type = std::unique_lock< std::mutex >;
+using time_point_type = clock_type::time_point;
+
+// microbenchmark
+void skynet( allocator_type & salloc, channel_type & c, std::size_t num, std::size_t size, std::size_t div) {
+    if ( 1 == size) {
+        c.push( num);
+    } else {
+        channel_type rc{ 16 };
+        for ( std::size_t i = 0; i < div; ++i) {
+            auto sub_num = num + i * size / div;
+            boost::fibers::fiber{ boost::fibers::launch::dispatch,
+                              std::allocator_arg, salloc,
+                              skynet,
+                              std::ref( salloc), std::ref( rc), sub_num, size / div, div }.detach();
+        }
+        std::uint64_t sum{ 0 };
+        for ( std::size_t i = 0; i < div; ++i) {
+            sum += rc.value_pop();
+        }
+        c.push( sum);
+    }
+}
+
+// runs skynet on `n` new threads, returns the duration in ms
+template< typename Algo >
+std::int64_t run( unsigned int n, std::size_t size) {
+    std::size_t div{ 10 };
+    bool done = false;
+    std::mutex mtx{};
+    boost::fibers::condition_variable_any cnd{};
+    barrier b( n);
+    duration_type duration{};
+    std::uint64_t result{ 0 };
+    // two pages (as in skynet_shared_detach) might overflow with recent compilers
+    allocator_type salloc{ 16*allocator_type::traits_type::page_size() };
+    std::vector< std::thread > threads;
+    for ( unsigned int i = 0; i < n; ++i) {
+        threads.emplace_back( [&,i](){
+            if ( i < std::thread::hardware_concurrency() ) {
+                boost::fibers::numa::pin_thread( i);
+            }
+            boost::fibers::use_scheduling_algorithm< Algo >();
+            b.wait();
+            if ( 0 == i) {
+                channel_type rc{ 2 };
+                time_point_type start{ clock_type::now() };
+                skynet( salloc, rc, 0, size, div);
+                result = rc.value_pop();
+                duration = clock_type::now() - start;
+                lock_type lk( mtx);
+                done = true;
+                lk.unlock();
+                cnd.notify_all();
+            } else {
+                lock_type lk( mtx);
+                cnd.wait( lk, [&done](){ return done; });
+            }
+        });
+    }
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+    if ( size * ( size - 1) / 2 != result) {
+        throw std::runtime_error("invalid result");
+    }
+    return std::chrono::duration_cast< std::chrono::milliseconds >( duration).count();
+}
+
+int main( int argc, char * argv[]) {
+    try {
+        unsigned int max = 1 < argc ? std::stoul( argv[1]) : std::thread::hardware_concurrency();
+        std::size_t size = 2 < argc ? std::stoul( argv[2]) : 1000000;
+        std::cout << "threads  shared_work  lockfree_shared_work" << std::endl;
+        for ( unsigned int n = 1; n <= max; ++n) {
+            std::int64_t shared = run< boost::fibers::algo::shared_work >( n, size);
+            std::int64_t lockfree = run< boost::fibers::algo::lockfree_shared_work >( n, size);
+            std::cout << std::setw( 7) << n
+                      << std::setw( 11) << shared << " ms"
+                      << std::setw( 19) << lockfree << " ms" << std::endl;
+        }
+        return EXIT_SUCCESS;
+    } catch ( std::exception const& e) {
+        std::cerr << "exception: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "unhandled exception" << std::endl;
+    }
+	return EXIT_FAILURE;
+}
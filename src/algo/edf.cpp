@@ -0,0 +1,117 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/algo/edf.hpp"
+
+#include <boost/assert.hpp>
+#include <boost/context/detail/prefetch.hpp>
+
+#include "boost/fiber/type.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+std::chrono::steady_clock::time_point
+edf_queue_deadline( context * ctx, algo::edf_props & props, edf_queue_type const& rqueue) noexcept {
+    if ( ! ctx->is_context( type::dispatcher_context) ) {
+        return props.get_deadline();
+    }
+    std::chrono::steady_clock::time_point deadline = rqueue.empty()
+        ? (std::chrono::steady_clock::time_point::max)()
+        : rqueue.begin()->key_.deadline;
+    // no active fiber while the thread is initialized; properties are not
+    // yet assigned if the active fiber has not passed awakened()
+    context * active_ctx = context::active();
+    algo::edf_props * active_props = nullptr != active_ctx
+        ? dynamic_cast< algo::edf_props * >( active_ctx->get_properties() )
+        : nullptr;
+    if ( nullptr != active_props && active_props->get_deadline() < deadline) {
+        deadline = active_props->get_deadline();
+    }
+    return deadline;
+}
+
+}
+
+namespace algo {
+
+void
+edf::awakened( context * ctx, edf_props & props) noexcept {
+    BOOST_ASSERT( nullptr != ctx);
+    BOOST_ASSERT( ! props.hook_.is_linked() );
+    BOOST_ASSERT( ctx->is_resumable() );
+    props.key_.deadline = detail::edf_queue_deadline( ctx, props, rqueue_);
+    props.key_.seq = seq_++;
+    rqueue_.insert( props);
+}
+
+context *
+edf::pick_next() noexcept {
+    if ( rqueue_.empty() ) {
+        return nullptr;
+    }
+    edf_props & props = * rqueue_.begin();
+    rqueue_.erase( rqueue_.begin() );
+    context * victim = props.get_context();
+    boost::context::detail::prefetch_range( victim, sizeof( context) );
+    BOOST_ASSERT( victim->is_resumable() );
+    return victim;
+}
+
+bool
+edf::has_ready_fibers() const noexcept {
+    return ! rqueue_.empty();
+}
+
+std::size_t
+edf::properties_size() const noexcept {
+    // fibers launched on this thread get their properties on top of their
+    // stack instead of from new_properties()
+    return in_place_properties_size();
+}
+
+void
+edf::property_change( context * ctx, edf_props & props) noexcept {
+    // a running or blocked fiber is queued with its new deadline if it
+    // becomes ready
+    if ( ! props.hook_.is_linked() || ctx->is_context( type::dispatcher_context) ) {
+        return;
+    }
+    rqueue_.erase( rqueue_.iterator_to( props) );
+    props.key_.deadline = props.get_deadline();
+    rqueue_.insert( props);
+}
+
+void
+edf::suspend_until( std::chrono::steady_clock::time_point const& time_point) noexcept {
+    if ( (std::chrono::steady_clock::time_point::max)() == time_point) {
+        std::unique_lock< std::mutex > lk{ mtx_ };
+        cnd_.wait( lk, [this](){ return flag_; });
+        flag_ = false;
+    } else {
+        std::unique_lock< std::mutex > lk{ mtx_ };
+        cnd_.wait_until( lk, time_point, [this](){ return flag_; });
+        flag_ = false;
+    }
+}
+
+void
+edf::notify() noexcept {
+    std::unique_lock< std::mutex > lk{ mtx_ };
+    flag_ = true;
+    lk.unlock();
+    cnd_.notify_all();
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
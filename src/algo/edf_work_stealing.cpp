@@ -0,0 +1,229 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/algo/edf_work_stealing.hpp"
+
+#include <algorithm>
+
+#include <boost/assert.hpp>
+#include <boost/context/detail/prefetch.hpp>
+
+#include "boost/fiber/scheduler.hpp"
+#include "boost/fiber/type.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace algo {
+
+constexpr std::size_t edf_work_stealing::steal_batch_size;
+
+edf_work_stealing_pool::edf_work_stealing_pool( std::uint32_t thread_count) :
+        thread_count_{ thread_count },
+        registry_{ thread_count, thread_count } {
+}
+
+std::shared_ptr< edf_work_stealing_pool > const&
+edf_work_stealing::default_pool_( std::uint32_t thread_count) {
+    static std::shared_ptr< edf_work_stealing_pool > pool{
+        std::make_shared< edf_work_stealing_pool >( thread_count) };
+    return pool;
+}
+
+edf_work_stealing::edf_work_stealing( std::uint32_t thread_count, bool suspend) :
+        edf_work_stealing{ default_pool_( thread_count), suspend } {
+}
+
+edf_work_stealing::edf_work_stealing( std::shared_ptr< edf_work_stealing_pool > pool, bool suspend) :
+        pool_{ std::move( pool) },
+        thread_count_{ pool_->thread_count_ },
+        peer_{ pool_->registry_, pool_->counter_++, suspend } {
+    // register pointer of this scheduler
+    pool_->registry_.join( peer_.id(), this);
+    // wait till all threads of the pool have joined
+    pool_->registry_.wait();
+}
+
+edf_work_stealing::~edf_work_stealing() {
+    pool_->registry_.leave( peer_.id() );
+}
+
+bool
+edf_work_stealing::stealable_() const noexcept {
+    detail::spinlock_lock lk{ splk_ };
+    return ! rqueue_.empty();
+}
+
+void
+edf_work_stealing::awakened( context * ctx, edf_props & props) noexcept {
+    bool stealable = ! ctx->is_pinned();
+    if ( stealable) {
+        ctx->detach();
+    }
+    {
+        detail::spinlock_lock lk{ splk_ };
+        BOOST_ASSERT( ! props.hook_.is_linked() );
+        props.key_.deadline = (std::min)(
+            detail::edf_queue_deadline( ctx, props, rqueue_),
+            detail::edf_queue_deadline( ctx, props, pinned_) );
+        props.key_.seq = seq_++;
+        ( stealable ? rqueue_ : pinned_).insert( props);
+    }
+    if ( stealable) {
+        peer_.pushed();
+    }
+}
+
+context *
+edf_work_stealing::pick_next() noexcept {
+    context * victim = nullptr;
+    {
+        detail::spinlock_lock lk{ splk_ };
+        // nearest deadline of both queues
+        detail::edf_queue_type * q = & rqueue_;
+        if ( rqueue_.empty() ||
+             ( ! pinned_.empty() && pinned_.begin()->key_ < rqueue_.begin()->key_) ) {
+            q = & pinned_;
+        }
+        if ( ! q->empty() ) {
+            edf_props & props = * q->begin();
+            q->erase( q->begin() );
+            victim = props.get_context();
+        }
+    }
+    if ( nullptr != victim) {
+        boost::context::detail::prefetch_range( victim, sizeof( context) );
+        if ( ! victim->is_pinned() ) {
+            context::active()->attach( victim);
+        }
+    } else {
+        std::size_t count = 0;
+        context * batch[steal_batch_size];
+        std::size_t n = peer_.steal_from_last_victim( batch, count);
+        if ( 0 == n) {
+            // random selection of one peer
+            n = peer_.steal_from_random(
+                    thread_count_,
+                    []( std::size_t i){ return static_cast< std::uint32_t >( i); },
+                    batch, count);
+        }
+#if defined(BOOST_FIBERS_USE_STATISTICS)
+        detail::statistics_counters & stats = context::active()->get_scheduler()->counters();
+        stats.steals_attempted.add( count);
+        if ( 0 < n) {
+            stats.steals_succeeded.add();
+        }
+#endif
+        if ( 0 < n) {
+            detail::spinlock_lock lk{ splk_ };
+            // the stolen contexts keep their deadlines, the one with the
+            // nearest deadline is resumed; the others get attached if they
+            // are picked from the local ready-queue
+            for ( std::size_t i = 0; i < n; ++i) {
+                BOOST_ASSERT( ! batch[i]->is_pinned() );
+                edf_props & props = properties( batch[i]);
+                props.set_algorithm( this);
+                props.key_.deadline = props.get_deadline();
+                props.key_.seq = seq_++;
+                rqueue_.insert( props);
+            }
+            edf_props & props = * rqueue_.begin();
+            rqueue_.erase( rqueue_.begin() );
+            victim = props.get_context();
+            lk.unlock();
+            boost::context::detail::prefetch_range( victim, sizeof( context) );
+            context::active()->attach( victim);
+        }
+    }
+    if ( nullptr != victim && ! victim->is_pinned() ) {
+        peer_.found_work( has_ready_fibers() );
+    }
+    return victim;
+}
+
+context *
+edf_work_stealing::steal() noexcept {
+    detail::spinlock_lock lk{ splk_ };
+    if ( rqueue_.empty() ) {
+        return nullptr;
+    }
+    // the fiber with the latest deadline is the one its owner would run last;
+    // pinned contexts are queued apart, no scan is required
+    edf_props & props = * rqueue_.rbegin();
+    context * ctx = props.get_context();
+    BOOST_ASSERT( ! ctx->is_pinned() );
+    rqueue_.erase( rqueue_.iterator_to( props) );
+    return ctx;
+}
+
+std::size_t
+edf_work_stealing::steal_batch( context ** ctxs, std::size_t max) noexcept {
+    detail::spinlock_lock lk{ splk_ };
+    std::size_t i = 0;
+    if ( ! rqueue_.empty() ) {
+        // half of the ready fibers (rounded up); constant_time_size is
+        // disabled, counting stops at 2 * max
+        std::size_t size = 0;
+        for ( auto j = rqueue_.begin(); j != rqueue_.end() && size < 2 * max; ++j) {
+            ++size;
+        }
+        std::size_t n = (std::min)( ( size + 1) / 2, max);
+        for ( ; i < n; ++i) {
+            edf_props & props = * rqueue_.rbegin();
+            BOOST_ASSERT( ! props.get_context()->is_pinned() );
+            rqueue_.erase( rqueue_.iterator_to( props) );
+            ctxs[i] = props.get_context();
+        }
+    }
+    return i;
+}
+
+bool
+edf_work_stealing::has_ready_fibers() const noexcept {
+    detail::spinlock_lock lk{ splk_ };
+    return ! rqueue_.empty() || ! pinned_.empty();
+}
+
+std::size_t
+edf_work_stealing::properties_size() const noexcept {
+    // fibers launched on this thread get their properties on top of their
+    // stack instead of from new_properties()
+    return in_place_properties_size();
+}
+
+void
+edf_work_stealing::property_change( context * ctx, edf_props & props) noexcept {
+    if ( ctx->is_context( type::dispatcher_context) ) {
+        return;
+    }
+    detail::spinlock_lock lk{ splk_ };
+    // the fiber might have been stolen meanwhile
+    if ( ! props.hook_.is_linked() ) {
+        return;
+    }
+    detail::edf_queue_type & q = ctx->is_pinned() ? pinned_ : rqueue_;
+    q.erase( q.iterator_to( props) );
+    props.key_.deadline = props.get_deadline();
+    q.insert( props);
+}
+
+void
+edf_work_stealing::suspend_until( std::chrono::steady_clock::time_point const& time_point) noexcept {
+    peer_.suspend_until( time_point);
+}
+
+void
+edf_work_stealing::notify() noexcept {
+    peer_.notify();
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
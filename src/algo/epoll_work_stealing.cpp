@@ -0,0 +1,63 @@
+//          Copyright Oliver Kowalke 2015.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+
+#include "boost/fiber/algo/epoll_work_stealing.hpp"
+
+#include "boost/fiber/type.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace algo {
+
+epoll_work_stealing::epoll_work_stealing( std::uint32_t thread_count) :
+        work_stealing{ thread_count, true } {
+}
+
+epoll_work_stealing::epoll_work_stealing( std::shared_ptr< work_stealing_pool > pool) :
+        work_stealing{ std::move( pool), true } {
+}
+
+epoll_work_stealing::~epoll_work_stealing() {
+    // peers must not notify the reactor while it is destroyed
+    leave_();
+}
+
+context *
+epoll_work_stealing::pick_next() noexcept {
+    // called by the dispatcher-context once per round: look for ready
+    // descriptors without blocking
+    if ( reactor_.waiting() && context::active()->is_context( type::dispatcher_context) ) {
+        reactor_.poll( 0);
+    }
+    context * victim = work_stealing::pick_next();
+    return victim;
+}
+
+void
+epoll_work_stealing::suspend_until( std::chrono::steady_clock::time_point const& time_point) noexcept {
+    // parked like work_stealing, peers with stealable work notify() the reactor
+    if ( park_() ) {
+        reactor_.run_until( time_point);
+    } else {
+        reactor_.poll( 0);
+    }
+    unpark_();
+}
+
+void
+epoll_work_stealing::notify() noexcept {
+    reactor_.notify();
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
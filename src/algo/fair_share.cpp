@@ -0,0 +1,253 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/algo/fair_share.hpp"
+
+#include <system_error>
+
+#include <boost/assert.hpp>
+#include <boost/context/detail/prefetch.hpp>
+
+#include "boost/fiber/exceptions.hpp"
+#include "boost/fiber/type.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace algo {
+
+namespace {
+
+thread_local fair_share * current_fair_share{ nullptr };
+
+std::uint32_t clamp_weight( std::uint32_t weight) noexcept {
+    if ( 0 == weight) {
+        return 1;
+    }
+    if ( ( std::uint32_t{ 1 } << 20) < weight) {
+        return std::uint32_t{ 1 } << 20;
+    }
+    return weight;
+}
+
+}
+
+constexpr std::uint32_t fair_share::default_weight;
+
+void
+fair_share_props::set_group( std::uint32_t group) noexcept {
+    if ( group != group_) {
+        group_ = group;
+        // properties passed to the fiber constructor are not yet assigned
+        // to an algorithm
+        if ( nullptr != algo_) {
+            notify();
+        }
+    }
+}
+
+fair_share *
+fair_share::current() noexcept {
+    return current_fair_share;
+}
+
+fair_share::fair_share() {
+    // group 0
+    create_group();
+    current_fair_share = this;
+}
+
+fair_share::~fair_share() {
+    if ( this == current_fair_share) {
+        current_fair_share = nullptr;
+    }
+}
+
+fair_share::group &
+fair_share::group_( std::uint32_t id) const {
+    if ( BOOST_UNLIKELY( groups_.size() <= id) ) {
+        throw fiber_error{ std::make_error_code( std::errc::invalid_argument),
+                           "boost fiber: unknown fair-share group" };
+    }
+    return * groups_[id];
+}
+
+std::uint32_t
+fair_share::create_group( std::uint32_t weight) {
+    std::uint32_t id = static_cast< std::uint32_t >( groups_.size() );
+    groups_.emplace_back( new group{ id, clamp_weight( weight) });
+    return id;
+}
+
+void
+fair_share::set_weight( std::uint32_t id, std::uint32_t weight) {
+    // takes effect with the next run time charged to the group
+    group_( id).weight = clamp_weight( weight);
+}
+
+std::uint32_t
+fair_share::get_weight( std::uint32_t id) const {
+    return group_( id).weight;
+}
+
+std::chrono::nanoseconds
+fair_share::get_runtime( std::uint32_t id) const {
+    return group_( id).runtime;
+}
+
+void
+fair_share::push_( context * ctx, fair_share_props & props) noexcept {
+    std::uint32_t id = props.get_group();
+    if ( groups_.size() <= id) {
+        id = 0;
+    }
+    group & g = * groups_[id];
+    if ( g.rqueue.empty() && ! g.hook.is_linked() ) {
+        // a group becoming ready competes from the current minimum on
+        if ( g.vruntime < min_vruntime_) {
+            g.vruntime = min_vruntime_;
+        }
+        gqueue_.insert( g);
+    }
+    props.queued_ = id;
+    ctx->ready_link( g.rqueue);
+    ++ready_;
+}
+
+void
+fair_share::charge_( std::chrono::steady_clock::time_point const& now) noexcept {
+    if ( nullptr == running_) {
+        return;
+    }
+    group & g = * running_;
+    std::chrono::nanoseconds d = std::chrono::duration_cast< std::chrono::nanoseconds >( now - last_);
+    g.runtime += d;
+    std::uint64_t delta = static_cast< std::uint64_t >( d.count() ) * default_weight / g.weight;
+    if ( g.hook.is_linked() ) {
+        gqueue_.erase( gqueue_.iterator_to( g) );
+        g.vruntime += delta;
+        gqueue_.insert( g);
+    } else {
+        g.vruntime += delta;
+    }
+    // smallest virtual run time of the ready groups and the running group
+    std::uint64_t vruntime = g.vruntime;
+    if ( ! gqueue_.empty() && gqueue_.begin()->vruntime < vruntime) {
+        vruntime = gqueue_.begin()->vruntime;
+    }
+    if ( min_vruntime_ < vruntime) {
+        min_vruntime_ = vruntime;
+    }
+}
+
+void
+fair_share::awakened( context * ctx, fair_share_props & props) noexcept {
+    BOOST_ASSERT( nullptr != ctx);
+    BOOST_ASSERT( ! ctx->ready_is_linked() );
+    BOOST_ASSERT( ctx->is_resumable() );
+    if ( ctx->is_context( type::dispatcher_context) ) {
+        // the dispatcher-context runs once per round of the ready fibers,
+        // its run time is not charged to a group
+        BOOST_ASSERT( nullptr == dispatcher_);
+        dispatcher_ = ctx;
+        budget_ = ready_;
+        return;
+    }
+    push_( ctx, props);
+}
+
+context *
+fair_share::pick_next() noexcept {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    charge_( now);
+    // a yielding fiber is passed to awakened() after pick_next() returned;
+    // if it is the only ready fiber of its group and the group is still
+    // entitled to run, the decision is deferred to the dispatcher-context
+    // that runs after the fiber has been enqueued again
+    bool defer = nullptr != running_ && ! running_->hook.is_linked() &&
+                 ( gqueue_.empty() || running_->vruntime < gqueue_.begin()->vruntime);
+    last_ = now;
+    running_ = nullptr;
+    context * victim = nullptr;
+    if ( nullptr != dispatcher_ && ( defer || 0 == budget_ || 0 == ready_) ) {
+        victim = dispatcher_;
+        dispatcher_ = nullptr;
+    } else if ( 0 < ready_) {
+        if ( 0 < budget_) {
+            --budget_;
+        }
+        group & g = * gqueue_.begin();
+        victim = & g.rqueue.front();
+        g.rqueue.pop_front();
+        --ready_;
+        if ( g.rqueue.empty() ) {
+            gqueue_.erase( gqueue_.iterator_to( g) );
+        }
+        running_ = & g;
+    } else {
+        return nullptr;
+    }
+    boost::context::detail::prefetch_range( victim, sizeof( context) );
+    BOOST_ASSERT( ! victim->ready_is_linked() );
+    BOOST_ASSERT( victim->is_resumable() );
+    return victim;
+}
+
+bool
+fair_share::has_ready_fibers() const noexcept {
+    return 0 < ready_ || nullptr != dispatcher_;
+}
+
+std::size_t
+fair_share::properties_size() const noexcept {
+    // fibers launched on this thread get their properties on top of their
+    // stack instead of from new_properties()
+    return in_place_properties_size();
+}
+
+void
+fair_share::property_change( context * ctx, fair_share_props & props) noexcept {
+    // a running or blocked fiber joins its new group if it becomes ready
+    if ( ! ctx->ready_is_linked() || ctx->is_context( type::dispatcher_context) ) {
+        return;
+    }
+    group & g = * groups_[props.queued_];
+    ctx->ready_unlink();
+    --ready_;
+    if ( g.rqueue.empty() ) {
+        gqueue_.erase( gqueue_.iterator_to( g) );
+    }
+    push_( ctx, props);
+}
+
+void
+fair_share::suspend_until( std::chrono::steady_clock::time_point const& time_point) noexcept {
+    if ( (std::chrono::steady_clock::time_point::max)() == time_point) {
+        std::unique_lock< std::mutex > lk{ mtx_ };
+        cnd_.wait( lk, [this](){ return flag_; });
+        flag_ = false;
+    } else {
+        std::unique_lock< std::mutex > lk{ mtx_ };
+        cnd_.wait_until( lk, time_point, [this](){ return flag_; });
+        flag_ = false;
+    }
+}
+
+void
+fair_share::notify() noexcept {
+    std::unique_lock< std::mutex > lk{ mtx_ };
+    flag_ = true;
+    lk.unlock();
+    cnd_.notify_all();
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
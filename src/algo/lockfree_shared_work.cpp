@@ -0,0 +1,119 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/algo/lockfree_shared_work.hpp"
+
+#include <boost/assert.hpp>
+
+#include "boost/fiber/type.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace algo {
+
+context *
+lockfree_shared_work::pop_overflow_() noexcept {
+    std::unique_lock< std::mutex > lk{ oqueue_mtx_ };
+    if ( oqueue_.empty() ) {
+        return nullptr;
+    }
+    context * ctx = oqueue_.front();
+    oqueue_.pop_front();
+    oqueue_size_.store( oqueue_.size(), std::memory_order_relaxed);
+    return ctx;
+}
+
+void
+lockfree_shared_work::awakened( context * ctx) noexcept {
+    if ( ctx->is_context( type::pinned_context) ) {
+        // never put main- or dispatcher-context on the shared queue
+        lqueue_.push_back( * ctx);
+        return;
+    }
+    if ( ctx->is_pinned() ) {
+        // worker fiber bound to this thread
+        pinned_.push_back( * ctx);
+        return;
+    }
+    ctx->detach();
+    // while fibers wait in the overflow queue, newer fibers queue up
+    // behind them
+    if ( 0 == oqueue_size_.load( std::memory_order_relaxed) && rqueue_.push( ctx) ) {
+        return;
+    }
+    std::unique_lock< std::mutex > lk{ oqueue_mtx_ };
+    oqueue_.push_back( ctx);
+    oqueue_size_.store( oqueue_.size(), std::memory_order_relaxed);
+}
+
+context *
+lockfree_shared_work::pick_next() noexcept {
+    context * ctx = nullptr;
+    // fibers bound to this thread and the shared queues take turns,
+    // neither starves the other
+    pinned_turn_ = ! pinned_turn_;
+    if ( pinned_turn_ && ! pinned_.empty() ) {
+        ctx = & pinned_.front();
+        pinned_.pop_front();
+        return ctx;
+    }
+    ctx = rqueue_.pop();
+    if ( nullptr == ctx && 0 != oqueue_size_.load( std::memory_order_relaxed) ) {
+        ctx = pop_overflow_();
+    }
+    if ( nullptr != ctx) {
+        // attach context to current scheduler via the active fiber
+        // of this thread
+        context::active()->attach( ctx);
+    } else if ( ! pinned_.empty() ) {
+        ctx = & pinned_.front();
+        pinned_.pop_front();
+    } else if ( ! lqueue_.empty() ) {
+        // nothing else is ready, return main or dispatcher fiber
+        ctx = & lqueue_.front();
+        lqueue_.pop_front();
+    }
+    return ctx;
+}
+
+void
+lockfree_shared_work::suspend_until( std::chrono::steady_clock::time_point const& time_point) noexcept {
+    if ( suspend_) {
+        if ( (std::chrono::steady_clock::time_point::max)() == time_point) {
+            std::unique_lock< std::mutex > lk{ mtx_ };
+            cnd_.wait( lk, [this](){ return flag_; });
+            flag_ = false;
+        } else {
+            std::unique_lock< std::mutex > lk{ mtx_ };
+            cnd_.wait_until( lk, time_point, [this](){ return flag_; });
+            flag_ = false;
+        }
+    }
+}
+
+void
+lockfree_shared_work::notify() noexcept {
+    if ( suspend_) {
+        std::unique_lock< std::mutex > lk{ mtx_ };
+        flag_ = true;
+        lk.unlock();
+        cnd_.notify_all();
+    }
+}
+
+detail::context_mpmc_queue lockfree_shared_work::rqueue_{ BOOST_FIBERS_MPMC_QUEUE_CAPACITY };
+lockfree_shared_work::oqueue_type lockfree_shared_work::oqueue_{};
+std::mutex lockfree_shared_work::oqueue_mtx_{};
+std::atomic< std::size_t > lockfree_shared_work::oqueue_size_{ 0 };
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
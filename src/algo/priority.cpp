@@ -0,0 +1,172 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/algo/priority.hpp"
+
+#include <boost/assert.hpp>
+#include <boost/context/detail/prefetch.hpp>
+
+#include "boost/fiber/type.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace algo {
+
+namespace {
+
+int clamp_priority( int p) noexcept {
+    if ( 0 > p) {
+        return 0;
+    }
+    if ( static_cast< int >( priority::levels) <= p) {
+        return static_cast< int >( priority::levels) - 1;
+    }
+    return p;
+}
+
+}
+
+constexpr std::size_t priority::levels;
+
+priority_props::priority_props( context * ctx, int p) noexcept :
+        fiber_properties{ ctx },
+        priority_{ clamp_priority( p) } {
+}
+
+void
+priority_props::set_priority( int p) noexcept {
+    p = clamp_priority( p);
+    if ( p != priority_) {
+        priority_ = p;
+        // properties passed to the fiber constructor are not yet assigned
+        // to an algorithm
+        if ( nullptr != algo_) {
+            notify();
+        }
+    }
+}
+
+std::size_t
+priority::highest_level_() const noexcept {
+    BOOST_ASSERT( 0 != bitmap_);
+#if defined(__GNUC__) || defined(__clang__)
+    return 31 - static_cast< std::size_t >( __builtin_clz( bitmap_) );
+#else
+    std::size_t level = levels - 1;
+    while ( 0 == ( bitmap_ & ( std::uint32_t{ 1 } << level) ) ) {
+        --level;
+    }
+    return level;
+#endif
+}
+
+void
+priority::push_( context * ctx, priority_props & props, std::size_t level) noexcept {
+    props.level_ = level;
+    ctx->ready_link( rqueues_[level]);
+    bitmap_ |= std::uint32_t{ 1 } << level;
+}
+
+void
+priority::awakened( context * ctx, priority_props & props) noexcept {
+    BOOST_ASSERT( nullptr != ctx);
+    BOOST_ASSERT( ! ctx->ready_is_linked() );
+    BOOST_ASSERT( ctx->is_resumable() );
+    std::size_t level = static_cast< std::size_t >( props.get_priority() );
+    if ( ctx->is_context( type::dispatcher_context) ) {
+        // the dispatcher-context runs once per round of the fibers with the
+        // highest priority (including the fiber that is resumed right now),
+        // otherwise those fibers would starve sleeping and remote-ready fibers
+        level = 0 != bitmap_ ? highest_level_() : 0;
+        // no active fiber while the thread is initialized; properties are
+        // not yet assigned if the active fiber has not passed awakened()
+        context * active_ctx = context::active();
+        priority_props * active_props = nullptr != active_ctx
+            ? dynamic_cast< priority_props * >( active_ctx->get_properties() )
+            : nullptr;
+        if ( nullptr != active_props) {
+            std::size_t active_level = static_cast< std::size_t >( active_props->get_priority() );
+            if ( level < active_level) {
+                level = active_level;
+            }
+        }
+    }
+    push_( ctx, props, level);
+}
+
+context *
+priority::pick_next() noexcept {
+    if ( 0 == bitmap_) {
+        return nullptr;
+    }
+    std::size_t level = highest_level_();
+    rqueue_type & rqueue = rqueues_[level];
+    context * victim = & rqueue.front();
+    rqueue.pop_front();
+    if ( rqueue.empty() ) {
+        bitmap_ &= ~( std::uint32_t{ 1 } << level);
+    }
+    boost::context::detail::prefetch_range( victim, sizeof( context) );
+    BOOST_ASSERT( ! victim->ready_is_linked() );
+    BOOST_ASSERT( victim->is_resumable() );
+    return victim;
+}
+
+bool
+priority::has_ready_fibers() const noexcept {
+    return 0 != bitmap_;
+}
+
+std::size_t
+priority::properties_size() const noexcept {
+    // fibers launched on this thread get their properties on top of their
+    // stack instead of from new_properties()
+    return in_place_properties_size();
+}
+
+void
+priority::property_change( context * ctx, priority_props & props) noexcept {
+    // a running or blocked fiber gets its new level if it becomes ready
+    if ( ! ctx->ready_is_linked() || ctx->is_context( type::dispatcher_context) ) {
+        return;
+    }
+    std::size_t level = props.level_;
+    ctx->ready_unlink();
+    if ( rqueues_[level].empty() ) {
+        bitmap_ &= ~( std::uint32_t{ 1 } << level);
+    }
+    push_( ctx, props, static_cast< std::size_t >( props.get_priority() ) );
+}
+
+void
+priority::suspend_until( std::chrono::steady_clock::time_point const& time_point) noexcept {
+    if ( (std::chrono::steady_clock::time_point::max)() == time_point) {
+        std::unique_lock< std::mutex > lk{ mtx_ };
+        cnd_.wait( lk, [this](){ return flag_; });
+        flag_ = false;
+    } else {
+        std::unique_lock< std::mutex > lk{ mtx_ };
+        cnd_.wait_until( lk, time_point, [this](){ return flag_; });
+        flag_ = false;
+    }
+}
+
+void
+priority::notify() noexcept {
+    std::unique_lock< std::mutex > lk{ mtx_ };
+    flag_ = true;
+    lk.unlock();
+    cnd_.notify_all();
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
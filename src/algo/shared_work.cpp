@@ -22,11 +22,14 @@ namespace algo {
 void
 shared_work::awakened( context * ctx) noexcept {
     if ( ctx->is_context( type::pinned_context) ) { /*<
-            recognize when we're passed this thread's main fiber (or an
-            implicit library helper fiber): never put those on the shared
-            queue
+            recognize when we're passed this thread's main fiber or an
+            implicit library helper fiber: never put those on the shared queue
         >*/
         lqueue_.push_back( * ctx);
+    } else if ( ctx->is_pinned() ) { /*<
+            a worker fiber bound to this thread is kept local as well
+        >*/
+        pinned_.push_back( * ctx);
     } else {
         ctx->detach();
         std::unique_lock< std::mutex > lk{ rqueue_mtx_ }; /*<
@@ -37,10 +40,41 @@ shared_work::awakened( context * ctx) noexcept {
 }
 //]
 
+void
+shared_work::awakened_n( context ** ctxs, std::size_t n) noexcept {
+    std::size_t shared = 0;
+    for ( std::size_t i = 0; i < n; ++i) {
+        if ( ctxs[i]->is_pinned() ) {
+            awakened( ctxs[i]);
+        } else {
+            ctxs[i]->detach();
+            ++shared;
+        }
+    }
+    if ( 0 < shared) {
+        // enqueue all worker fibers under one lock
+        std::unique_lock< std::mutex > lk{ rqueue_mtx_ };
+        for ( std::size_t i = 0; i < n; ++i) {
+            if ( ! ctxs[i]->is_pinned() ) {
+                rqueue_.push_back( ctxs[i]);
+            }
+        }
+    }
+}
+
 //[pick_next_ws
 context *
 shared_work::pick_next() noexcept {
     context * ctx = nullptr;
+    pinned_turn_ = ! pinned_turn_;
+    if ( pinned_turn_ && ! pinned_.empty() ) { /*<
+            fibers bound to this thread and the shared queue take turns,
+            neither starves the other
+        >*/
+        ctx = & pinned_.front();
+        pinned_.pop_front();
+        return ctx;
+    }
     std::unique_lock< std::mutex > lk{ rqueue_mtx_ };
     if ( ! rqueue_.empty() ) { /*<
             pop an item from the ready queue
@@ -55,8 +89,11 @@ shared_work::pick_next() noexcept {
         >*/
     } else {
         lk.unlock();
-        if ( ! lqueue_.empty() ) { /*<
-                nothing in the ready queue, return main or dispatcher fiber
+        if ( ! pinned_.empty() ) {
+            ctx = & pinned_.front();
+            pinned_.pop_front();
+        } else if ( ! lqueue_.empty() ) { /*<
+                nothing else is ready, return main or dispatcher fiber
             >*/
             ctx = & lqueue_.front();
             lqueue_.pop_front();
@@ -0,0 +1,71 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/algo/uring_round_robin.hpp"
+
+#include <boost/assert.hpp>
+#include <boost/context/detail/prefetch.hpp>
+
+#include "boost/fiber/type.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace algo {
+
+uring_round_robin::uring_round_robin( unsigned entries) :
+        reactor_{ entries } {
+}
+
+void
+uring_round_robin::awakened( context * ctx) noexcept {
+    BOOST_ASSERT( nullptr != ctx);
+    BOOST_ASSERT( ! ctx->ready_is_linked() );
+    BOOST_ASSERT( ctx->is_resumable() );
+    ctx->ready_link( rqueue_);
+}
+
+context *
+uring_round_robin::pick_next() noexcept {
+    // called by the dispatcher-context once per round: submit the entries
+    // prepared by the fibers and reap completions without blocking
+    if ( reactor_.busy() && context::active()->is_context( type::dispatcher_context) ) {
+        reactor_.poll();
+    }
+    context * victim = nullptr;
+    if ( ! rqueue_.empty() ) {
+        victim = & rqueue_.front();
+        rqueue_.pop_front();
+        boost::context::detail::prefetch_range( victim, sizeof( context) );
+        BOOST_ASSERT( nullptr != victim);
+        BOOST_ASSERT( ! victim->ready_is_linked() );
+        BOOST_ASSERT( victim->is_resumable() );
+    }
+    return victim;
+}
+
+bool
+uring_round_robin::has_ready_fibers() const noexcept {
+    return ! rqueue_.empty();
+}
+
+void
+uring_round_robin::suspend_until( std::chrono::steady_clock::time_point const& time_point) noexcept {
+    reactor_.run_until( time_point);
+}
+
+void
+uring_round_robin::notify() noexcept {
+    reactor_.notify();
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
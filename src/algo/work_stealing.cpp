@@ -7,12 +7,9 @@
 
 #include "boost/fiber/algo/work_stealing.hpp"
 
-#include <random>
-
 #include <boost/assert.hpp>
 #include <boost/context/detail/prefetch.hpp>
 
-#include "boost/fiber/detail/thread_barrier.hpp"
 #include "boost/fiber/type.hpp"
 
 #ifdef BOOST_HAS_ABI_HEADERS
@@ -23,94 +20,147 @@ namespace boost {
 namespace fibers {
 namespace algo {
 
-std::atomic< std::uint32_t > work_stealing::counter_{ 0 };
-std::vector< intrusive_ptr< work_stealing > > work_stealing::schedulers_{};
+constexpr std::size_t work_stealing::steal_batch_size;
 
-void
-work_stealing::init_( std::uint32_t thread_count,
-                      std::vector< intrusive_ptr< work_stealing > > & schedulers) {
-    // resize array of schedulers to thread_count, initilized with nullptr
-    std::vector< intrusive_ptr< work_stealing > >{ thread_count, nullptr }.swap( schedulers);
+work_stealing_pool::work_stealing_pool( std::uint32_t thread_count) :
+        thread_count_{ thread_count },
+        registry_{ thread_count, thread_count } {
+}
+
+std::shared_ptr< work_stealing_pool > const&
+work_stealing::default_pool_( std::uint32_t thread_count) {
+    static std::shared_ptr< work_stealing_pool > pool{
+        std::make_shared< work_stealing_pool >( thread_count) };
+    return pool;
 }
 
 work_stealing::work_stealing( std::uint32_t thread_count, bool suspend) :
-        id_{ counter_++ },
-        thread_count_{ thread_count },
-        suspend_{ suspend } {
-    static boost::fibers::detail::thread_barrier b{ thread_count };
-    // initialize the array of schedulers
-    static std::once_flag flag;
-    std::call_once( flag, & work_stealing::init_, thread_count_, std::ref( schedulers_) );
+        work_stealing{ default_pool_( thread_count), suspend } {
+}
+
+work_stealing::work_stealing( std::shared_ptr< work_stealing_pool > pool, bool suspend) :
+        pool_{ std::move( pool) },
+        thread_count_{ pool_->thread_count_ },
+        peer_{ pool_->registry_, pool_->counter_++, suspend } {
     // register pointer of this scheduler
-    schedulers_[id_] = this;
-    b.wait();
+    pool_->registry_.join( peer_.id(), this);
+    // wait till all threads of the pool have joined
+    pool_->registry_.wait();
+}
+
+work_stealing::~work_stealing() {
+    leave_();
+}
+
+void
+work_stealing::leave_() noexcept {
+    if ( joined_) {
+        joined_ = false;
+        pool_->registry_.leave( peer_.id() );
+    }
+}
+
+context *
+work_stealing::pop_pinned_() noexcept {
+    if ( pinned_.empty() ) {
+        return nullptr;
+    }
+    context * ctx = & pinned_.front();
+    pinned_.pop_front();
+    return ctx;
 }
 
 void
 work_stealing::awakened( context * ctx) noexcept {
-    if ( ! ctx->is_context( type::pinned_context) ) {
+    if ( ! ctx->is_pinned() ) {
         ctx->detach();
+        rqueue_.push( ctx);
+        peer_.pushed();
+    } else {
+        ctx->ready_link( pinned_);
+    }
+}
+
+void
+work_stealing::awakened_n( context ** ctxs, std::size_t n) noexcept {
+    // the stealable contexts are moved to the front of `ctxs`
+    std::size_t stealable = 0;
+    for ( std::size_t i = 0; i < n; ++i) {
+        if ( ! ctxs[i]->is_pinned() ) {
+            ctxs[i]->detach();
+            ctxs[stealable++] = ctxs[i];
+        } else {
+            ctxs[i]->ready_link( pinned_);
+        }
+    }
+    if ( 0 < stealable) {
+        rqueue_.push_n( ctxs, stealable);
+        peer_.pushed();
     }
-    rqueue_.push( ctx);
 }
 
 context *
 work_stealing::pick_next() noexcept {
-    context * victim = rqueue_.pop();
-    if ( nullptr != victim) {
-        boost::context::detail::prefetch_range( victim, sizeof( context) );
-        if ( ! victim->is_context( type::pinned_context) ) {
+    context * victim = nullptr;
+    pinned_turn_ = ! pinned_turn_;
+    if ( pinned_turn_) {
+        victim = pop_pinned_();
+    }
+    if ( nullptr == victim) {
+        victim = rqueue_.pop();
+        if ( nullptr != victim) {
+            BOOST_ASSERT( ! victim->is_pinned() );
             context::active()->attach( victim);
+        } else if ( ! pinned_turn_) {
+            victim = pop_pinned_();
         }
+    }
+    if ( nullptr != victim) {
+        boost::context::detail::prefetch_range( victim, sizeof( context) );
     } else {
-        std::uint32_t id = 0;
-        std::size_t count = 0, size = schedulers_.size();
-        static thread_local std::minstd_rand generator{ std::random_device{}() };
-        std::uniform_int_distribution< std::uint32_t > distribution{
-            0, static_cast< std::uint32_t >( thread_count_ - 1) };
-        do {
-            do {
-                ++count;
-                // random selection of one logical cpu
-                // that belongs to the local NUMA node
-                id = distribution( generator);
-                // prevent stealing from own scheduler
-            } while ( id == id_);
-            // steal context from other scheduler
-            victim = schedulers_[id]->steal();
-        } while ( nullptr == victim && count < size);
-        if ( nullptr != victim) {
+        std::size_t count = 0;
+        context * batch[steal_batch_size];
+        std::size_t n = peer_.steal_from_last_victim( batch, count);
+        if ( 0 == n) {
+            // random selection of one peer
+            n = peer_.steal_from_random(
+                    thread_count_,
+                    []( std::size_t i){ return static_cast< std::uint32_t >( i); },
+                    batch, count);
+        }
+#if defined(BOOST_FIBERS_USE_STATISTICS)
+        detail::statistics_counters & stats = context::active()->get_scheduler()->counters();
+        stats.steals_attempted.add( count);
+        if ( 0 < n) {
+            stats.steals_succeeded.add();
+        }
+#endif
+        if ( 0 < n) {
+            victim = batch[0];
+            // the other stolen contexts get attached if they are picked
+            // from the local ready-queue
+            for ( std::size_t i = 1; i < n; ++i) {
+                rqueue_.push( batch[i]);
+            }
             boost::context::detail::prefetch_range( victim, sizeof( context) );
-            BOOST_ASSERT( ! victim->is_context( type::pinned_context) );
+            BOOST_ASSERT( ! victim->is_pinned() );
             context::active()->attach( victim);
         }
     }
+    if ( nullptr != victim && ! victim->is_pinned() ) {
+        peer_.found_work( ! rqueue_.empty() );
+    }
     return victim;
 }
 
 void
 work_stealing::suspend_until( std::chrono::steady_clock::time_point const& time_point) noexcept {
-    if ( suspend_) {
-        if ( (std::chrono::steady_clock::time_point::max)() == time_point) {
-            std::unique_lock< std::mutex > lk{ mtx_ };
-            cnd_.wait( lk, [this](){ return flag_; });
-            flag_ = false;
-        } else {
-            std::unique_lock< std::mutex > lk{ mtx_ };
-            cnd_.wait_until( lk, time_point, [this](){ return flag_; });
-            flag_ = false;
-        }
-    }
+    peer_.suspend_until( time_point);
 }
 
 void
 work_stealing::notify() noexcept {
-    if ( suspend_) {
-        std::unique_lock< std::mutex > lk{ mtx_ };
-        flag_ = true;
-        lk.unlock();
-        cnd_.notify_all();
-    }
+    peer_.notify();
 }
 
 }}}
@@ -27,6 +27,26 @@ condition_variable_any::notify_all() noexcept {
     wait_queue_.notify_all();
 }
 
+void
+condition_variable_any::notify_one_and_yield() noexcept {
+    detail::spinlock_lock lk{ wait_queue_splk_ };
+    context * ctx = wait_queue_.notify_one_for_handoff();
+    lk.unlock();
+    if ( nullptr != ctx) {
+        context::active()->handoff( ctx);
+    }
+}
+
+void
+condition_variable_any::notify_all_and_yield() noexcept {
+    detail::spinlock_lock lk{ wait_queue_splk_ };
+    context * ctx = wait_queue_.notify_all_for_handoff();
+    lk.unlock();
+    if ( nullptr != ctx) {
+        context::active()->handoff( ctx);
+    }
+}
+
 }}
 
 #ifdef BOOST_HAS_ABI_HEADERS
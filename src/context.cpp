@@ -166,7 +166,7 @@ context::~context() {
         BOOST_ASSERT( nullptr == active() );
     }
     BOOST_ASSERT( wait_queue_.empty() );
-    delete properties_;
+    set_properties( nullptr);
 }
 
 context::id
@@ -270,11 +270,17 @@ context::terminate() noexcept {
     // notify all waiting fibers
     wait_queue_.notify_all();
     BOOST_ASSERT( wait_queue_.empty() );
-    // release fiber-specific-data
-    for ( fss_data_t::value_type & data : fss_data_) {
-        data.second.do_cleanup();
+    // release fiber-specific-data; a cleanup function might access
+    // fiber-specific-data too, hence the slot is reset before
+    for ( std::size_t i = 0; i < BOOST_FIBERS_FSS_INLINE_SLOTS + fss_overflow_.size(); ++i) {
+        fss_data * slot = fss_slot_( i);
+        if ( nullptr != slot->vp) {
+            fss_data data{ std::move( * slot) };
+            * slot = fss_data{};
+            data.do_cleanup();
+        }
     }
-    fss_data_.clear();
+    fss_overflow_.clear();
     // switch to another context
     return get_scheduler()->terminate( lk, this);
 }
@@ -315,6 +321,28 @@ bool context::wake(const size_t epoch) noexcept
     return true;
 }
 
+bool
+context::wake_for_handoff( const size_t epoch, context *& ctx) noexcept {
+    size_t expected = epoch;
+    if ( ! waker_epoch_.compare_exchange_strong( expected, epoch + 1, std::memory_order_acq_rel) ) {
+        // outdated waker
+        return false;
+    }
+    BOOST_ASSERT( context::active() != this);
+    if ( context::active()->get_scheduler() == get_scheduler() ) {
+        // caller resumes this context via handoff()
+        ctx = this;
+    } else {
+        get_scheduler()->schedule_from_remote( this);
+    }
+    return true;
+}
+
+void
+context::handoff( context * ctx) noexcept {
+    BOOST_ASSERT( this == active() );
+    get_scheduler()->handoff( this, ctx);
+}
 
 void
 context::schedule( context * ctx) noexcept {
@@ -339,44 +367,80 @@ context::schedule( context * ctx) noexcept {
 #endif
 }
 
+context::fss_data *
+context::fss_slot_( std::size_t index) noexcept {
+    if ( index < BOOST_FIBERS_FSS_INLINE_SLOTS) {
+        return & fss_data_[index];
+    }
+    index -= BOOST_FIBERS_FSS_INLINE_SLOTS;
+    return index < fss_overflow_.size() ? & fss_overflow_[index] : nullptr;
+}
+
 void *
-context::get_fss_data( void const * vp) const {
-    auto key = reinterpret_cast< uintptr_t >( vp);
-    auto i = fss_data_.find( key);
-    return fss_data_.end() != i ? i->second.vp : nullptr;
+context::get_fss_data( detail::fss_key const& key) const noexcept {
+    fss_data const* slot = const_cast< context * >( this)->fss_slot_( key.index() );
+    // values stored for a destroyed key are not visible
+    return nullptr != slot && key.generation() == slot->generation ? slot->vp : nullptr;
 }
 
 void
-context::set_fss_data( void const * vp,
+context::set_fss_data( detail::fss_key const& key,
                        detail::fss_cleanup_function::ptr_t const& cleanup_fn,
                        void * data,
                        bool cleanup_existing) {
     BOOST_ASSERT( cleanup_fn);
-    auto key = reinterpret_cast< uintptr_t >( vp);
-    auto i = fss_data_.find( key);
-    if ( fss_data_.end() != i) {
-        if( cleanup_existing) {
-            i->second.do_cleanup();
+    fss_data * slot = fss_slot_( key.index() );
+    if ( nullptr == slot) {
+        if ( nullptr == data) {
+            return;
         }
-        if ( nullptr != data) {
-            i->second = fss_data{ data, cleanup_fn };
-        } else {
-            fss_data_.erase( i);
+        fss_overflow_.resize( key.index() - BOOST_FIBERS_FSS_INLINE_SLOTS + 1);
+        slot = fss_slot_( key.index() );
+    }
+    if ( nullptr != slot->vp) {
+        fss_data existing{ std::move( * slot) };
+        * slot = fss_data{};
+        // a value left behind by a destroyed key is always released
+        if ( cleanup_existing || key.generation() != existing.generation) {
+            existing.do_cleanup();
+            // the cleanup function might have grown the overflow slots
+            slot = fss_slot_( key.index() );
         }
-    } else {
-        fss_data_.insert(
-            std::make_pair(
-                key,
-                fss_data{ data, cleanup_fn } ) );
+    }
+    if ( nullptr != data) {
+        BOOST_ASSERT( nullptr != slot);
+        * slot = fss_data{ data, cleanup_fn, key.generation() };
     }
 }
 
 void
 context::set_properties( fiber_properties * props) noexcept {
-    delete properties_;
+    if ( properties_in_place_) {
+        // storage is part of the fiber's stack
+        properties_->~fiber_properties();
+        properties_in_place_ = false;
+    } else {
+        delete properties_;
+    }
     properties_ = props;
 }
 
+//static
+std::size_t
+context::properties_size() noexcept {
+    algo::algorithm_with_properties_base * algo = active()->get_scheduler()->get_properties_algo();
+    return nullptr != algo ? algo->properties_size() : 0;
+}
+
+void
+context::construct_properties( void * storage) {
+    BOOST_ASSERT( nullptr == properties_);
+    algo::algorithm_with_properties_base * algo = active()->get_scheduler()->get_properties_algo();
+    BOOST_ASSERT( nullptr != algo);
+    properties_ = algo->construct_properties( this, storage);
+    properties_in_place_ = true;
+}
+
 bool
 context::worker_is_linked() const noexcept {
     return worker_hook_.is_linked();
@@ -394,7 +458,7 @@ context::remote_ready_is_linked() const noexcept {
 
 bool
 context::sleep_is_linked() const noexcept {
-    return sleep_hook_.is_linked();
+    return sleep_hook_.is_linked() || timer_hook_.is_linked();
 }
 
 bool
@@ -417,7 +481,12 @@ context::ready_unlink() noexcept {
 void
 context::sleep_unlink() noexcept {
     BOOST_ASSERT( sleep_is_linked() );
-    sleep_hook_.unlink();
+    if ( timer_hook_.is_linked() ) {
+        // context waits in the timer-wheel
+        timer_hook_.unlink();
+    } else {
+        sleep_hook_.unlink();
+    }
 }
 
 void
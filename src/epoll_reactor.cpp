@@ -0,0 +1,260 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/detail/epoll_reactor.hpp"
+
+#include <cerrno>
+#include <cstdint>
+#include <system_error>
+
+extern "C" {
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+}
+
+#include <boost/assert.hpp>
+
+#include "boost/fiber/context.hpp"
+#include "boost/fiber/detail/spinlock.hpp"
+#include "boost/fiber/exceptions.hpp"
+#include "boost/fiber/waker.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+namespace {
+
+thread_local epoll_reactor * current_reactor{ nullptr };
+
+constexpr std::uint32_t readable_events = EPOLLIN | EPOLLPRI | EPOLLRDHUP | EPOLLHUP | EPOLLERR;
+constexpr std::uint32_t writable_events = EPOLLOUT | EPOLLHUP | EPOLLERR;
+
+}
+
+epoll_reactor *
+epoll_reactor::current() noexcept {
+    return current_reactor;
+}
+
+epoll_reactor::epoll_reactor() :
+        epfd_{ ::epoll_create1( EPOLL_CLOEXEC) },
+        efd_{ -1 } {
+    if ( BOOST_UNLIKELY( -1 == epfd_) ) {
+        throw fiber_error{ std::error_code{ errno, std::system_category() },
+                           "boost fiber: epoll_create1() failed" };
+    }
+    efd_ = ::eventfd( 0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if ( BOOST_UNLIKELY( -1 == efd_) ) {
+        int err = errno;
+        ::close( epfd_);
+        throw fiber_error{ std::error_code{ err, std::system_category() },
+                           "boost fiber: eventfd() failed" };
+    }
+    ::epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = efd_;
+    if ( BOOST_UNLIKELY( 0 != ::epoll_ctl( epfd_, EPOLL_CTL_ADD, efd_, & ev) ) ) {
+        int err = errno;
+        ::close( efd_);
+        ::close( epfd_);
+        throw fiber_error{ std::error_code{ err, std::system_category() },
+                           "boost fiber: epoll_ctl() failed" };
+    }
+    current_reactor = this;
+}
+
+epoll_reactor::~epoll_reactor() {
+    BOOST_ASSERT( 0 == waiting_);
+    // the algorithm might be released by another thread (work_stealing)
+    if ( this == current_reactor) {
+        current_reactor = nullptr;
+    }
+    ::close( efd_);
+    ::close( epfd_);
+}
+
+bool
+epoll_reactor::arm_( int fd, descriptor & d) noexcept {
+    ::epoll_event ev{};
+    ev.events = EPOLLONESHOT;
+    if ( nullptr != d.reader) {
+        ev.events |= EPOLLIN | EPOLLPRI | EPOLLRDHUP;
+    }
+    if ( nullptr != d.writer) {
+        ev.events |= EPOLLOUT;
+    }
+    ev.data.fd = fd;
+    // the kernel drops the registration if the descriptor gets closed
+    if ( d.registered && 0 == ::epoll_ctl( epfd_, EPOLL_CTL_MOD, fd, & ev) ) {
+        return true;
+    }
+    if ( 0 == ::epoll_ctl( epfd_, EPOLL_CTL_ADD, fd, & ev) ||
+         ( EEXIST == errno && 0 == ::epoll_ctl( epfd_, EPOLL_CTL_MOD, fd, & ev) ) ) {
+        d.registered = true;
+        return true;
+    }
+    d.registered = false;
+    return false;
+}
+
+void
+epoll_reactor::poll( int timeout_ms) noexcept {
+    constexpr int max_events = 64;
+    ::epoll_event events[max_events];
+    int n = ::epoll_wait( epfd_, events, max_events, timeout_ms);
+    for ( int i = 0; i < n; ++i) {
+        int fd = events[i].data.fd;
+        if ( efd_ == fd) {
+            // reset the flag before draining the eventfd, a concurrent
+            // notify() writes again; acquire makes the remote-ready contexts
+            // of a notify() that has found the flag set visible
+            notified_.exchange( false, std::memory_order_acq_rel);
+            std::uint64_t value;
+            while ( -1 == ::read( efd_, & value, sizeof( value) ) && EINTR == errno);
+            continue;
+        }
+        auto i_d = descriptors_.find( fd);
+        if ( descriptors_.end() == i_d) {
+            continue;
+        }
+        descriptor & d = i_d->second;
+        std::uint32_t revents = events[i].events;
+        if ( nullptr != d.reader && 0 != ( revents & readable_events) ) {
+            waker * w = d.reader;
+            d.reader = nullptr;
+            --waiting_;
+            w->wake();
+        }
+        if ( nullptr != d.writer && 0 != ( revents & writable_events) ) {
+            waker * w = d.writer;
+            d.writer = nullptr;
+            --waiting_;
+            w->wake();
+        }
+        // EPOLLONESHOT has disarmed the descriptor
+        if ( ( nullptr != d.reader || nullptr != d.writer) && ! arm_( fd, d) ) {
+            // report the descriptor as ready, the fiber will see the error
+            if ( nullptr != d.reader) {
+                d.reader->wake();
+                d.reader = nullptr;
+                --waiting_;
+            }
+            if ( nullptr != d.writer) {
+                d.writer->wake();
+                d.writer = nullptr;
+                --waiting_;
+            }
+        }
+    }
+}
+
+void
+epoll_reactor::run_until( std::chrono::steady_clock::time_point const& time_point) noexcept {
+    int timeout_ms = -1;
+    if ( (std::chrono::steady_clock::time_point::max)() != time_point) {
+        std::chrono::steady_clock::duration d = time_point - std::chrono::steady_clock::now();
+        if ( d <= std::chrono::steady_clock::duration::zero() ) {
+            timeout_ms = 0;
+        } else {
+            // round up, epoll_wait() must not return before the deadline
+            auto ms = std::chrono::duration_cast< std::chrono::milliseconds >(
+                    d + std::chrono::milliseconds{ 1 } - std::chrono::steady_clock::duration{ 1 } ).count();
+            timeout_ms = ms < 0x7fffffff ? static_cast< int >( ms) : 0x7fffffff;
+        }
+    }
+    poll( timeout_ms);
+}
+
+void
+epoll_reactor::notify() noexcept {
+    // at most one pending wakeup, spares the write() if the reactor has not
+    // consumed the last one
+    if ( ! notified_.exchange( true, std::memory_order_acq_rel) ) {
+        std::uint64_t value = 1;
+        while ( -1 == ::write( efd_, & value, sizeof( value) ) && EINTR == errno);
+    }
+}
+
+bool
+epoll_reactor::wait( int fd, bool writable, std::chrono::steady_clock::time_point const& timeout_time) {
+    context * active_ctx = context::active();
+    descriptor & d = descriptors_[fd];
+    waker * & slot = writable ? d.writer : d.reader;
+    if ( BOOST_UNLIKELY( nullptr != slot) ) {
+        throw fiber_error{ std::make_error_code( std::errc::device_or_resource_busy),
+                           "boost fiber: another fiber waits for this file descriptor" };
+    }
+    detail::spinlock splk;
+    detail::spinlock_lock lk{ splk };
+    waker w = active_ctx->create_waker();
+    slot = & w;
+    if ( BOOST_UNLIKELY( ! arm_( fd, d) ) ) {
+        int err = errno;
+        slot = nullptr;
+        throw fiber_error{ std::error_code{ err, std::system_category() },
+                           "boost fiber: epoll_ctl() failed" };
+    }
+    ++waiting_;
+    // the reactor belongs to this thread: the fiber must not be stolen
+    // (epoll_work_stealing) before it has left the descriptor table
+    bool affinity = active_ctx->thread_affinity();
+    active_ctx->thread_affinity( true);
+    if ( (std::chrono::steady_clock::time_point::max)() == timeout_time) {
+        active_ctx->suspend( lk);
+    } else {
+        active_ctx->wait_until( timeout_time, lk, waker{ w });
+    }
+    // poll() clears the slot before it wakes the fiber; forget() does not
+    // erase an entry while a fiber waits, `slot` is still valid
+    bool ready = & w != slot;
+    if ( ! ready) {
+        // timeout, the registration is still armed for the events of this
+        // fiber: re-arm it for the remaining waiter or with an empty mask
+        // (EPOLLHUP/EPOLLERR are reported anyway, poll() ignores them if
+        // nobody waits)
+        slot = nullptr;
+        --waiting_;
+        if ( ! arm_( fd, d) ) {
+            // the descriptor has been closed, report it as ready
+            waker * & other = writable ? d.reader : d.writer;
+            if ( nullptr != other) {
+                other->wake();
+                other = nullptr;
+                --waiting_;
+            }
+        }
+    }
+    active_ctx->thread_affinity( affinity);
+    return ready;
+}
+
+void
+epoll_reactor::forget( int fd) {
+    auto i_d = descriptors_.find( fd);
+    if ( descriptors_.end() == i_d) {
+        return;
+    }
+    if ( BOOST_UNLIKELY( nullptr != i_d->second.reader || nullptr != i_d->second.writer) ) {
+        throw fiber_error{ std::make_error_code( std::errc::device_or_resource_busy),
+                           "boost fiber: a fiber waits for this file descriptor" };
+    }
+    if ( i_d->second.registered) {
+        // fails if the descriptor has already been closed
+        ::epoll_ctl( epfd_, EPOLL_CTL_DEL, fd, nullptr);
+    }
+    descriptors_.erase( i_d);
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -0,0 +1,66 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/detail/fss.hpp"
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+namespace {
+
+struct fss_registry {
+    std::mutex                  mtx{};
+    // current generation of each slot; 0 marks an unused slot in a context
+    std::vector< std::size_t >  generations{};
+    std::vector< std::size_t >  free_slots{};
+};
+
+fss_registry & registry() {
+    // constructed by the first fss_key, hence destroyed after the last
+    // fiber_specific_ptr with static storage duration
+    static fss_registry r;
+    return r;
+}
+
+}
+
+fss_key::fss_key() {
+    fss_registry & r = registry();
+    std::unique_lock< std::mutex > lk{ r.mtx };
+    if ( r.free_slots.empty() ) {
+        index_ = r.generations.size();
+        // every slot might be freed, ~fss_key() must not allocate
+        r.free_slots.reserve( index_ + 1);
+        r.generations.push_back( 1);
+    } else {
+        index_ = r.free_slots.back();
+        r.free_slots.pop_back();
+    }
+    generation_ = r.generations[index_];
+}
+
+fss_key::~fss_key() {
+    fss_registry & r = registry();
+    std::unique_lock< std::mutex > lk{ r.mtx };
+    // values still stored for this key become stale
+    ++r.generations[index_];
+    // capacity reserved by fss_key(), does not throw
+    r.free_slots.push_back( index_);
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -0,0 +1,314 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/huge_page_stack.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include <boost/assert.hpp>
+#include <boost/core/ignore_unused.hpp>
+
+#if defined(BOOST_WINDOWS)
+# include <windows.h>
+#else
+# include <sys/mman.h>
+# include <unistd.h>
+#endif
+
+#if defined(BOOST_USE_VALGRIND)
+# include <valgrind/valgrind.h>
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+constexpr std::size_t huge_page_stack::huge_page_size;
+
+namespace {
+
+std::size_t page_size() noexcept {
+    return boost::context::stack_traits::page_size();
+}
+
+std::size_t round_up( std::size_t size, std::size_t alignment) noexcept {
+    return ( size + alignment - 1) / alignment * alignment;
+}
+
+enum class arena_kind {
+    normal,
+    transparent,
+    hugetlbfs
+};
+
+struct arena {
+    // lowest address of the first stack, the guard page lies below
+    char        *   first;
+    std::size_t     guard;
+    arena_kind      kind;
+};
+
+#if ! defined(BOOST_WINDOWS)
+void * map_anonymous( void * hint, std::size_t size, int prot, int flags) noexcept {
+# if defined(MAP_ANON)
+    return ::mmap( hint, size, prot, MAP_PRIVATE | MAP_ANON | flags, -1, 0);
+# else
+    return ::mmap( hint, size, prot, MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+# endif
+}
+#endif
+
+// hugetlbfs mappings are aligned to the huge page size by the kernel; the
+// guard page is mapped below the arena only if the address is still free
+bool map_hugetlbfs( std::size_t size, std::size_t guard, arena & a) noexcept {
+#if defined(MAP_HUGETLB)
+    int flags = MAP_HUGETLB;
+# if defined(MAP_HUGE_SHIFT)
+    // 2 MiB pages, even if the default huge page size differs
+    flags |= 21 << MAP_HUGE_SHIFT;
+# endif
+    void * vp = map_anonymous( nullptr, size, PROT_READ | PROT_WRITE, flags);
+    if ( MAP_FAILED == vp) {
+        // no huge pages reserved (vm.nr_hugepages)
+        return false;
+    }
+    a.first = static_cast< char * >( vp);
+    a.guard = 0;
+    a.kind = arena_kind::hugetlbfs;
+    if ( 0 < guard) {
+        void * hint = a.first - guard;
+# if defined(MAP_FIXED_NOREPLACE)
+        void * gp = map_anonymous( hint, guard, PROT_NONE, MAP_FIXED_NOREPLACE);
+# else
+        void * gp = map_anonymous( hint, guard, PROT_NONE, 0);
+# endif
+        if ( hint == gp) {
+            a.guard = guard;
+        } else if ( MAP_FAILED != gp) {
+            // kernels older than 4.17 take MAP_FIXED_NOREPLACE as a hint
+            ::munmap( gp, guard);
+        }
+    }
+    return true;
+#else
+    boost::ignore_unused( size, guard, a);
+    return false;
+#endif
+}
+
+// reserves an address range large enough to align the arena to a huge page
+// boundary and commits the aligned part; the guard page stays inaccessible
+arena map_arena( std::size_t size, std::size_t guard, huge_page_backing backing) {
+    arena a{ nullptr, 0, arena_kind::normal };
+#if defined(BOOST_WINDOWS)
+    // large pages require SeLockMemoryPrivilege, normal pages are used
+    boost::ignore_unused( backing);
+    void * vp = ::VirtualAlloc( nullptr, size + guard, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    if ( nullptr == vp) {
+        throw std::bad_alloc{};
+    }
+    if ( 0 < guard) {
+        DWORD old_options;
+        ::VirtualProtect( vp, guard, PAGE_NOACCESS, & old_options);
+    }
+    a.first = static_cast< char * >( vp) + guard;
+    a.guard = guard;
+#else
+    if ( huge_page_backing::hugetlbfs == backing && map_hugetlbfs( size, guard, a) ) {
+        return a;
+    }
+    std::size_t reserved = size + guard + huge_page_stack::huge_page_size;
+# if defined(MAP_NORESERVE)
+    void * vp = map_anonymous( nullptr, reserved, PROT_NONE, MAP_NORESERVE);
+# else
+    void * vp = map_anonymous( nullptr, reserved, PROT_NONE, 0);
+# endif
+    if ( MAP_FAILED == vp) {
+        throw std::bad_alloc{};
+    }
+    char * base = static_cast< char * >( vp);
+    char * first = reinterpret_cast< char * >( round_up(
+                reinterpret_cast< std::uintptr_t >( base + guard), huge_page_stack::huge_page_size) );
+    // release the unused head and tail of the reservation
+    if ( base < first - guard) {
+        ::munmap( base, static_cast< std::size_t >( first - guard - base) );
+    }
+    if ( first + size < base + reserved) {
+        ::munmap( first + size, static_cast< std::size_t >( base + reserved - ( first + size) ) );
+    }
+    if ( 0 != ::mprotect( first, size, PROT_READ | PROT_WRITE) ) {
+        ::munmap( first - guard, size + guard);
+        throw std::bad_alloc{};
+    }
+    a.first = first;
+    a.guard = guard;
+# if defined(MADV_HUGEPAGE)
+    // fails if the kernel was built without transparent huge pages
+    if ( 0 == ::madvise( first, size, MADV_HUGEPAGE) ) {
+        a.kind = arena_kind::transparent;
+    }
+# endif
+#endif
+    return a;
+}
+
+void unmap_arena( arena const& a, std::size_t size) noexcept {
+#if defined(BOOST_WINDOWS)
+    ::VirtualFree( a.first - a.guard, 0, MEM_RELEASE);
+#else
+    ::munmap( a.first - a.guard, size + a.guard);
+#endif
+}
+
+}
+
+class huge_page_stack::pool {
+private:
+    std::mutex                      mtx_{};
+    std::vector< arena >            arenas_{};
+    // lowest addresses of the free stacks, the most recently released at the end
+    std::vector< void * >           free_{};
+
+public:
+    std::size_t const               stack_size;
+    std::size_t const               arena_size;
+    std::size_t const               stacks_per_arena;
+    std::size_t const               guard;
+    huge_page_backing const         backing;
+
+    std::atomic< std::size_t >      arena_count{ 0 };
+    std::atomic< std::size_t >      hugetlbfs_arenas{ 0 };
+    std::atomic< std::size_t >      transparent_arenas{ 0 };
+    std::atomic< std::size_t >      used_stacks{ 0 };
+    std::atomic< std::size_t >      free_stacks{ 0 };
+
+    pool( std::size_t stack_size_, std::size_t arena_size_, std::size_t guard_,
+          huge_page_backing backing_) :
+        stack_size{ stack_size_ },
+        arena_size{ arena_size_ },
+        stacks_per_arena{ arena_size_ / stack_size_ },
+        guard{ guard_ },
+        backing{ backing_ } {
+    }
+
+    ~pool() {
+        BOOST_ASSERT( 0 == used_stacks.load( std::memory_order_relaxed) );
+        for ( arena const& a : arenas_) {
+            unmap_arena( a, arena_size);
+        }
+    }
+
+    pool( pool const&) = delete;
+    pool & operator=( pool const&) = delete;
+
+    void * take() {
+        {
+            std::unique_lock< std::mutex > lk{ mtx_ };
+            if ( ! free_.empty() ) {
+                void * vp = free_.back();
+                free_.pop_back();
+                free_stacks.fetch_sub( 1, std::memory_order_relaxed);
+                used_stacks.fetch_add( 1, std::memory_order_relaxed);
+                return vp;
+            }
+        }
+        // map outside of the lock, other threads keep taking released stacks
+        arena a = map_arena( arena_size, guard, backing);
+        std::unique_lock< std::mutex > lk{ mtx_ };
+        try {
+            // put() must not allocate
+            std::size_t stacks = ( arenas_.size() + 1) * stacks_per_arena;
+            if ( free_.capacity() < stacks) {
+                free_.reserve( (std::max)( stacks, 2 * free_.capacity() ) );
+            }
+            arenas_.reserve( arenas_.size() + 1);
+        } catch (...) {
+            unmap_arena( a, arena_size);
+            throw;
+        }
+        arenas_.push_back( a);
+        arena_count.fetch_add( 1, std::memory_order_relaxed);
+        if ( arena_kind::hugetlbfs == a.kind) {
+            hugetlbfs_arenas.fetch_add( 1, std::memory_order_relaxed);
+        } else if ( arena_kind::transparent == a.kind) {
+            transparent_arenas.fetch_add( 1, std::memory_order_relaxed);
+        }
+        // the stack at the top of the arena is handed out first
+        for ( std::size_t i = 0; i < stacks_per_arena - 1; ++i) {
+            free_.push_back( a.first + i * stack_size);
+        }
+        free_stacks.fetch_add( stacks_per_arena - 1, std::memory_order_relaxed);
+        used_stacks.fetch_add( 1, std::memory_order_relaxed);
+        return a.first + ( stacks_per_arena - 1) * stack_size;
+    }
+
+    void put( void * vp) noexcept {
+        std::unique_lock< std::mutex > lk{ mtx_ };
+        free_.push_back( vp);
+        free_stacks.fetch_add( 1, std::memory_order_relaxed);
+        used_stacks.fetch_sub( 1, std::memory_order_relaxed);
+    }
+};
+
+huge_page_stack::huge_page_stack( std::size_t stack_size,
+                                  std::size_t arena_size,
+                                  huge_page_backing backing,
+                                  bool guard_page) {
+    BOOST_ASSERT( traits_type::minimum_size() <= stack_size);
+    BOOST_ASSERT( traits_type::is_unbounded() || ( traits_type::maximum_size() >= stack_size) );
+    // whole pages, whole huge pages
+    stack_size = round_up( stack_size, page_size() );
+    arena_size = round_up( (std::max)( arena_size, stack_size), huge_page_size);
+    pool_ = std::make_shared< pool >( stack_size, arena_size, guard_page ? page_size() : 0, backing);
+}
+
+boost::context::stack_context
+huge_page_stack::allocate() {
+    void * vp = pool_->take();
+    boost::context::stack_context sctx;
+    sctx.size = pool_->stack_size;
+    sctx.sp = static_cast< char * >( vp) + sctx.size;
+#if defined(BOOST_USE_VALGRIND)
+    sctx.valgrind_stack_id = VALGRIND_STACK_REGISTER( sctx.sp, vp);
+#endif
+    return sctx;
+}
+
+void
+huge_page_stack::deallocate( boost::context::stack_context & sctx) noexcept {
+    BOOST_ASSERT( sctx.sp);
+    BOOST_ASSERT( pool_->stack_size == sctx.size);
+#if defined(BOOST_USE_VALGRIND)
+    VALGRIND_STACK_DEREGISTER( sctx.valgrind_stack_id);
+#endif
+    pool_->put( static_cast< char * >( sctx.sp) - sctx.size);
+}
+
+huge_page_stack_statistics
+huge_page_stack::statistics() const noexcept {
+    huge_page_stack_statistics s;
+    s.stack_size = pool_->stack_size;
+    s.arena_size = pool_->arena_size;
+    s.arenas = pool_->arena_count.load( std::memory_order_relaxed);
+    s.hugetlbfs_arenas = pool_->hugetlbfs_arenas.load( std::memory_order_relaxed);
+    s.transparent_arenas = pool_->transparent_arenas.load( std::memory_order_relaxed);
+    s.used_stacks = pool_->used_stacks.load( std::memory_order_relaxed);
+    s.free_stacks = pool_->free_stacks.load( std::memory_order_relaxed);
+    return s;
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -7,13 +7,12 @@
 
 #include "boost/fiber/numa/algo/work_stealing.hpp"
 
+#include <algorithm>
 #include <cmath>
-#include <random>
 
 #include <boost/assert.hpp>
 #include <boost/context/detail/prefetch.hpp>
 
-#include "boost/fiber/detail/thread_barrier.hpp"
 #include "boost/fiber/type.hpp"
 
 #ifdef BOOST_HAS_ABI_HEADERS
@@ -25,7 +24,7 @@ namespace fibers {
 namespace numa {
 namespace algo {
 
-std::vector< intrusive_ptr< work_stealing > > work_stealing::schedulers_{};
+constexpr std::size_t work_stealing::steal_batch_size;
 
 std::vector< std::uint32_t > get_local_cpus( std::uint32_t node_id, std::vector< boost::fibers::numa::node > const& topo) {
     for ( auto & node : topo) {
@@ -49,18 +48,39 @@ std::vector< std::uint32_t > get_remote_cpus( std::uint32_t node_id, std::vector
     return remote_cpus;
 }
 
-void
-work_stealing::init_( std::vector< boost::fibers::numa::node > const& topo,
-                      std::vector< intrusive_ptr< work_stealing > > & schedulers) {
+namespace {
+
+std::uint32_t max_cpu_id( std::vector< boost::fibers::numa::node > const& topo) {
     std::uint32_t max_cpu_id = 0;
     for ( auto & node : topo) {
         max_cpu_id = (std::max)( max_cpu_id, * node.logical_cpus.rbegin() );
     }
-    // resize array of schedulers to max. CPU ID, initilized with nullptr
-    // CPU ID acts as the index in the scheduler array
-    // if a logical cpus is offline, schedulers_ will contain a nullptr
-    // logical cpus index starts at `0` -> add 1
-    std::vector< intrusive_ptr< work_stealing > >{ max_cpu_id + 1, nullptr }.swap( schedulers);
+    return max_cpu_id;
+}
+
+std::size_t cpu_count( std::vector< boost::fibers::numa::node > const& topo) {
+    std::size_t thread_count = 0;
+    for ( auto & node : topo) {
+        thread_count += node.logical_cpus.size();
+    }
+    return thread_count;
+}
+
+}
+
+// CPU ID acts as the index in the registry
+// if a logical cpus is offline, its slot stays empty
+// logical cpus index starts at `0` -> add 1
+work_stealing_pool::work_stealing_pool( std::vector< boost::fibers::numa::node > const& topo) :
+        topology_{ topo },
+        registry_{ max_cpu_id( topo) + 1, cpu_count( topo) } {
+}
+
+std::shared_ptr< work_stealing_pool > const&
+work_stealing::default_pool_( std::vector< boost::fibers::numa::node > const& topo) {
+    static std::shared_ptr< work_stealing_pool > pool{
+        std::make_shared< work_stealing_pool >( topo) };
+    return pool;
 }
 
 work_stealing::work_stealing(
@@ -68,118 +88,157 @@ work_stealing::work_stealing(
     std::uint32_t node_id,
     std::vector< boost::fibers::numa::node > const& topo,
     bool suspend) :
-        cpu_id_{ cpu_id },
-        local_cpus_{ get_local_cpus( node_id, topo) },
-        remote_cpus_{ get_remote_cpus( node_id, topo) },
-        suspend_{ suspend } {
+        work_stealing{ default_pool_( topo), cpu_id, node_id, suspend } {
+}
+
+work_stealing::work_stealing(
+    std::shared_ptr< work_stealing_pool > pool,
+    std::uint32_t cpu_id,
+    std::uint32_t node_id,
+    bool suspend) :
+        pool_{ std::move( pool) },
+        local_cpus_{ get_local_cpus( node_id, pool_->topology_) },
+        remote_cpus_{ get_remote_cpus( node_id, pool_->topology_) },
+        peer_{ pool_->registry_, cpu_id, suspend } {
     // pin current thread to logical cpu
-    boost::fibers::numa::pin_thread( cpu_id_);
-    // calculate thread count
-    std::size_t thread_count = 0;
-    for ( auto & node : topo) {
-        thread_count += node.logical_cpus.size();
-    }
-    static boost::fibers::detail::thread_barrier b{ thread_count };
-    // initialize the array of schedulers
-    static std::once_flag flag;
-    std::call_once( flag, & work_stealing::init_, topo, std::ref( schedulers_) );
+    boost::fibers::numa::pin_thread( cpu_id);
     // register pointer of this scheduler
-    schedulers_[cpu_id_] = this;
-    b.wait();
+    pool_->registry_.join( cpu_id, this);
+    // wait till all threads of the pool have joined
+    pool_->registry_.wait();
+}
+
+work_stealing::~work_stealing() {
+    leave_();
+}
+
+void
+work_stealing::leave_() noexcept {
+    if ( joined_) {
+        joined_ = false;
+        pool_->registry_.leave( peer_.id() );
+    }
+}
+
+context *
+work_stealing::pop_pinned_() noexcept {
+    if ( pinned_.empty() ) {
+        return nullptr;
+    }
+    context * ctx = & pinned_.front();
+    pinned_.pop_front();
+    return ctx;
 }
 
 void
 work_stealing::awakened( context * ctx) noexcept {
-    if ( ! ctx->is_context( type::pinned_context) ) {
+    if ( ! ctx->is_pinned() ) {
         ctx->detach();
+        rqueue_.push( ctx);
+        peer_.pushed();
+    } else {
+        ctx->ready_link( pinned_);
+    }
+}
+
+void
+work_stealing::awakened_n( context ** ctxs, std::size_t n) noexcept {
+    // the stealable contexts are moved to the front of `ctxs`
+    std::size_t stealable = 0;
+    for ( std::size_t i = 0; i < n; ++i) {
+        if ( ! ctxs[i]->is_pinned() ) {
+            ctxs[i]->detach();
+            ctxs[stealable++] = ctxs[i];
+        } else {
+            ctxs[i]->ready_link( pinned_);
+        }
+    }
+    if ( 0 < stealable) {
+        rqueue_.push_n( ctxs, stealable);
+        peer_.pushed();
     }
-    rqueue_.push( ctx);
 }
 
 context *
 work_stealing::pick_next() noexcept {
-    context * victim = rqueue_.pop();
-    if ( nullptr != victim) {
-        boost::context::detail::prefetch_range( victim, sizeof( context) );
-        if ( ! victim->is_context( type::pinned_context) ) {
+    context * victim = nullptr;
+    pinned_turn_ = ! pinned_turn_;
+    if ( pinned_turn_) {
+        victim = pop_pinned_();
+    }
+    if ( nullptr == victim) {
+        victim = rqueue_.pop();
+        if ( nullptr != victim) {
+            BOOST_ASSERT( ! victim->is_pinned() );
             context::active()->attach( victim);
+        } else if ( ! pinned_turn_) {
+            victim = pop_pinned_();
         }
+    }
+    if ( nullptr != victim) {
+        boost::context::detail::prefetch_range( victim, sizeof( context) );
     } else {
-        std::uint32_t cpu_id = 0;
-        std::size_t count = 0, size = local_cpus_.size();
-        static thread_local std::minstd_rand generator{ std::random_device{}() };
-        std::uniform_int_distribution< std::uint32_t > local_distribution{
-            0, static_cast< std::uint32_t >( local_cpus_.size() - 1) };
-        std::uniform_int_distribution< std::uint32_t > remote_distribution{
-            0, static_cast< std::uint32_t >( remote_cpus_.size() - 1) };
-        do {
-            do {
-                ++count;
-                // random selection of one logical cpu
-                // that belongs to the local NUMA node
-                cpu_id = local_cpus_[local_distribution( generator)];
-                // prevent stealing from own scheduler
-            } while ( cpu_id == cpu_id_);
-            // steal context from other scheduler
-            // schedulers_[cpu_id] should never contain a nullptr
-            BOOST_ASSERT( nullptr != schedulers_[cpu_id]);
-            victim = schedulers_[cpu_id]->steal();
-        } while ( nullptr == victim && count < size);
-        if ( nullptr != victim) {
+        std::size_t count = 0;
+        context * batch[steal_batch_size];
+        std::size_t n = 0;
+        // a remote last victim is not preferred over the local node
+        if ( last_victim_local_) {
+            n = peer_.steal_from_last_victim( batch, count);
+        }
+        if ( 0 == n) {
+            // random selection of one logical cpu
+            // that belongs to the local NUMA node
+            n = peer_.steal_from_random(
+                    local_cpus_.size(),
+                    [this]( std::size_t i){ return local_cpus_[i]; },
+                    batch, count);
+        }
+        if ( 0 == n && ! last_victim_local_) {
+            n = peer_.steal_from_last_victim( batch, count);
+        }
+        if ( 0 == n) {
+            // random selection of one logical cpu
+            // that belongs to a remote NUMA node
+            n = peer_.steal_from_random(
+                    remote_cpus_.size(),
+                    [this]( std::size_t i){ return remote_cpus_[i]; },
+                    batch, count);
+        }
+#if defined(BOOST_FIBERS_USE_STATISTICS)
+        boost::fibers::detail::statistics_counters & stats = context::active()->get_scheduler()->counters();
+        stats.steals_attempted.add( count);
+        if ( 0 < n) {
+            stats.steals_succeeded.add();
+        }
+#endif
+        if ( 0 < n) {
+            last_victim_local_ = local_cpus_.end() != std::find(
+                local_cpus_.begin(), local_cpus_.end(), peer_.last_victim() );
+            victim = batch[0];
+            // the other stolen contexts get attached if they are picked
+            // from the local ready-queue
+            for ( std::size_t i = 1; i < n; ++i) {
+                rqueue_.push( batch[i]);
+            }
             boost::context::detail::prefetch_range( victim, sizeof( context) );
-            BOOST_ASSERT( ! victim->is_context( type::pinned_context) );
+            BOOST_ASSERT( ! victim->is_pinned() );
             context::active()->attach( victim);
-        } else if ( ! remote_cpus_.empty() ) {
-            cpu_id = 0;
-            count = 0;
-            size = remote_cpus_.size();
-            do {
-                ++count;
-                // random selection of one logical cpu
-                // that belongs to a remote NUMA node
-                cpu_id = remote_cpus_[remote_distribution( generator)];
-                // remote cpu ID should never be equal to local cpu ID
-                BOOST_ASSERT( cpu_id != cpu_id_);
-                // schedulers_[cpu_id] should never contain a nullptr
-                BOOST_ASSERT( nullptr != schedulers_[cpu_id]);
-                // steal context from other scheduler
-                victim = schedulers_[cpu_id]->steal();
-            } while ( nullptr == victim && count < size);
-            if ( nullptr != victim) {
-                boost::context::detail::prefetch_range( victim, sizeof( context) );
-                BOOST_ASSERT( ! victim->is_context( type::pinned_context) );
-                // move memory from remote NUMA-node to
-                // memory of local NUMA-node
-                context::active()->attach( victim);
-            }
         }
     }
+    if ( nullptr != victim && ! victim->is_pinned() ) {
+        peer_.found_work( ! rqueue_.empty() );
+    }
     return victim;
 }
 
 void
 work_stealing::suspend_until( std::chrono::steady_clock::time_point const& time_point) noexcept {
-    if ( suspend_) {
-        if ( (std::chrono::steady_clock::time_point::max)() == time_point) {
-            std::unique_lock< std::mutex > lk{ mtx_ };
-            cnd_.wait( lk, [this](){ return flag_; });
-            flag_ = false;
-        } else {
-            std::unique_lock< std::mutex > lk{ mtx_ };
-            cnd_.wait_until( lk, time_point, [this](){ return flag_; });
-            flag_ = false;
-        }
-    }
+    peer_.suspend_until( time_point);
 }
 
 void
 work_stealing::notify() noexcept {
-    if ( suspend_) {
-        std::unique_lock< std::mutex > lk{ mtx_ };
-        flag_ = true;
-        lk.unlock();
-        cnd_.notify_all();
-    }
+    peer_.notify();
 }
 
 }}}}
@@ -0,0 +1,429 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/numa_pooled_stack.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include <boost/assert.hpp>
+#include <boost/core/ignore_unused.hpp>
+
+#if defined(BOOST_WINDOWS)
+# include <windows.h>
+#else
+# include <sys/mman.h>
+# include <sys/resource.h>
+# include <unistd.h>
+#endif
+
+#if defined(__linux__)
+# include <linux/mempolicy.h>
+# include <sys/syscall.h>
+#endif
+
+#if defined(BOOST_USE_VALGRIND)
+# include <valgrind/valgrind.h>
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+
+namespace {
+
+std::size_t page_size() noexcept {
+    return boost::context::stack_traits::page_size();
+}
+
+void * map_stack( std::size_t size) {
+#if defined(BOOST_WINDOWS)
+    void * vp = ::VirtualAlloc( nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    if ( nullptr == vp) {
+        throw std::bad_alloc{};
+    }
+#else
+# if defined(MAP_ANON)
+    void * vp = ::mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+# else
+    void * vp = ::mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+# endif
+    if ( MAP_FAILED == vp) {
+        throw std::bad_alloc{};
+    }
+#endif
+    return vp;
+}
+
+// the lowest `size` bytes of the mapping become inaccessible, a fiber
+// overflowing its stack faults instead of overwriting the neighbouring memory
+bool protect_guard( void * vp, std::size_t size) noexcept {
+#if defined(BOOST_WINDOWS)
+    DWORD old_protect;
+    return 0 != ::VirtualProtect( vp, size, PAGE_READWRITE | PAGE_GUARD, & old_protect);
+#else
+    return 0 == ::mprotect( vp, size, PROT_NONE);
+#endif
+}
+
+void unmap_stack( void * vp, std::size_t size) noexcept {
+#if defined(BOOST_WINDOWS)
+    ::VirtualFree( vp, 0, MEM_RELEASE);
+#else
+    ::munmap( vp, size);
+#endif
+}
+
+// prefer the NUMA node of the calling thread for the pages of the stack;
+// without mbind() (or if it is not permitted) the pages are placed on the
+// node of the thread touching them first
+void bind_to_local_node( void * vp, std::size_t size) noexcept {
+#if defined(__linux__) && defined(SYS_getcpu) && defined(SYS_mbind)
+    unsigned int cpu = 0, node = 0;
+    if ( 0 != ::syscall( SYS_getcpu, & cpu, & node, nullptr) ) {
+        return;
+    }
+    constexpr std::size_t bits = 8 * sizeof( unsigned long);
+    unsigned long mask[4] = { 0, 0, 0, 0 };
+    if ( sizeof( mask) * 8 <= node + 1) {
+        return;
+    }
+    mask[node / bits] |= 1UL << ( node % bits);
+    ::syscall( SYS_mbind, vp, size, MPOL_PREFERRED, mask, sizeof( mask) * 8, 0);
+#else
+    boost::ignore_unused( vp, size);
+#endif
+}
+
+// hands the pages back to the operating system; the mapping is kept and the
+// pages are faulted in again (zeroed) when touched
+void advise_cold( void * vp, std::size_t size) noexcept {
+#if defined(BOOST_WINDOWS)
+    ::VirtualAlloc( vp, size, MEM_RESET, PAGE_READWRITE);
+#elif defined(MADV_FREE)
+    if ( 0 != ::madvise( vp, size, MADV_FREE) ) {
+        // MADV_FREE requires Linux 4.5
+        ::madvise( vp, size, MADV_DONTNEED);
+    }
+#elif defined(MADV_DONTNEED)
+    ::madvise( vp, size, MADV_DONTNEED);
+#else
+    boost::ignore_unused( vp, size);
+#endif
+}
+
+std::uint64_t thread_page_faults() noexcept {
+#if defined(RUSAGE_THREAD)
+    rusage ru;
+    if ( 0 == ::getrusage( RUSAGE_THREAD, & ru) ) {
+        return static_cast< std::uint64_t >( ru.ru_minflt + ru.ru_majflt);
+    }
+#endif
+    return 0;
+}
+
+std::atomic< std::uint64_t > next_pool_id{ 1 };
+
+}
+
+class numa_pooled_stack::pool {
+private:
+    std::mutex                      overflow_mtx_{};
+    // lowest addresses of the mappings of the cold stacks
+    std::vector< void * >           overflow_{};
+
+public:
+    std::uint64_t const             id;
+    std::size_t const               stack_size;
+    // 0 or one page below each stack
+    std::size_t const               guard_size;
+    // stack and guard page
+    std::size_t const               mapping_size;
+    std::size_t const               prefault_size;
+    std::size_t const               thread_cache_size;
+    std::size_t const               overflow_size;
+
+    std::atomic< std::size_t >      mapped{ 0 };
+    std::atomic< std::size_t >      pooled{ 0 };
+    std::atomic< std::uint64_t >    cold{ 0 };
+    std::atomic< std::uint64_t >    prefaulted_pages{ 0 };
+    std::atomic< std::uint64_t >    prefault_faults{ 0 };
+
+    pool( std::size_t stack_size_, std::size_t guard_size_, std::size_t prefault_size_,
+          std::size_t thread_cache_size_, std::size_t overflow_size_) :
+        id{ next_pool_id.fetch_add( 1, std::memory_order_relaxed) },
+        stack_size{ stack_size_ },
+        guard_size{ guard_size_ },
+        mapping_size{ guard_size_ + stack_size_ },
+        prefault_size{ prefault_size_ },
+        thread_cache_size{ thread_cache_size_ },
+        overflow_size{ overflow_size_ } {
+        // put_overflow() must not allocate
+        overflow_.reserve( overflow_size);
+    }
+
+    ~pool() {
+        for ( void * vp : overflow_) {
+            unmap_stack( vp, mapping_size);
+        }
+    }
+
+    pool( pool const&) = delete;
+    pool & operator=( pool const&) = delete;
+
+    // faults in the top of the stack (stacks grow downwards)
+    void prefault( void * vp) noexcept {
+        if ( 0 == prefault_size) {
+            return;
+        }
+        char * top = static_cast< char * >( vp) + mapping_size;
+        char * first = top - prefault_size;
+        std::uint64_t faults = thread_page_faults();
+#if defined(MADV_POPULATE_WRITE)
+        // Linux 5.14
+        if ( 0 != ::madvise( first, prefault_size, MADV_POPULATE_WRITE) )
+#endif
+        {
+            for ( char * p = top - page_size(); first <= p; p -= page_size() ) {
+                * static_cast< char volatile * >( p) = 0;
+            }
+        }
+        prefaulted_pages.fetch_add( prefault_size / page_size(), std::memory_order_relaxed);
+        prefault_faults.fetch_add( thread_page_faults() - faults, std::memory_order_relaxed);
+    }
+
+    void * map() {
+        void * vp = map_stack( mapping_size);
+        if ( 0 < guard_size && ! protect_guard( vp, guard_size) ) {
+            unmap_stack( vp, mapping_size);
+            throw std::bad_alloc{};
+        }
+        mapped.fetch_add( 1, std::memory_order_relaxed);
+        bind_to_local_node( static_cast< char * >( vp) + guard_size, stack_size);
+        prefault( vp);
+        return vp;
+    }
+
+    void unmap( void * vp) noexcept {
+        unmap_stack( vp, mapping_size);
+        mapped.fetch_sub( 1, std::memory_order_relaxed);
+    }
+
+    void * take_overflow() noexcept {
+        void * vp = nullptr;
+        {
+            std::unique_lock< std::mutex > lk{ overflow_mtx_ };
+            if ( overflow_.empty() ) {
+                return nullptr;
+            }
+            vp = overflow_.back();
+            overflow_.pop_back();
+        }
+        pooled.fetch_sub( 1, std::memory_order_relaxed);
+        // the pages might have been reclaimed
+        prefault( vp);
+        return vp;
+    }
+
+    // the stacks are not counted as pooled
+    void put_overflow( void * const* vps, std::size_t n) noexcept {
+        std::size_t room = 0;
+        {
+            std::unique_lock< std::mutex > lk{ overflow_mtx_ };
+            room = (std::min)( n, overflow_size - overflow_.size() );
+        }
+        // stacks that do not fit are unmapped right away, without madvise()
+        for ( std::size_t i = room; i < n; ++i) {
+            unmap( vps[i]);
+        }
+        // not under the lock; the stacks are not visible to other threads yet
+        for ( std::size_t i = 0; i < room; ++i) {
+            advise_cold( static_cast< char * >( vps[i]) + guard_size, stack_size);
+        }
+        std::size_t taken = 0;
+        {
+            std::unique_lock< std::mutex > lk{ overflow_mtx_ };
+            // other threads might have filled the list meanwhile
+            taken = (std::min)( room, overflow_size - overflow_.size() );
+            overflow_.insert( overflow_.end(), vps, vps + taken);
+        }
+        pooled.fetch_add( taken, std::memory_order_relaxed);
+        cold.fetch_add( taken, std::memory_order_relaxed);
+        for ( std::size_t i = taken; i < room; ++i) {
+            unmap( vps[i]);
+        }
+    }
+};
+
+namespace {
+
+// free lists of the calling thread, one per pool used by the thread
+class thread_cache {
+public:
+    struct entry {
+        std::uint64_t                               id;
+        std::weak_ptr< numa_pooled_stack::pool >    pool;
+        std::size_t                                 mapping_size;
+        // lowest addresses of the mappings, the most recently released at the end
+        std::vector< void * >                       stacks;
+    };
+
+private:
+    std::vector< entry >    entries_{};
+
+    static void release_( entry & e) noexcept {
+        std::shared_ptr< numa_pooled_stack::pool > p = e.pool.lock();
+        if ( p) {
+            p->pooled.fetch_sub( e.stacks.size(), std::memory_order_relaxed);
+            p->put_overflow( e.stacks.data(), e.stacks.size() );
+        } else {
+            // the pool is gone
+            for ( void * vp : e.stacks) {
+                unmap_stack( vp, e.mapping_size);
+            }
+        }
+        e.stacks.clear();
+    }
+
+public:
+    static thread_local bool    destroyed;
+
+    thread_cache() = default;
+
+    ~thread_cache() {
+        // stacks released later by this thread go to the overflow list
+        destroyed = true;
+        for ( entry & e : entries_) {
+            release_( e);
+        }
+    }
+
+    thread_cache( thread_cache const&) = delete;
+    thread_cache & operator=( thread_cache const&) = delete;
+
+    entry & get( std::shared_ptr< numa_pooled_stack::pool > const& p) {
+        for ( entry & e : entries_) {
+            if ( e.id == p->id) {
+                return e;
+            }
+        }
+        // drop the stacks of destroyed pools
+        for ( std::size_t i = entries_.size(); 0 < i; --i) {
+            if ( entries_[i - 1].pool.expired() ) {
+                release_( entries_[i - 1]);
+                entries_.erase( entries_.begin() + ( i - 1) );
+            }
+        }
+        entry e{ p->id, p, p->mapping_size, {} };
+        // put() must not allocate
+        e.stacks.reserve( p->thread_cache_size);
+        entries_.push_back( std::move( e) );
+        return entries_.back();
+    }
+};
+
+thread_local bool thread_cache::destroyed{ false };
+
+thread_cache & current_thread_cache() {
+    static thread_local thread_cache cache;
+    return cache;
+}
+
+}
+
+numa_pooled_stack::numa_pooled_stack( std::size_t stack_size,
+                                      std::size_t prefault_size,
+                                      std::size_t thread_cache_size,
+                                      std::size_t overflow_size,
+                                      bool guard_page) {
+    BOOST_ASSERT( traits_type::minimum_size() <= stack_size);
+    BOOST_ASSERT( traits_type::is_unbounded() || ( traits_type::maximum_size() >= stack_size) );
+    // whole pages
+    stack_size = ( stack_size + page_size() - 1) / page_size() * page_size();
+    prefault_size = ( (std::min)( prefault_size, stack_size) + page_size() - 1) / page_size() * page_size();
+    pool_ = std::make_shared< pool >( stack_size, guard_page ? page_size() : 0,
+                                      prefault_size, thread_cache_size, overflow_size);
+}
+
+boost::context::stack_context
+numa_pooled_stack::allocate() {
+    void * vp = nullptr;
+    if ( 0 < pool_->thread_cache_size && ! thread_cache::destroyed) {
+        thread_cache::entry & e = current_thread_cache().get( pool_);
+        if ( ! e.stacks.empty() ) {
+            // most recently released, still warm
+            vp = e.stacks.back();
+            e.stacks.pop_back();
+            pool_->pooled.fetch_sub( 1, std::memory_order_relaxed);
+        }
+    }
+    if ( nullptr == vp) {
+        vp = pool_->take_overflow();
+    }
+    if ( nullptr == vp) {
+        vp = pool_->map();
+    }
+    boost::context::stack_context sctx;
+    sctx.size = pool_->stack_size;
+    sctx.sp = static_cast< char * >( vp) + pool_->mapping_size;
+#if defined(BOOST_USE_VALGRIND)
+    sctx.valgrind_stack_id = VALGRIND_STACK_REGISTER( sctx.sp, static_cast< char * >( vp) + pool_->guard_size);
+#endif
+    return sctx;
+}
+
+void
+numa_pooled_stack::deallocate( boost::context::stack_context & sctx) noexcept {
+    BOOST_ASSERT( sctx.sp);
+    BOOST_ASSERT( pool_->stack_size == sctx.size);
+#if defined(BOOST_USE_VALGRIND)
+    VALGRIND_STACK_DEREGISTER( sctx.valgrind_stack_id);
+#endif
+    void * vp = static_cast< char * >( sctx.sp) - pool_->mapping_size;
+    if ( 0 < pool_->thread_cache_size && ! thread_cache::destroyed) {
+        try {
+            thread_cache::entry & e = current_thread_cache().get( pool_);
+            if ( e.stacks.size() == pool_->thread_cache_size) {
+                // the older half becomes cold
+                std::size_t n = ( e.stacks.size() + 1) / 2;
+                pool_->pooled.fetch_sub( n, std::memory_order_relaxed);
+                pool_->put_overflow( e.stacks.data(), n);
+                e.stacks.erase( e.stacks.begin(), e.stacks.begin() + n);
+            }
+            e.stacks.push_back( vp);
+            pool_->pooled.fetch_add( 1, std::memory_order_relaxed);
+            return;
+        } catch (...) {
+            // no free list for this thread
+        }
+    }
+    pool_->put_overflow( & vp, 1);
+}
+
+numa_pooled_stack_statistics
+numa_pooled_stack::statistics() const noexcept {
+    numa_pooled_stack_statistics s;
+    s.stack_size = pool_->stack_size;
+    s.mapped_stacks = pool_->mapped.load( std::memory_order_relaxed);
+    s.pooled_stacks = pool_->pooled.load( std::memory_order_relaxed);
+    s.pooled_bytes = s.pooled_stacks * s.stack_size;
+    s.cold_stacks = pool_->cold.load( std::memory_order_relaxed);
+    s.prefaulted_pages = pool_->prefaulted_pages.load( std::memory_order_relaxed);
+    s.prefault_faults = pool_->prefault_faults.load( std::memory_order_relaxed);
+    return s;
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
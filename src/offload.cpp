@@ -0,0 +1,125 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/offload.hpp"
+
+#include <algorithm>
+#include <system_error>
+
+#include <boost/assert.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+offload_pool &
+offload_pool::instance() {
+    static offload_pool pool;
+    return pool;
+}
+
+offload_pool::offload_pool() :
+        max_threads_{ (std::max)( std::size_t{ 4 }, static_cast< std::size_t >( std::thread::hardware_concurrency() ) ) } {
+}
+
+offload_pool::~offload_pool() {
+    {
+        std::unique_lock< std::mutex > lk{ mtx_ };
+        shutdown_ = true;
+    }
+    cnd_.notify_all();
+    for ( std::thread & t : threads_) {
+        t.join();
+    }
+    BOOST_ASSERT( queue_.empty() );
+}
+
+void
+offload_pool::worker_() noexcept {
+    std::unique_lock< std::mutex > lk{ mtx_ };
+    for (;;) {
+        while ( queue_.empty() && ! shutdown_) {
+            ++idle_;
+            cnd_.wait( lk);
+            --idle_;
+        }
+        if ( queue_.empty() ) {
+            // shutdown
+            return;
+        }
+        offload_task & task = queue_.front();
+        queue_.pop_front();
+        ++busy_;
+        lk.unlock();
+        task.run();
+        lk.lock();
+        --busy_;
+        ++completed_;
+        lk.unlock();
+        // the task is destroyed by the fiber after it has been woken, it must
+        // not be accessed after complete(); waking the fiber does not need mtx_
+        task.complete();
+        lk.lock();
+    }
+}
+
+void
+offload_pool::submit( offload_task & task) {
+    std::unique_lock< std::mutex > lk{ mtx_ };
+    if ( queue_.size() >= idle_ && threads_.size() < max_threads_) {
+        // no idle helper thread left for this task
+        try {
+            threads_.emplace_back( & offload_pool::worker_, this);
+        } catch ( std::system_error const&) {
+            if ( threads_.empty() ) {
+                throw;
+            }
+            // queue the task for the running helper threads
+        }
+    }
+    queue_.push_back( task);
+    max_queued_ = (std::max)( max_queued_, queue_.size() );
+    lk.unlock();
+    cnd_.notify_one();
+}
+
+void
+offload_pool::max_threads( std::size_t n) {
+    std::unique_lock< std::mutex > lk{ mtx_ };
+    max_threads_ = (std::max)( std::size_t{ 1 }, (std::max)( n, threads_.size() ) );
+}
+
+offload_statistics
+offload_pool::statistics() const {
+    std::unique_lock< std::mutex > lk{ mtx_ };
+    offload_statistics stats;
+    stats.threads = threads_.size();
+    stats.busy = busy_;
+    stats.queued = queue_.size();
+    stats.max_queued = max_queued_;
+    stats.max_threads = max_threads_;
+    stats.completed = completed_;
+    return stats;
+}
+
+}
+
+void set_offload_threads( std::size_t n) {
+    detail::offload_pool::instance().max_threads( n);
+}
+
+offload_statistics get_offload_statistics() {
+    return detail::offload_pool::instance().statistics();
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
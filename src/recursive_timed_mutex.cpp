@@ -22,7 +22,7 @@ namespace fibers {
 bool
 recursive_timed_mutex::try_lock_until_( std::chrono::steady_clock::time_point const& timeout_time) noexcept {
     while ( true) {
-        if ( std::chrono::steady_clock::now() > timeout_time) {
+        if ( cached_clock::now() > timeout_time) {
             return false;
         }
         context * active_ctx = context::active();
@@ -21,6 +21,22 @@
 namespace boost {
 namespace fibers {
 
+constexpr bool cached_clock::is_steady;
+
+cached_clock::time_point
+cached_clock::now() noexcept {
+    return context::active()->get_scheduler()->now();
+}
+
+void
+scheduler::refresh_now_() noexcept {
+#if defined(BOOST_FIBERS_USE_TSC_CLOCK)
+    now_ = clock_.now();
+#else
+    now_ = std::chrono::steady_clock::now();
+#endif
+}
+
 void
 scheduler::release_terminated_() noexcept {
     while ( ! terminated_queue_.empty() ) {
@@ -48,26 +64,58 @@ scheduler::release_terminated_() noexcept {
 #if ! defined(BOOST_FIBERS_NO_ATOMICS)
 void
 scheduler::remote_ready2ready_() noexcept {
-    remote_ready_queue_type tmp;
-    detail::spinlock_lock lk{ remote_ready_splk_ };
-    remote_ready_queue_.swap( tmp);
-    lk.unlock();
+    // fast path: nothing arrived from other threads
+    if ( remote_ready_queue_.empty() ) {
+        return;
+    }
     // get context from remote ready-queue
-    while ( ! tmp.empty() ) {
-        context * ctx = & tmp.front();
-        tmp.pop_front();
+    // a context that is not yet completely pushed will be
+    // dequeued in the next iteration (producer calls notify())
+    context * ctx = nullptr;
+    while ( nullptr != ( ctx = remote_ready_queue_.pop() ) ) {
+#if defined(BOOST_FIBERS_USE_STATISTICS)
+        stats_.remote_wakeups.add();
+#endif
         // store context in local queues
-        schedule( ctx);
+        awakened_( ctx);
     }
 }
 #endif
 
+void
+scheduler::timeout_( context * ctx) noexcept {
+    // set before waking: a woken context might be stolen and resumed by
+    // another thread right away; a context still sleep-linked can not run
+    // (a concurrent remote wake leaves it in this scheduler's
+    // remote-ready-queue)
+    ctx->timed_out_ = true;
+    if ( ! ctx->sleep_waker_.wake() ) {
+        // sleep_waker_ is outdated, the context has been signaled
+        ctx->timed_out_ = false;
+    }
+}
+
 void
 scheduler::sleep2ready_() noexcept {
     // move context which the deadline has reached
     // to ready-queue
     // sleep-queue is sorted (ascending)
-    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point const now = now_;
+    if ( timer_wheel_) {
+        // expire all context' of the timer-wheel with deadline <= now
+        timer_wheel_->expire( now, [this](context * ctx){
+            BOOST_ASSERT( ! ctx->is_context( type::dispatcher_context) );
+            BOOST_ASSERT( ! ctx->ready_is_linked() );
+            BOOST_ASSERT( ! ctx->terminated_is_linked() );
+            // reset sleep-tp
+            ctx->tp_ = (std::chrono::steady_clock::time_point::max)();
+#if defined(BOOST_FIBERS_USE_STATISTICS)
+            stats_.sleeping.sub();
+#endif
+            timeout_( ctx);
+        });
+        return;
+    }
     sleep_queue_type::iterator e = sleep_queue_.end();
     for ( sleep_queue_type::iterator i = sleep_queue_.begin(); i != e;) {
         context * ctx = & ( * i);
@@ -86,15 +134,63 @@ scheduler::sleep2ready_() noexcept {
             i = sleep_queue_.erase( i);
             // reset sleep-tp
             ctx->tp_ = (std::chrono::steady_clock::time_point::max)();
-            ctx->sleep_waker_.wake();
+#if defined(BOOST_FIBERS_USE_STATISTICS)
+            stats_.sleeping.sub();
+#endif
+            timeout_( ctx);
         } else {
             break; // first context with now < deadline
         }
     }
 }
 
+void
+scheduler::sleep_link_( context * ctx) noexcept {
+#if defined(BOOST_FIBERS_USE_STATISTICS)
+    stats_.sleeping.add();
+#endif
+    if ( timer_wheel_) {
+        timer_wheel_->insert( ctx);
+    } else {
+        ctx->sleep_link( sleep_queue_);
+    }
+}
+
+void
+scheduler::awakened_( context * ctx) noexcept {
+    // remove context ctx from sleep-queue
+    // (might happen if blocked in timed_mutex::try_lock_until())
+    if ( ctx->sleep_is_linked() ) {
+        // unlink it from sleep-queue
+        ctx->sleep_unlink();
+#if defined(BOOST_FIBERS_USE_STATISTICS)
+        stats_.sleeping.sub();
+#endif
+    }
+    // push new context to ready-queue
+    algo_->awakened( ctx);
+}
+
+context *
+scheduler::pick_next_() noexcept {
+    context * ctx = algo_->pick_next();
+#if defined(BOOST_FIBERS_USE_STATISTICS)
+    if ( nullptr != ctx) {
+        stats_.context_switches.add();
+        stats_.record_ready_delay( std::chrono::steady_clock::now() - ctx->ready_tp_);
+    }
+#endif
+    return ctx;
+}
+
 scheduler::scheduler(algo::algorithm::ptr_t algo) noexcept :
-    algo_{algo} {
+    algo_{algo},
+    props_algo_{ dynamic_cast< algo::algorithm_with_properties_base * >( algo_.get() ) } {
+    refresh_now_();
+#if defined(BOOST_FIBERS_USE_STATISTICS)
+    stack_cache_.counters( & stats_);
+#endif
+    detail::stack_cache::current( & stack_cache_);
 }
 
 scheduler::~scheduler() {
@@ -110,6 +206,10 @@ scheduler::~scheduler() {
     BOOST_ASSERT( worker_queue_.empty() );
     BOOST_ASSERT( terminated_queue_.empty() );
     BOOST_ASSERT( sleep_queue_.empty() );
+    BOOST_ASSERT( ! timer_wheel_ || timer_wheel_->empty() );
+    // stacks of fibers released after this point go back to their allocator
+    detail::stack_cache::current( nullptr);
+    stack_cache_.clear();
     // set active context to nullptr
     context::reset_active();
     // deallocate dispatcher-context
@@ -130,6 +230,8 @@ scheduler::dispatch() noexcept {
                 break;
             }
         }
+        // refresh cached time, once per iteration
+        refresh_now_();
         // release terminated context'
         release_terminated_();
 #if ! defined(BOOST_FIBERS_NO_ATOMICS)
@@ -140,7 +242,7 @@ scheduler::dispatch() noexcept {
         // must be called after remote_ready2ready_()
         sleep2ready_();
         // get next ready context
-        context * ctx = algo_->pick_next();
+        context * ctx = pick_next_();
         if ( nullptr != ctx) {
             BOOST_ASSERT( ctx->is_resumable() );
             BOOST_ASSERT( ! ctx->ready_is_linked() );
@@ -159,12 +261,25 @@ scheduler::dispatch() noexcept {
             std::chrono::steady_clock::time_point suspend_time =
                     (std::chrono::steady_clock::time_point::max)();
             // get lowest deadline from sleep-queue
-            sleep_queue_type::iterator i = sleep_queue_.begin();
-            if ( sleep_queue_.end() != i) {
-                suspend_time = i->tp_;
+            if ( timer_wheel_) {
+                suspend_time = timer_wheel_->next_deadline();
+            } else {
+                sleep_queue_type::iterator i = sleep_queue_.begin();
+                if ( sleep_queue_.end() != i) {
+                    suspend_time = i->tp_;
+                }
             }
             // no ready context, wait till signaled
+#if defined(BOOST_FIBERS_USE_STATISTICS)
+            std::chrono::steady_clock::time_point suspend_start = std::chrono::steady_clock::now();
+            algo_->suspend_until( suspend_time);
+            stats_.suspends.add();
+            stats_.suspend_ns.add( static_cast< std::uint64_t >(
+                std::chrono::duration_cast< std::chrono::nanoseconds >(
+                    std::chrono::steady_clock::now() - suspend_start).count() ) );
+#else
             algo_->suspend_until( suspend_time);
+#endif
         }
     }
     // release termianted context'
@@ -181,14 +296,38 @@ scheduler::schedule( context * ctx) noexcept {
     BOOST_ASSERT( ! ctx->remote_ready_is_linked() );
 #endif
     BOOST_ASSERT( ! ctx->terminated_is_linked() );
-    // remove context ctx from sleep-queue
-    // (might happen if blocked in timed_mutex::try_lock_until())
-    if ( ctx->sleep_is_linked() ) {
-        // unlink it from sleep-queue
-        ctx->sleep_unlink();
+#if defined(BOOST_FIBERS_USE_STATISTICS)
+    stats_.local_wakeups.add();
+    ctx->ready_tp_ = std::chrono::steady_clock::now();
+#endif
+    awakened_( ctx);
+}
+
+void
+scheduler::schedule_n( context ** ctxs, std::size_t n) noexcept {
+    BOOST_ASSERT( nullptr != ctxs || 0 == n);
+    if ( 0 == n) {
+        return;
     }
-    // push new context to ready-queue
-    algo_->awakened( ctx);
+#if defined(BOOST_FIBERS_USE_STATISTICS)
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    stats_.local_wakeups.add( n);
+#endif
+    for ( std::size_t i = 0; i < n; ++i) {
+        BOOST_ASSERT( nullptr != ctxs[i]);
+        BOOST_ASSERT( this == ctxs[i]->get_scheduler() );
+        BOOST_ASSERT( ! ctxs[i]->ready_is_linked() );
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+        BOOST_ASSERT( ! ctxs[i]->remote_ready_is_linked() );
+#endif
+        BOOST_ASSERT( ! ctxs[i]->sleep_is_linked() );
+        BOOST_ASSERT( ! ctxs[i]->terminated_is_linked() );
+#if defined(BOOST_FIBERS_USE_STATISTICS)
+        ctxs[i]->ready_tp_ = now;
+#endif
+    }
+    // push all contexts to ready-queue at once
+    algo_->awakened_n( ctxs, n);
 }
 
 #if ! defined(BOOST_FIBERS_NO_ATOMICS)
@@ -201,14 +340,14 @@ scheduler::schedule_from_remote( context * ctx) noexcept {
     BOOST_ASSERT( ! ctx->ready_is_linked() );
     BOOST_ASSERT( ! ctx->remote_ready_is_linked() );
     BOOST_ASSERT( ! ctx->terminated_is_linked() );
-    // protect for concurrent access
-    detail::spinlock_lock lk{ remote_ready_splk_ };
     BOOST_ASSERT( ! shutdown_);
     BOOST_ASSERT( nullptr != main_ctx_);
     BOOST_ASSERT( nullptr != dispatcher_ctx_.get() );
-    // push new context to remote ready-queue
-    ctx->remote_ready_link( remote_ready_queue_);
-    lk.unlock();
+#if defined(BOOST_FIBERS_USE_STATISTICS)
+    ctx->ready_tp_ = std::chrono::steady_clock::now();
+#endif
+    // push new context to remote ready-queue (wait-free)
+    remote_ready_queue_.push( ctx);
     // notify scheduler
     algo_->notify();
 }
@@ -236,7 +375,7 @@ scheduler::terminate( detail::spinlock_lock & lk, context * ctx) noexcept {
     // release lock
     lk.unlock();
     // resume another fiber
-    return algo_->pick_next()->suspend_with_cc();
+    return pick_next_()->suspend_with_cc();
 }
 
 void
@@ -250,8 +389,41 @@ scheduler::yield( context * ctx) noexcept {
 #endif
     BOOST_ASSERT( ! ctx->sleep_is_linked() );
     BOOST_ASSERT( ! ctx->terminated_is_linked() );
+#if defined(BOOST_FIBERS_USE_STATISTICS)
+    stats_.yields.add();
+#endif
     // resume another fiber
-    algo_->pick_next()->resume( ctx);
+    pick_next_()->resume( ctx);
+}
+
+void
+scheduler::handoff( context * active_ctx, context * ctx) noexcept {
+    BOOST_ASSERT( nullptr != active_ctx);
+    BOOST_ASSERT( nullptr != ctx);
+    BOOST_ASSERT( context::active() == active_ctx);
+    BOOST_ASSERT( active_ctx->is_context( type::worker_context) || active_ctx->is_context( type::main_context) );
+    BOOST_ASSERT( ! active_ctx->ready_is_linked() );
+    BOOST_ASSERT( this == ctx->get_scheduler() );
+    BOOST_ASSERT( ! ctx->is_context( type::dispatcher_context) );
+    BOOST_ASSERT( ! ctx->ready_is_linked() );
+#if ! defined(BOOST_FIBERS_NO_ATOMICS)
+    BOOST_ASSERT( ! ctx->remote_ready_is_linked() );
+#endif
+    BOOST_ASSERT( ! ctx->terminated_is_linked() );
+    // the woken context might wait with a timeout
+    if ( ctx->sleep_is_linked() ) {
+        ctx->sleep_unlink();
+#if defined(BOOST_FIBERS_USE_STATISTICS)
+        stats_.sleeping.sub();
+#endif
+    }
+#if defined(BOOST_FIBERS_USE_STATISTICS)
+    stats_.local_wakeups.add();
+    stats_.context_switches.add();
+#endif
+    // switch directly to the woken context, bypassing the ready-queue;
+    // the active context is scheduled by the resumed context
+    ctx->resume( active_ctx);
 }
 
 bool
@@ -268,12 +440,15 @@ scheduler::wait_until( context * ctx,
     BOOST_ASSERT( ! ctx->terminated_is_linked() );
     ctx->sleep_waker_ = ctx->create_waker();
     ctx->tp_ = sleep_tp;
-    ctx->sleep_link( sleep_queue_);
+    ctx->timed_out_ = false;
+    sleep_link_( ctx);
     // resume another context
-    algo_->pick_next()->resume();
-    // context has been resumed
-    // check if deadline has reached
-    return std::chrono::steady_clock::now() < sleep_tp;
+    pick_next_()->resume();
+    // context has been resumed, maybe by another scheduler (stolen);
+    // refresh the cached time of the scheduler running it now
+    ctx->get_scheduler()->refresh_now_();
+    // a context that timed out has been woken by sleep2ready_()
+    return ! ctx->timed_out_;
 }
 
 bool
@@ -293,24 +468,27 @@ scheduler::wait_until( context * ctx,
     // push active context to sleep-queue
     ctx->sleep_waker_ = std::move( w);
     ctx->tp_ = sleep_tp;
-    ctx->sleep_link( sleep_queue_);
+    ctx->timed_out_ = false;
+    sleep_link_( ctx);
     // resume another context
-    algo_->pick_next()->resume( lk);
-    // context has been resumed
-    // check if deadline has reached
-    return std::chrono::steady_clock::now() < sleep_tp;
+    pick_next_()->resume( lk);
+    // context has been resumed, maybe by another scheduler (stolen);
+    // refresh the cached time of the scheduler running it now
+    ctx->get_scheduler()->refresh_now_();
+    // a context that timed out has been woken by sleep2ready_()
+    return ! ctx->timed_out_;
 }
 
 void
 scheduler::suspend() noexcept {
     // resume another context
-    algo_->pick_next()->resume();
+    pick_next_()->resume();
 }
 
 void
 scheduler::suspend( detail::spinlock_lock & lk) noexcept {
     // resume another context
-    algo_->pick_next()->resume( lk);
+    pick_next_()->resume( lk);
 }
 
 bool
@@ -325,6 +503,42 @@ scheduler::set_algo( algo::algorithm::ptr_t algo) noexcept {
         algo->awakened( algo_->pick_next() );
     }
     algo_ = std::move( algo);
+    props_algo_ = dynamic_cast< algo::algorithm_with_properties_base * >( algo_.get() );
+}
+
+void
+scheduler::use_timer_wheel( std::chrono::steady_clock::duration const& tick,
+                            std::chrono::steady_clock::time_point const& origin) {
+    if ( timer_wheel_) {
+        // move sleeping context' back to the sleep-queue
+        timer_wheel_->clear([this](context * ctx){
+            ctx->sleep_link( sleep_queue_);
+        });
+        timer_wheel_.reset();
+    }
+    if ( std::chrono::steady_clock::duration::zero() < tick) {
+        timer_wheel_.reset( new detail::timer_wheel{ tick, origin });
+        // move sleeping context' to the timer-wheel
+        while ( ! sleep_queue_.empty() ) {
+            context * ctx = & ( * sleep_queue_.begin() );
+            sleep_queue_.erase( sleep_queue_.begin() );
+            timer_wheel_->insert( ctx);
+        }
+    }
+}
+
+void
+scheduler::use_stack_cache( std::size_t high_watermark, std::size_t low_watermark) {
+    stack_cache_.set_watermarks( high_watermark, low_watermark);
+}
+
+scheduler_statistics
+scheduler::statistics() const noexcept {
+    scheduler_statistics s;
+#if defined(BOOST_FIBERS_USE_STATISTICS)
+    stats_.collect( s);
+#endif
+    return s;
 }
 
 void
@@ -353,6 +567,9 @@ scheduler::attach_dispatcher_context( intrusive_ptr< context > ctx) noexcept {
     // the dispatcher-context is resumed and
     // scheduler::dispatch() is executed
     dispatcher_ctx_->scheduler_ = this;
+#if defined(BOOST_FIBERS_USE_STATISTICS)
+    dispatcher_ctx_->ready_tp_ = std::chrono::steady_clock::now();
+#endif
     algo_->awakened( dispatcher_ctx_.get() );
 }
 
@@ -382,7 +599,7 @@ scheduler::detach_worker_context( context * ctx) noexcept {
     BOOST_ASSERT( ! ctx->sleep_is_linked() );
     BOOST_ASSERT( ! ctx->terminated_is_linked() );
     BOOST_ASSERT( ctx->worker_is_linked() );
-    BOOST_ASSERT( ! ctx->is_context( type::pinned_context) );
+    BOOST_ASSERT( ! ctx->is_pinned() );
     ctx->worker_unlink();
     BOOST_ASSERT( ! ctx->worker_is_linked() );
     ctx->scheduler_ = nullptr;
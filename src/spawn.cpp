@@ -0,0 +1,44 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/spawn.hpp"
+
+#include <boost/assert.hpp>
+
+#include "boost/fiber/scheduler.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+std::vector< fiber >
+fiber_batch::launch( std::exception_ptr ex) {
+    BOOST_ASSERT( ctxs_.size() == fibers_.size() );
+    context * active = context::active();
+    // link all contexts into the worker-queue
+    for ( context * ctx : ctxs_) {
+        active->attach( ctx);
+    }
+    // push all contexts to the ready-queue at once
+    active->get_scheduler()->schedule_n( ctxs_.data(), ctxs_.size() );
+    ctxs_.clear();
+    if ( ex) {
+        for ( fiber & f : fibers_) {
+            f.join();
+        }
+        std::rethrow_exception( ex);
+    }
+    return std::move( fibers_);
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -0,0 +1,113 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/detail/stack_cache.hpp"
+
+#include <boost/assert.hpp>
+
+#include "boost/fiber/detail/statistics.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+namespace {
+
+thread_local stack_cache * current_stack_cache{ nullptr };
+
+}
+
+stack_cache *
+stack_cache::current() noexcept {
+    return current_stack_cache;
+}
+
+void
+stack_cache::current( stack_cache * cache) noexcept {
+    current_stack_cache = cache;
+}
+
+stack_cache::~stack_cache() {
+    clear();
+}
+
+void
+stack_cache::shrink_( std::size_t n) noexcept {
+    if ( entries_.size() <= n) {
+        return;
+    }
+    // release the oldest stacks, recently used stacks are still warm
+    std::size_t surplus = entries_.size() - n;
+    for ( std::size_t i = 0; i < surplus; ++i) {
+        entries_[i].deallocate( entries_[i].sctx);
+    }
+    entries_.erase( entries_.begin(), entries_.begin() + surplus);
+}
+
+void
+stack_cache::set_watermarks( std::size_t high_watermark, std::size_t low_watermark) {
+    if ( high_watermark <= low_watermark) {
+        low_watermark = 0 < high_watermark ? high_watermark - 1 : 0;
+    }
+    shrink_( high_watermark);
+    // put() must not allocate
+    entries_.reserve( high_watermark);
+    high_watermark_ = high_watermark;
+    low_watermark_ = low_watermark;
+}
+
+bool
+stack_cache::get( deallocate_fn fn, std::size_t key, boost::context::stack_context & sctx) noexcept {
+    if ( 0 == high_watermark_) {
+        return false;
+    }
+    for ( std::size_t i = entries_.size(); 0 < i; --i) {
+        entry & e = entries_[i - 1];
+        if ( e.deallocate == fn && e.key == key) {
+            sctx = e.sctx;
+            entries_.erase( entries_.begin() + ( i - 1) );
+#if defined(BOOST_FIBERS_USE_STATISTICS)
+            if ( nullptr != stats_) {
+                stats_->stack_cache_hits.add();
+            }
+#endif
+            return true;
+        }
+    }
+#if defined(BOOST_FIBERS_USE_STATISTICS)
+    if ( nullptr != stats_) {
+        stats_->stack_cache_misses.add();
+    }
+#endif
+    return false;
+}
+
+bool
+stack_cache::put( deallocate_fn fn, std::size_t key, boost::context::stack_context & sctx) noexcept {
+    if ( 0 == high_watermark_) {
+        return false;
+    }
+    if ( high_watermark_ <= entries_.size() ) {
+        shrink_( low_watermark_);
+    }
+    BOOST_ASSERT( entries_.size() < entries_.capacity() );
+    entries_.push_back( entry{ fn, key, sctx });
+    return true;
+}
+
+void
+stack_cache::clear() noexcept {
+    shrink_( 0);
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -0,0 +1,164 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/stack_profile.hpp"
+
+#include <cstring>
+#include <iomanip>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+namespace {
+
+constexpr std::uint64_t pattern = UINT64_C( 0xa5a5a5a5a5a5a5a5);
+
+// painted range [*first, *last) in whole words, stacks grow downwards
+void painted_range( boost::context::stack_context const& sctx, std::size_t guard,
+                    std::uint64_t ** first, std::uint64_t ** last) noexcept {
+    std::uintptr_t top = reinterpret_cast< std::uintptr_t >( sctx.sp) & ~ static_cast< std::uintptr_t >( 7);
+    std::uintptr_t bottom = ( reinterpret_cast< std::uintptr_t >( sctx.sp) - sctx.size + guard + 7)
+        & ~ static_cast< std::uintptr_t >( 7);
+    * first = reinterpret_cast< std::uint64_t * >( bottom);
+    * last = reinterpret_cast< std::uint64_t * >( bottom < top ? top : bottom);
+}
+
+std::size_t bucket( std::size_t used) noexcept {
+    std::size_t i = 0;
+    while ( i < stack_usage::buckets - 1 && ( std::size_t{ 1024 } << i) < used) {
+        ++i;
+    }
+    return i;
+}
+
+}
+
+void paint_stack( boost::context::stack_context const& sctx, std::size_t guard) noexcept {
+    std::uint64_t * first, * last;
+    painted_range( sctx, guard, & first, & last);
+    for ( std::uint64_t * p = first; p != last; ++p) {
+        * p = pattern;
+    }
+}
+
+std::size_t measure_stack( boost::context::stack_context const& sctx, std::size_t guard) noexcept {
+    std::uint64_t * first, * last;
+    painted_range( sctx, guard, & first, & last);
+    // the deepest overwritten word determines the high-water mark
+    std::uint64_t * p = first;
+    while ( p != last && pattern == * p) {
+        ++p;
+    }
+    return static_cast< std::size_t >( reinterpret_cast< char * >( last) - reinterpret_cast< char * >( p) );
+}
+
+stack_usage_counters::stack_usage_counters( std::string const& tag_) :
+    tag{ tag_ } {
+    for ( std::atomic< std::uint64_t > & h : histogram) {
+        h.store( 0, std::memory_order_relaxed);
+    }
+}
+
+void
+stack_usage_counters::record( std::size_t used) noexcept {
+    samples.fetch_add( 1, std::memory_order_relaxed);
+    sum.fetch_add( used, std::memory_order_relaxed);
+    histogram[bucket( used)].fetch_add( 1, std::memory_order_relaxed);
+    std::size_t max = max_used.load( std::memory_order_relaxed);
+    while ( max < used &&
+            ! max_used.compare_exchange_weak( max, used, std::memory_order_relaxed) ) {
+    }
+}
+
+void
+stack_usage_counters::reset() noexcept {
+    samples.store( 0, std::memory_order_relaxed);
+    sum.store( 0, std::memory_order_relaxed);
+    max_used.store( 0, std::memory_order_relaxed);
+    for ( std::atomic< std::uint64_t > & h : histogram) {
+        h.store( 0, std::memory_order_relaxed);
+    }
+}
+
+stack_usage
+stack_usage_counters::usage() const {
+    stack_usage u;
+    u.tag = tag;
+    u.samples = samples.load( std::memory_order_relaxed);
+    u.max_used = max_used.load( std::memory_order_relaxed);
+    u.mean_used = 0 < u.samples
+        ? static_cast< std::size_t >( sum.load( std::memory_order_relaxed) / u.samples)
+        : 0;
+    for ( std::size_t i = 0; i < stack_usage::buckets; ++i) {
+        u.histogram[i] = histogram[i].load( std::memory_order_relaxed);
+    }
+    return u;
+}
+
+}
+
+stack_profile &
+stack_profile::global() {
+    static stack_profile profile;
+    return profile;
+}
+
+detail::stack_usage_counters *
+stack_profile::counters( std::string const& tag) {
+    std::unique_lock< std::mutex > lk{ mtx_ };
+    std::unique_ptr< detail::stack_usage_counters > & c = counters_[tag];
+    if ( ! c) {
+        c.reset( new detail::stack_usage_counters{ tag });
+    }
+    return c.get();
+}
+
+std::vector< stack_usage >
+stack_profile::usage() const {
+    std::vector< stack_usage > v;
+    std::unique_lock< std::mutex > lk{ mtx_ };
+    for ( auto const& c : counters_) {
+        v.push_back( c.second->usage() );
+    }
+    return v;
+}
+
+void
+stack_profile::reset() noexcept {
+    std::unique_lock< std::mutex > lk{ mtx_ };
+    for ( auto & c : counters_) {
+        c.second->reset();
+    }
+}
+
+void
+stack_profile::report( std::ostream & os) const {
+    for ( stack_usage const& u : usage() ) {
+        os << u.tag << ": " << u.samples << " fibers, max " << u.max_used
+           << " bytes, mean " << u.mean_used << " bytes\n";
+        for ( std::size_t i = 0; i < stack_usage::buckets; ++i) {
+            if ( 0 == u.histogram[i]) {
+                continue;
+            }
+            if ( i < stack_usage::buckets - 1) {
+                os << "  <= " << std::setw( 6) << ( 1 << i) << " KiB: ";
+            } else {
+                os << "   > " << std::setw( 6) << ( 1 << ( i - 1) ) << " KiB: ";
+            }
+            os << u.histogram[i] << '\n';
+        }
+    }
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
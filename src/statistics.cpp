@@ -0,0 +1,142 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/statistics.hpp"
+
+#include <new>
+#include <type_traits>
+
+#include <boost/intrusive/list.hpp>
+
+#include "boost/fiber/context.hpp"
+#include "boost/fiber/detail/spinlock.hpp"
+#include "boost/fiber/detail/statistics.hpp"
+#include "boost/fiber/scheduler.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+namespace {
+
+typedef intrusive::list<
+            statistics_counters,
+            intrusive::member_hook<
+                statistics_counters, statistics_counters::hook_type, & statistics_counters::hook_ >,
+            intrusive::constant_time_size< false >
+        >                                               registry_type;
+
+// registering a scheduler neither allocates nor throws: the registry lives
+// in static storage and is guarded by a spinlock
+struct registry {
+    spinlock                splk{};
+    registry_type           counters{};
+    // accumulated counters of destroyed schedulers
+    scheduler_statistics    retired{};
+
+    static registry & instance() noexcept {
+        // never destroyed; schedulers of detached threads might
+        // unregister after static destruction
+        static std::aligned_storage< sizeof( registry), alignof( registry) >::type storage;
+        static registry * r = new ( & storage) registry{};
+        return * r;
+    }
+};
+
+}
+
+statistics_counters::statistics_counters() noexcept {
+#if defined(BOOST_FIBERS_USE_STATISTICS)
+    registry & r = registry::instance();
+    spinlock_lock lk{ r.splk };
+    r.counters.push_back( * this);
+#endif
+}
+
+statistics_counters::~statistics_counters() {
+    // counters are registered only with BOOST_FIBERS_USE_STATISTICS
+    if ( ! hook_.is_linked() ) {
+        return;
+    }
+    registry & r = registry::instance();
+    spinlock_lock lk{ r.splk };
+    r.counters.erase( r.counters.iterator_to( * this) );
+    scheduler_statistics s;
+    collect( s);
+    // only counters survive their scheduler
+    s.schedulers = 0;
+    s.sleeping = 0;
+    r.retired += s;
+}
+
+void
+statistics_counters::collect( scheduler_statistics & s) const noexcept {
+    s.schedulers += 1;
+    s.context_switches += context_switches.load();
+    s.yields += yields.load();
+    s.local_wakeups += local_wakeups.load();
+    s.remote_wakeups += remote_wakeups.load();
+    s.steals_attempted += steals_attempted.load();
+    s.steals_succeeded += steals_succeeded.load();
+    s.sleeping += sleeping.load();
+    s.suspends += suspends.load();
+    s.suspend_ns += suspend_ns.load();
+    s.stack_cache_hits += stack_cache_hits.load();
+    s.stack_cache_misses += stack_cache_misses.load();
+    for ( std::size_t i = 0; i < scheduler_statistics::histogram_buckets; ++i) {
+        s.ready_delay[i] += ready_delay[i].load();
+    }
+}
+
+}
+
+constexpr std::size_t scheduler_statistics::histogram_buckets;
+
+scheduler_statistics &
+scheduler_statistics::operator+=( scheduler_statistics const& other) noexcept {
+    schedulers += other.schedulers;
+    context_switches += other.context_switches;
+    yields += other.yields;
+    local_wakeups += other.local_wakeups;
+    remote_wakeups += other.remote_wakeups;
+    steals_attempted += other.steals_attempted;
+    steals_succeeded += other.steals_succeeded;
+    sleeping += other.sleeping;
+    suspends += other.suspends;
+    suspend_ns += other.suspend_ns;
+    stack_cache_hits += other.stack_cache_hits;
+    stack_cache_misses += other.stack_cache_misses;
+    for ( std::size_t i = 0; i < histogram_buckets; ++i) {
+        ready_delay[i] += other.ready_delay[i];
+    }
+    return * this;
+}
+
+scheduler_statistics
+this_thread_statistics() noexcept {
+    return context::active()->get_scheduler()->statistics();
+}
+
+scheduler_statistics
+process_statistics() noexcept {
+    scheduler_statistics s;
+    detail::registry & r = detail::registry::instance();
+    detail::spinlock_lock lk{ r.splk };
+    s += r.retired;
+    for ( detail::statistics_counters const& c : r.counters) {
+        c.collect( s);
+    }
+    return s;
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
@@ -22,7 +22,7 @@ namespace fibers {
 bool
 timed_mutex::try_lock_until_( std::chrono::steady_clock::time_point const& timeout_time) noexcept {
     while ( true) {
-        if ( std::chrono::steady_clock::now() > timeout_time) {
+        if ( cached_clock::now() > timeout_time) {
             return false;
         }
         context * active_ctx = context::active();
@@ -88,6 +88,24 @@ timed_mutex::unlock() {
     wait_queue_.notify_one();
 }
 
+void
+timed_mutex::unlock_and_yield() {
+    context * active_ctx = context::active();
+    detail::spinlock_lock lk{ wait_queue_splk_ };
+    if ( BOOST_UNLIKELY( active_ctx != owner_) ) {
+        throw lock_error{
+                std::make_error_code( std::errc::operation_not_permitted),
+                "boost fiber: no  privilege to perform the operation" };
+    }
+    owner_ = nullptr;
+
+    context * ctx = wait_queue_.notify_one_for_handoff();
+    lk.unlock();
+    if ( nullptr != ctx) {
+        active_ctx->handoff( ctx);
+    }
+}
+
 }}
 
 #ifdef BOOST_HAS_ABI_HEADERS
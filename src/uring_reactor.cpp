@@ -0,0 +1,309 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include "boost/fiber/detail/uring_reactor.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+extern "C" {
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+}
+
+#include <boost/assert.hpp>
+
+#include "boost/fiber/context.hpp"
+#include "boost/fiber/detail/spinlock.hpp"
+#include "boost/fiber/exceptions.hpp"
+#include "boost/fiber/type.hpp"
+#include "boost/fiber/waker.hpp"
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace fibers {
+namespace detail {
+
+namespace {
+
+thread_local uring_reactor * current_reactor{ nullptr };
+
+// user_data of the completion entry not belonging to an operation
+constexpr std::uint64_t eventfd_tag = 1;
+
+// lives on the stack of the fiber waiting for the completion
+struct operation {
+    waker           w{};
+    std::int32_t    res{ 0 };
+};
+
+inline
+unsigned load_acquire( unsigned const* p) noexcept {
+    return __atomic_load_n( p, __ATOMIC_ACQUIRE);
+}
+
+inline
+void store_release( unsigned * p, unsigned v) noexcept {
+    __atomic_store_n( p, v, __ATOMIC_RELEASE);
+}
+
+}
+
+uring_reactor *
+uring_reactor::current() noexcept {
+    return current_reactor;
+}
+
+uring_reactor::uring_reactor( unsigned entries) {
+    ::io_uring_params p;
+    std::memset( & p, 0, sizeof( p) );
+    ring_fd_ = static_cast< int >( ::syscall( __NR_io_uring_setup, entries, & p) );
+    if ( BOOST_UNLIKELY( -1 == ring_fd_) ) {
+        throw fiber_error{ std::error_code{ errno, std::system_category() },
+                           "boost fiber: io_uring_setup() failed" };
+    }
+    if ( BOOST_UNLIKELY( 0 == ( p.features & IORING_FEAT_EXT_ARG) ) ) {
+        // pre 5.11 kernel: io_uring_enter() can not wait with a timeout
+        release_();
+        throw fiber_error{ std::make_error_code( std::errc::operation_not_supported),
+                           "boost fiber: io_uring without IORING_FEAT_EXT_ARG" };
+    }
+    sq_size_ = p.sq_off.array + p.sq_entries * sizeof( unsigned);
+    cq_size_ = p.cq_off.cqes + p.cq_entries * sizeof( ::io_uring_cqe);
+    bool single_mmap = 0 != ( p.features & IORING_FEAT_SINGLE_MMAP);
+    if ( single_mmap) {
+        sq_size_ = cq_size_ = (std::max)( sq_size_, cq_size_);
+    }
+    sq_ptr_ = ::mmap( nullptr, sq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring_fd_, IORING_OFF_SQ_RING);
+    if ( BOOST_UNLIKELY( MAP_FAILED == sq_ptr_) ) {
+        int err = errno;
+        sq_ptr_ = nullptr;
+        release_();
+        throw fiber_error{ std::error_code{ err, std::system_category() },
+                           "boost fiber: mmap() of io_uring failed" };
+    }
+    if ( single_mmap) {
+        cq_ptr_ = sq_ptr_;
+    } else {
+        cq_ptr_ = ::mmap( nullptr, cq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          ring_fd_, IORING_OFF_CQ_RING);
+        if ( BOOST_UNLIKELY( MAP_FAILED == cq_ptr_) ) {
+            int err = errno;
+            cq_ptr_ = nullptr;
+            release_();
+            throw fiber_error{ std::error_code{ err, std::system_category() },
+                               "boost fiber: mmap() of io_uring failed" };
+        }
+    }
+    sqes_size_ = p.sq_entries * sizeof( ::io_uring_sqe);
+    void * sqes = ::mmap( nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          ring_fd_, IORING_OFF_SQES);
+    if ( BOOST_UNLIKELY( MAP_FAILED == sqes) ) {
+        int err = errno;
+        release_();
+        throw fiber_error{ std::error_code{ err, std::system_category() },
+                           "boost fiber: mmap() of io_uring failed" };
+    }
+    sqes_ = static_cast< ::io_uring_sqe * >( sqes);
+    char * sq = static_cast< char * >( sq_ptr_);
+    sq_head_ = reinterpret_cast< unsigned * >( sq + p.sq_off.head);
+    sq_tail_ = reinterpret_cast< unsigned * >( sq + p.sq_off.tail);
+    sq_array_ = reinterpret_cast< unsigned * >( sq + p.sq_off.array);
+    sq_mask_ = * reinterpret_cast< unsigned * >( sq + p.sq_off.ring_mask);
+    sq_entries_ = p.sq_entries;
+    sq_local_tail_ = * sq_tail_;
+    char * cq = static_cast< char * >( cq_ptr_);
+    cq_head_ = reinterpret_cast< unsigned * >( cq + p.cq_off.head);
+    cq_tail_ = reinterpret_cast< unsigned * >( cq + p.cq_off.tail);
+    cq_mask_ = * reinterpret_cast< unsigned * >( cq + p.cq_off.ring_mask);
+    cqes_ = reinterpret_cast< ::io_uring_cqe * >( cq + p.cq_off.cqes);
+    // remote notifications complete a pending read of the eventfd
+    efd_ = ::eventfd( 0, EFD_CLOEXEC);
+    if ( BOOST_UNLIKELY( -1 == efd_) ) {
+        int err = errno;
+        release_();
+        throw fiber_error{ std::error_code{ err, std::system_category() },
+                           "boost fiber: eventfd() failed" };
+    }
+    current_reactor = this;
+}
+
+uring_reactor::~uring_reactor() {
+    BOOST_ASSERT( 0 == inflight_);
+    // the algorithm might be released by another thread
+    if ( this == current_reactor) {
+        current_reactor = nullptr;
+    }
+    release_();
+}
+
+void
+uring_reactor::release_() noexcept {
+    // closing the ring cancels the pending read of the eventfd
+    if ( nullptr != sqes_) {
+        ::munmap( sqes_, sqes_size_);
+    }
+    if ( nullptr != cq_ptr_ && cq_ptr_ != sq_ptr_) {
+        ::munmap( cq_ptr_, cq_size_);
+    }
+    if ( nullptr != sq_ptr_) {
+        ::munmap( sq_ptr_, sq_size_);
+    }
+    if ( -1 != ring_fd_) {
+        ::close( ring_fd_);
+    }
+    if ( -1 != efd_) {
+        ::close( efd_);
+    }
+}
+
+::io_uring_sqe *
+uring_reactor::get_sqe_() noexcept {
+    while ( sq_local_tail_ - load_acquire( sq_head_) >= sq_entries_) {
+        // submission queue is full, submit without waiting for completions
+        if ( 0 > enter_( flush_(), 0, 0, nullptr, 0) && EINTR != errno) {
+            // EAGAIN/EBUSY: the kernel has no resources till completions
+            // are reaped, which is done by the dispatcher-context
+            context * active_ctx = context::active();
+            if ( active_ctx->is_context( type::dispatcher_context) ) {
+                reap_();
+            } else {
+                active_ctx->yield();
+            }
+        }
+    }
+    ::io_uring_sqe * sqe = & sqes_[sq_local_tail_ & sq_mask_];
+    sq_array_[sq_local_tail_ & sq_mask_] = sq_local_tail_ & sq_mask_;
+    ++sq_local_tail_;
+    std::memset( sqe, 0, sizeof( ::io_uring_sqe) );
+    return sqe;
+}
+
+unsigned
+uring_reactor::flush_() noexcept {
+    // publish the prepared entries, returns the number of entries not yet
+    // consumed by the kernel
+    store_release( sq_tail_, sq_local_tail_);
+    return sq_local_tail_ - load_acquire( sq_head_);
+}
+
+int
+uring_reactor::enter_( unsigned to_submit, unsigned min_complete, unsigned flags,
+                       void * arg, std::size_t argsz) noexcept {
+    return static_cast< int >(
+        ::syscall( __NR_io_uring_enter, ring_fd_, to_submit, min_complete, flags, arg, argsz) );
+}
+
+void
+uring_reactor::reap_() noexcept {
+    unsigned head = * cq_head_;
+    unsigned const tail = load_acquire( cq_tail_);
+    for ( ; head != tail; ++head) {
+        ::io_uring_cqe const& cqe = cqes_[head & cq_mask_];
+        if ( eventfd_tag == cqe.user_data) {
+            // acquire makes the remote-ready contexts of a notify() that has
+            // found the flag set visible
+            notified_.exchange( false, std::memory_order_acq_rel);
+            efd_armed_ = false;
+            continue;
+        }
+        operation * op = reinterpret_cast< operation * >( static_cast< std::uintptr_t >( cqe.user_data) );
+        op->res = cqe.res;
+        --inflight_;
+        op->w.wake();
+    }
+    store_release( cq_head_, head);
+}
+
+void
+uring_reactor::poll() noexcept {
+    unsigned to_submit = flush_();
+    if ( 0 < to_submit) {
+        enter_( to_submit, 0, 0, nullptr, 0);
+    }
+    reap_();
+}
+
+void
+uring_reactor::run_until( std::chrono::steady_clock::time_point const& time_point) noexcept {
+    if ( ! efd_armed_) {
+        ::io_uring_sqe * sqe = get_sqe_();
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = efd_;
+        sqe->addr = reinterpret_cast< std::uintptr_t >( & efd_value_);
+        sqe->len = sizeof( efd_value_);
+        sqe->user_data = eventfd_tag;
+        efd_armed_ = true;
+    }
+    unsigned flags = IORING_ENTER_GETEVENTS;
+    ::io_uring_getevents_arg arg;
+    std::memset( & arg, 0, sizeof( arg) );
+    void * parg = nullptr;
+    std::size_t argsz = 0;
+    if ( (std::chrono::steady_clock::time_point::max)() != time_point) {
+        // io_uring_enter() returns after `ts_` at the latest (IORING_FEAT_EXT_ARG)
+        std::chrono::nanoseconds d = std::chrono::duration_cast< std::chrono::nanoseconds >(
+                time_point - std::chrono::steady_clock::now() );
+        if ( d < std::chrono::nanoseconds::zero() ) {
+            d = std::chrono::nanoseconds::zero();
+        }
+        ts_.tv_sec = static_cast< long long >( d.count() / 1000000000);
+        ts_.tv_nsec = static_cast< long long >( d.count() % 1000000000);
+        arg.ts = reinterpret_cast< std::uintptr_t >( & ts_);
+        flags |= IORING_ENTER_EXT_ARG;
+        parg = & arg;
+        argsz = sizeof( arg);
+    }
+    // a completion that is already available ends the wait immediately
+    enter_( flush_(), 1, flags, parg, argsz);
+    reap_();
+}
+
+void
+uring_reactor::notify() noexcept {
+    // at most one pending wakeup, spares the write() if the reactor has not
+    // consumed the last one
+    if ( ! notified_.exchange( true, std::memory_order_acq_rel) ) {
+        std::uint64_t value = 1;
+        while ( -1 == ::write( efd_, & value, sizeof( value) ) && EINTR == errno);
+    }
+}
+
+std::int32_t
+uring_reactor::execute( std::uint8_t opcode, int fd, std::uint64_t addr,
+                        std::uint32_t len, std::uint64_t off, std::uint32_t op_flags) {
+    context * active_ctx = context::active();
+    operation op;
+    ::io_uring_sqe * sqe = get_sqe_();
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->addr = addr;
+    sqe->len = len;
+    sqe->off = off;
+    sqe->rw_flags = static_cast< decltype( sqe->rw_flags) >( op_flags);
+    sqe->user_data = reinterpret_cast< std::uintptr_t >( & op);
+    ++inflight_;
+    detail::spinlock splk;
+    detail::spinlock_lock lk{ splk };
+    op.w = active_ctx->create_waker();
+    // submitted by the dispatcher-context together with the entries of the
+    // other fibers
+    active_ctx->suspend( lk);
+    return op.res;
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
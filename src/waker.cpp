@@ -13,6 +13,14 @@ waker::wake() const noexcept {
     return ctx_->wake(epoch_);
 }
 
+bool
+waker::wake_for_handoff( context *& ctx) const noexcept {
+    BOOST_ASSERT(epoch_ > 0);
+    BOOST_ASSERT(ctx_ != nullptr);
+
+    return ctx_->wake_for_handoff( epoch_, ctx);
+}
+
 void
 wait_queue::suspend_and_wait( detail::spinlock_lock & lk, context * active_ctx) {
     waker_with_hook w{ active_ctx->create_waker() };
@@ -66,6 +74,35 @@ wait_queue::notify_all() {
     }
 }
 
+context *
+wait_queue::notify_one_for_handoff() {
+    while ( ! slist_.empty() ) {
+        waker & w = slist_.front();
+        slist_.pop_front();
+        context * ctx = nullptr;
+        if ( w.wake_for_handoff( ctx) ) {
+            return ctx;
+        }
+    }
+    return nullptr;
+}
+
+context *
+wait_queue::notify_all_for_handoff() {
+    context * handoff_ctx = nullptr;
+    while ( ! slist_.empty() ) {
+        waker & w = slist_.front();
+        slist_.pop_front();
+        if ( nullptr == handoff_ctx) {
+            // the first local waiter is resumed directly
+            w.wake_for_handoff( handoff_ctx);
+        } else {
+            w.wake();
+        }
+    }
+    return handoff_ctx;
+}
+
 bool
 wait_queue::empty() const {
     return slist_.empty();
@@ -477,6 +477,28 @@ void test_condition_wait_for_pred() {
     do_test_condition_wait_for_pred();
 }
 
+void test_condition_notify_one_and_yield() {
+    boost::fibers::mutex m;
+    boost::fibers::condition_variable cv;
+    bool ready = false;
+    int consumed = 0;
+    boost::fibers::fiber f( boost::fibers::launch::post, [&](){
+        std::unique_lock< boost::fibers::mutex > lk( m);
+        cv.wait( lk, [&ready](){ return ready; });
+        ++consumed;
+    });
+    // let the fiber block on the condition variable
+    boost::this_fiber::yield();
+    {
+        std::unique_lock< boost::fibers::mutex > lk( m);
+        ready = true;
+    }
+    cv.notify_one_and_yield();
+    // the waiter has run before the notifier was resumed
+    BOOST_CHECK_EQUAL( 1, consumed);
+    f.join();
+}
+
 boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
 {
     boost::unit_test::test_suite * test =
@@ -490,6 +512,7 @@ boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
     test->add( BOOST_TEST_CASE( & test_condition_wait_until_pred) );
     test->add( BOOST_TEST_CASE( & test_condition_wait_for) );
     test->add( BOOST_TEST_CASE( & test_condition_wait_for_pred) );
+    test->add( BOOST_TEST_CASE( & test_condition_notify_one_and_yield) );
 
 	return test;
 }
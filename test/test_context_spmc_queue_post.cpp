@@ -0,0 +1,179 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+#include <boost/fiber/detail/context_spmc_queue.hpp>
+
+constexpr std::size_t min_capacity = BOOST_FIBERS_SPMC_QUEUE_CAPACITY;
+constexpr std::size_t thief_count = 2;
+
+// the queue only stores context pointers and checks them for being pinned;
+// the context of a blocked fiber is not linked to any queue of the scheduler
+template< typename Fn >
+void with_context( Fn && fn) {
+    boost::fibers::context * ctx = nullptr;
+    bool done = false;
+    boost::fibers::mutex mtx;
+    boost::fibers::condition_variable cnd;
+    boost::fibers::fiber f{ [&](){
+        ctx = boost::fibers::context::active();
+        std::unique_lock< boost::fibers::mutex > lk{ mtx };
+        cnd.wait( lk, [&done](){ return done; });
+    }};
+    boost::this_fiber::yield();
+    BOOST_REQUIRE( nullptr != ctx);
+    BOOST_REQUIRE( ! ctx->is_pinned() );
+    fn( ctx);
+    {
+        std::unique_lock< boost::fibers::mutex > lk{ mtx };
+        done = true;
+    }
+    cnd.notify_all();
+    f.join();
+}
+
+// pops with low occupancy, the queue shrinks after as many pops as it has
+// slots; returns the number of pops
+std::size_t drain( boost::fibers::detail::context_spmc_queue & q, std::size_t capacity) {
+    std::size_t pops = 0;
+    while ( min_capacity < q.capacity() && pops < 4 * capacity) {
+        BOOST_CHECK( nullptr == q.pop() );
+        ++pops;
+    }
+    return pops;
+}
+
+void test_grow_while_stealing() {
+    with_context( [](boost::fibers::context * ctx){
+        constexpr std::size_t count = 8 * min_capacity;
+        boost::fibers::detail::context_spmc_queue q;
+        BOOST_CHECK_EQUAL( min_capacity, q.capacity() );
+        std::atomic< bool > done{ false };
+        std::atomic< std::size_t > stolen{ 0 };
+        // Boost.Test is not thread-safe, thieves only count the foreign
+        // contexts, checked by the main thread
+        std::atomic< std::size_t > foreign{ 0 };
+        std::vector< std::thread > thieves;
+        for ( std::size_t i = 0; i < thief_count; ++i) {
+            thieves.emplace_back( [&,i](){
+                boost::fibers::context * batch[16];
+                while ( ! done.load() || ! q.empty() ) {
+                    // single and batch steals race with the owner
+                    std::size_t n = 0;
+                    if ( 0 == i) {
+                        n = nullptr != q.steal() ? 1 : 0;
+                    } else {
+                        n = q.steal_half( batch, 16);
+                        for ( std::size_t j = 0; j < n; ++j) {
+                            if ( ctx != batch[j]) {
+                                ++foreign;
+                            }
+                        }
+                    }
+                    stolen += n;
+                }
+            });
+        }
+        std::size_t popped = 0;
+        std::size_t max_capacity = q.capacity();
+        for ( std::size_t i = 0; i < count; ++i) {
+            q.push( ctx);
+            if ( max_capacity < q.capacity() ) {
+                max_capacity = q.capacity();
+            }
+            // the owner consumes some contexts, too
+            if ( 0 == i % 7 && nullptr != q.pop() ) {
+                ++popped;
+            }
+        }
+        BOOST_CHECK( min_capacity < max_capacity);
+        while ( ! q.empty() ) {
+            if ( nullptr != q.pop() ) {
+                ++popped;
+            }
+        }
+        done = true;
+        for ( std::thread & t : thieves) {
+            t.join();
+        }
+        BOOST_CHECK_EQUAL( std::size_t{ 0 }, foreign.load() );
+        // each context pushed was taken exactly once
+        BOOST_CHECK_EQUAL( count, popped + stolen.load() );
+        BOOST_CHECK( q.empty() );
+    });
+}
+
+void test_reclaim_after_quiesce() {
+    with_context( [](boost::fibers::context * ctx){
+        boost::fibers::detail::context_spmc_queue q;
+        std::atomic< bool > done{ false };
+        std::thread thief{ [&](){
+            while ( ! done.load() ) {
+                q.steal();
+            }
+        }};
+        for ( std::size_t i = 0; i < 4 * min_capacity; ++i) {
+            q.push( ctx);
+        }
+        // outgrown arrays are kept till the thieves have left them
+        BOOST_CHECK( 0 < q.retired() );
+        done = true;
+        thief.join();
+        // without readers the epoch advances on each pop, an array is
+        // released two epochs after it has been retired
+        for ( int i = 0; i < 3 && 0 < q.retired(); ++i) {
+            q.pop();
+        }
+        BOOST_CHECK_EQUAL( std::size_t{ 0 }, q.retired() );
+        while ( nullptr != q.pop() ) {
+        }
+    });
+}
+
+void test_shrink_after_drain() {
+    with_context( [](boost::fibers::context * ctx){
+        boost::fibers::detail::context_spmc_queue q;
+        for ( std::size_t i = 0; i < 4 * min_capacity; ++i) {
+            q.push( ctx);
+        }
+        std::size_t capacity = q.capacity();
+        BOOST_CHECK( 4 * min_capacity <= capacity);
+        std::size_t popped = 0;
+        while ( nullptr != q.pop() ) {
+            ++popped;
+        }
+        BOOST_CHECK_EQUAL( 4 * min_capacity, popped);
+        // halved repeatedly, never below the initial capacity
+        std::size_t pops = drain( q, capacity);
+        BOOST_CHECK_EQUAL( min_capacity, q.capacity() );
+        BOOST_CHECK( pops < 4 * capacity);
+        for ( int i = 0; i < 3 && 0 < q.retired(); ++i) {
+            q.pop();
+        }
+        BOOST_CHECK_EQUAL( std::size_t{ 0 }, q.retired() );
+        // still usable after shrinking
+        q.push( ctx);
+        BOOST_CHECK( ctx == q.pop() );
+        BOOST_CHECK( q.empty() );
+    });
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: context_spmc_queue test suite");
+
+    test->add( BOOST_TEST_CASE( & test_grow_while_stealing) );
+    test->add( BOOST_TEST_CASE( & test_reclaim_after_quiesce) );
+    test->add( BOOST_TEST_CASE( & test_shrink_after_drain) );
+
+    return test;
+}
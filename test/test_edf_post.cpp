@@ -0,0 +1,213 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+#include "test_utils.hpp"
+
+typedef std::chrono::milliseconds ms;
+typedef std::chrono::steady_clock clock_type;
+
+boost::fibers::fiber launch( clock_type::time_point const& deadline, std::string & trace, char c, int n) {
+    boost::fibers::fiber f{ boost::fibers::launch::post, [&trace,c,n](){
+        for ( int i = 0; i < n; ++i) {
+            if ( 0 < i) {
+                boost::this_fiber::yield();
+            }
+            trace += c;
+        }
+    }};
+    f.properties< boost::fibers::algo::edf_props >().set_deadline( deadline);
+    return f;
+}
+
+void test_edf_order() {
+    run_with_algorithm< boost::fibers::algo::edf >( [](){
+        std::string trace;
+        clock_type::time_point now = clock_type::now();
+        std::vector< boost::fibers::fiber > fibers;
+        fibers.push_back( launch( now + ms( 30), trace, 'a', 1) );
+        fibers.push_back( launch( now + ms( 10), trace, 'b', 1) );
+        fibers.push_back( launch( now + ms( 20), trace, 'c', 1) );
+        fibers.push_back( launch( (clock_type::time_point::max)(), trace, 'd', 1) );
+        for ( boost::fibers::fiber & f : fibers) {
+            f.join();
+        }
+        BOOST_CHECK_EQUAL( std::string{ "bcad" }, trace);
+    });
+}
+
+void test_edf_fifo() {
+    run_with_algorithm< boost::fibers::algo::edf >( [](){
+        std::string trace;
+        clock_type::time_point deadline = clock_type::now() + ms( 10);
+        std::vector< boost::fibers::fiber > fibers;
+        fibers.push_back( launch( deadline, trace, 'a', 2) );
+        fibers.push_back( launch( deadline, trace, 'b', 2) );
+        fibers.push_back( launch( deadline, trace, 'c', 2) );
+        for ( boost::fibers::fiber & f : fibers) {
+            f.join();
+        }
+        // equal deadlines are scheduled round-robin
+        BOOST_CHECK_EQUAL( std::string{ "abcabc" }, trace);
+    });
+}
+
+void test_edf_change() {
+    run_with_algorithm< boost::fibers::algo::edf >( [](){
+        std::string trace;
+        clock_type::time_point now = clock_type::now();
+        boost::fibers::fiber f1 = launch( now + ms( 10), trace, 'a', 1);
+        boost::fibers::fiber f2 = launch( now + ms( 20), trace, 'b', 1);
+        // move the deadline of a ready fiber
+        f1.properties< boost::fibers::algo::edf_props >().set_deadline( ms( 30) );
+        f1.join();
+        f2.join();
+        BOOST_CHECK_EQUAL( std::string{ "ba" }, trace);
+    });
+}
+
+void test_edf_sleep() {
+    run_with_algorithm< boost::fibers::algo::edf >( [](){
+        // a fiber with an expired deadline yielding in a loop does not
+        // starve the dispatcher (sleeping fibers)
+        bool done = false;
+        boost::fibers::fiber f1{ boost::fibers::launch::post, [&done](){
+            boost::this_fiber::sleep_for( ms( 5) );
+            done = true;
+        }};
+        boost::fibers::fiber f2{ boost::fibers::launch::post, [&done](){
+            while ( ! done) {
+                boost::this_fiber::yield();
+            }
+        }};
+        clock_type::time_point now = clock_type::now();
+        f1.properties< boost::fibers::algo::edf_props >().set_deadline( now);
+        f2.properties< boost::fibers::algo::edf_props >().set_deadline( now + ms( 1) );
+        f1.join();
+        f2.join();
+        BOOST_CHECK( done);
+    });
+}
+
+constexpr std::uint32_t thread_count = 4;
+constexpr int fiber_count = 200;
+
+void test_edf_work_stealing() {
+    std::atomic< int > count{ 0 };
+    boost::fibers::mutex mtx;
+    boost::fibers::condition_variable cnd;
+    auto worker = [&mtx,&cnd,&count](){
+        boost::fibers::use_scheduling_algorithm< boost::fibers::algo::edf_work_stealing >( thread_count);
+        std::unique_lock< boost::fibers::mutex > lk{ mtx };
+        cnd.wait( lk, [&count](){ return fiber_count == count.load(); });
+    };
+    std::vector< std::thread > threads;
+    for ( std::uint32_t i = 1; i < thread_count; ++i) {
+        threads.emplace_back( worker);
+    }
+    boost::fibers::use_scheduling_algorithm< boost::fibers::algo::edf_work_stealing >( thread_count);
+    clock_type::time_point now = clock_type::now();
+    std::vector< boost::fibers::fiber > fibers;
+    for ( int i = 0; i < fiber_count; ++i) {
+        boost::fibers::fiber f{ boost::fibers::launch::post, [&mtx,&cnd,&count,now,i](){
+            // the fiber is stealable as soon as it is launched, hence only
+            // the fiber itself may change its deadline
+            boost::this_fiber::properties< boost::fibers::algo::edf_props >().set_deadline( now + ms( i) );
+            boost::this_fiber::yield();
+            if ( fiber_count == ++count) {
+                std::unique_lock< boost::fibers::mutex > lk{ mtx };
+                lk.unlock();
+                cnd.notify_all();
+            }
+        }};
+        fibers.push_back( std::move( f) );
+    }
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+    {
+        std::unique_lock< boost::fibers::mutex > lk{ mtx };
+        cnd.wait( lk, [&count](){ return fiber_count == count.load(); });
+    }
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+    BOOST_CHECK_EQUAL( fiber_count, count.load() );
+}
+
+// pools are independent of each other, a process might run one after the other
+void test_edf_work_stealing_pool() {
+    for ( int round = 0; round < 2; ++round) {
+        auto pool = std::make_shared< boost::fibers::algo::edf_work_stealing_pool >( thread_count);
+        BOOST_CHECK_EQUAL( thread_count, pool->thread_count() );
+        std::atomic< int > count{ 0 };
+        std::mutex threads_mtx;
+        std::set< std::thread::id > thread_ids;
+        boost::fibers::mutex mtx;
+        boost::fibers::condition_variable cnd;
+        std::vector< std::thread > threads;
+        for ( std::uint32_t i = 0; i < thread_count; ++i) {
+            threads.emplace_back( [&,i](){
+                // idle threads park till a peer has stealable fibers
+                boost::fibers::use_scheduling_algorithm< boost::fibers::algo::edf_work_stealing >( pool, true);
+                if ( 0 == i) {
+                    clock_type::time_point now = clock_type::now();
+                    for ( int j = 0; j < fiber_count; ++j) {
+                        boost::fibers::fiber f{ [&,now,j](){
+                            boost::this_fiber::properties< boost::fibers::algo::edf_props >().set_deadline( now + ms( j) );
+                            // block the thread, the idle peers steal
+                            std::this_thread::sleep_for( std::chrono::microseconds( 100) );
+                            boost::this_fiber::yield();
+                            {
+                                std::unique_lock< std::mutex > lk{ threads_mtx };
+                                thread_ids.insert( std::this_thread::get_id() );
+                            }
+                            if ( fiber_count == ++count) {
+                                std::unique_lock< boost::fibers::mutex > lk{ mtx };
+                                lk.unlock();
+                                cnd.notify_all();
+                            }
+                        }};
+                        f.detach();
+                    }
+                }
+                std::unique_lock< boost::fibers::mutex > lk{ mtx };
+                cnd.wait( lk, [&](){ return fiber_count == count.load(); });
+            });
+        }
+        for ( std::thread & t : threads) {
+            t.join();
+        }
+        BOOST_CHECK_EQUAL( fiber_count, count.load() );
+        BOOST_CHECK( 1 < thread_ids.size() );
+    }
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: edf test suite");
+
+    test->add( BOOST_TEST_CASE( & test_edf_order) );
+    test->add( BOOST_TEST_CASE( & test_edf_fifo) );
+    test->add( BOOST_TEST_CASE( & test_edf_change) );
+    test->add( BOOST_TEST_CASE( & test_edf_sleep) );
+    test->add( BOOST_TEST_CASE( & test_edf_work_stealing) );
+    test->add( BOOST_TEST_CASE( & test_edf_work_stealing_pool) );
+
+    return test;
+}
@@ -0,0 +1,222 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+#include <boost/fiber/epoll.hpp>
+
+#include "test_utils.hpp"
+
+typedef std::chrono::milliseconds ms;
+
+void test_wait_readable() {
+    run_with_algorithm< boost::fibers::algo::epoll_round_robin >( [](){
+        int fds[2];
+        BOOST_REQUIRE( 0 == ::pipe( fds) );
+        char c = 0;
+        bool readable = false;
+        boost::fibers::fiber f1{ boost::fibers::launch::post, [&](){
+            boost::this_fiber::wait_readable( fds[0]);
+            readable = true;
+            BOOST_CHECK( 1 == ::read( fds[0], & c, 1) );
+        }};
+        boost::fibers::fiber f2{ boost::fibers::launch::post, [&](){
+            boost::this_fiber::sleep_for( ms( 10) );
+            BOOST_CHECK( ! readable);
+            BOOST_CHECK( 1 == ::write( fds[1], "x", 1) );
+        }};
+        f1.join();
+        f2.join();
+        BOOST_CHECK( readable);
+        BOOST_CHECK_EQUAL( 'x', c);
+        ::close( fds[0]);
+        ::close( fds[1]);
+    });
+}
+
+void test_wait_readable_timeout() {
+    run_with_algorithm< boost::fibers::algo::epoll_round_robin >( [](){
+        int fds[2];
+        BOOST_REQUIRE( 0 == ::pipe( fds) );
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        BOOST_CHECK( ! boost::this_fiber::wait_readable( fds[0], ms( 20) ) );
+        BOOST_CHECK( std::chrono::steady_clock::now() - start >= ms( 20) );
+        // the descriptor can be waited for again
+        BOOST_CHECK( 1 == ::write( fds[1], "x", 1) );
+        BOOST_CHECK( boost::this_fiber::wait_readable( fds[0], ms( 1000) ) );
+        ::close( fds[0]);
+        ::close( fds[1]);
+    });
+}
+
+void test_forget_descriptor() {
+    run_with_algorithm< boost::fibers::algo::epoll_round_robin >( [](){
+        int fds[2];
+        BOOST_REQUIRE( 0 == ::pipe( fds) );
+        BOOST_CHECK( ! boost::this_fiber::wait_readable( fds[0], ms( 10) ) );
+        boost::this_fiber::forget_descriptor( fds[0]);
+        ::close( fds[0]);
+        ::close( fds[1]);
+        // the descriptor numbers are reused
+        BOOST_REQUIRE( 0 == ::pipe( fds) );
+        bool readable = false;
+        boost::fibers::fiber f{ boost::fibers::launch::post, [&](){
+            readable = boost::this_fiber::wait_readable( fds[0], ms( 10000) );
+        }};
+        boost::this_fiber::yield();
+        // the fiber waits for the descriptor
+        bool thrown = false;
+        try {
+            boost::this_fiber::forget_descriptor( fds[0]);
+        } catch ( boost::fibers::fiber_error const& e) {
+            thrown = true;
+            BOOST_CHECK( std::errc::device_or_resource_busy == e.code() );
+        }
+        BOOST_CHECK( thrown);
+        BOOST_CHECK( 1 == ::write( fds[1], "x", 1) );
+        f.join();
+        BOOST_CHECK( readable);
+        boost::this_fiber::forget_descriptor( fds[0]);
+        ::close( fds[0]);
+        ::close( fds[1]);
+    });
+}
+
+void test_wait_writable() {
+    run_with_algorithm< boost::fibers::algo::epoll_round_robin >( [](){
+        int fds[2];
+        BOOST_REQUIRE( 0 == ::pipe( fds) );
+        BOOST_CHECK( boost::this_fiber::wait_writable( fds[1], ms( 1000) ) );
+        boost::this_fiber::wait_writable( fds[1]);
+        ::close( fds[0]);
+        ::close( fds[1]);
+    });
+}
+
+void test_remote_notify() {
+    run_with_algorithm< boost::fibers::algo::epoll_round_robin >( [](){
+        boost::fibers::promise< int > p;
+        boost::fibers::future< int > f = p.get_future();
+        // the thread blocks in epoll_wait() till the eventfd is signaled
+        std::thread t{ [&p](){
+            std::this_thread::sleep_for( ms( 10) );
+            p.set_value( 7);
+        }};
+        BOOST_CHECK_EQUAL( 7, f.get() );
+        t.join();
+    });
+}
+
+// fibers waiting for descriptors must not be stolen before they have left
+// the descriptor table of the reactor they are registered with
+void test_work_stealing_wait() {
+    constexpr std::uint32_t thread_count = 3;
+    constexpr int fiber_count = 64;
+    auto pool = std::make_shared< boost::fibers::algo::work_stealing_pool >( thread_count);
+    std::vector< std::array< int, 2 > > pipes( fiber_count);
+    for ( std::array< int, 2 > & fds : pipes) {
+        BOOST_REQUIRE( 0 == ::pipe( fds.data() ) );
+    }
+    std::atomic< int > waiting{ 0 }, count{ 0 }, readable{ 0 }, timeouts{ 0 }, moved{ 0 }, pinned{ 0 };
+    boost::fibers::mutex mtx;
+    boost::fibers::condition_variable cnd;
+    std::vector< std::thread > threads;
+    for ( std::uint32_t i = 0; i < thread_count; ++i) {
+        threads.emplace_back( [&,i](){
+            boost::fibers::use_scheduling_algorithm< boost::fibers::algo::epoll_work_stealing >( pool);
+            if ( 0 == i) {
+                for ( int j = 0; j < fiber_count; ++j) {
+                    boost::fibers::fiber{ [&,j](){
+                        // every other descriptor becomes readable
+                        bool write = 0 == j % 2;
+                        std::thread::id id = std::this_thread::get_id();
+                        ++waiting;
+                        bool ready = boost::this_fiber::wait_readable( pipes[j][0], ms( write ? 10000 : 20) );
+                        if ( id != std::this_thread::get_id() ) {
+                            ++moved;
+                        }
+                        if ( boost::fibers::context::active()->thread_affinity() ) {
+                            ++pinned;
+                        }
+                        ++( ready ? readable : timeouts);
+                        BOOST_CHECK_EQUAL( write, ready);
+                        // keep the thread busy, the peers steal the other
+                        // fibers woken together with this one
+                        std::this_thread::sleep_for( std::chrono::microseconds( 100) );
+                        boost::this_fiber::yield();
+                        if ( fiber_count == ++count) {
+                            std::unique_lock< boost::fibers::mutex > lk{ mtx };
+                            lk.unlock();
+                            cnd.notify_all();
+                        }
+                    }}.detach();
+                }
+                // wakes half of the fibers at once
+                while ( fiber_count != waiting.load() ) {
+                    boost::this_fiber::yield();
+                }
+                for ( int j = 0; j < fiber_count; j += 2) {
+                    BOOST_CHECK( 1 == ::write( pipes[j][1], "x", 1) );
+                }
+            }
+            std::unique_lock< boost::fibers::mutex > lk{ mtx };
+            cnd.wait( lk, [&](){ return fiber_count == count.load(); });
+        });
+    }
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+    for ( std::array< int, 2 > & fds : pipes) {
+        ::close( fds[0]);
+        ::close( fds[1]);
+    }
+    BOOST_CHECK_EQUAL( fiber_count / 2, readable.load() );
+    BOOST_CHECK_EQUAL( fiber_count / 2, timeouts.load() );
+    // resumed by the thread of the reactor, affinity restored afterwards
+    BOOST_CHECK_EQUAL( 0, moved.load() );
+    BOOST_CHECK_EQUAL( 0, pinned.load() );
+}
+
+void test_wrong_algorithm() {
+    int fds[2];
+    BOOST_REQUIRE( 0 == ::pipe( fds) );
+    bool thrown = false;
+    try {
+        boost::this_fiber::wait_readable( fds[0], ms( 10) );
+    } catch ( boost::fibers::fiber_error const& e) {
+        thrown = true;
+        BOOST_CHECK( std::errc::operation_not_supported == e.code() );
+    }
+    BOOST_CHECK( thrown);
+    ::close( fds[0]);
+    ::close( fds[1]);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: epoll test suite");
+
+    test->add( BOOST_TEST_CASE( & test_wait_readable) );
+    test->add( BOOST_TEST_CASE( & test_wait_readable_timeout) );
+    test->add( BOOST_TEST_CASE( & test_forget_descriptor) );
+    test->add( BOOST_TEST_CASE( & test_wait_writable) );
+    test->add( BOOST_TEST_CASE( & test_remote_notify) );
+    test->add( BOOST_TEST_CASE( & test_work_stealing_wait) );
+    test->add( BOOST_TEST_CASE( & test_wrong_algorithm) );
+
+    return test;
+}
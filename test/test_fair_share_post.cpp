@@ -0,0 +1,142 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+#include "test_utils.hpp"
+
+typedef std::chrono::milliseconds ms;
+typedef std::chrono::microseconds us;
+typedef std::chrono::steady_clock clock_type;
+
+// spins in slices of 50us till `end`
+boost::fibers::fiber spin( std::uint32_t group, clock_type::time_point const& end) {
+    boost::fibers::fiber f{ boost::fibers::launch::post, [end](){
+        while ( clock_type::now() < end) {
+            clock_type::time_point slice = clock_type::now() + us( 50);
+            while ( clock_type::now() < slice) {
+            }
+            boost::this_fiber::yield();
+        }
+    }};
+    f.properties< boost::fibers::algo::fair_share_props >().set_group( group);
+    return f;
+}
+
+double ratio( boost::fibers::algo::fair_share * algo, std::uint32_t g1, std::uint32_t g2) {
+    return static_cast< double >( algo->get_runtime( g1).count() ) /
+           static_cast< double >( algo->get_runtime( g2).count() );
+}
+
+void test_fair_share_groups() {
+    run_with_algorithm< boost::fibers::algo::fair_share >( [](){
+        boost::fibers::algo::fair_share * algo = boost::fibers::algo::fair_share::current();
+        BOOST_REQUIRE( nullptr != algo);
+        BOOST_CHECK_EQUAL( std::size_t{ 1 }, algo->group_count() );
+        std::uint32_t g = algo->create_group( 2048);
+        BOOST_CHECK_EQUAL( std::uint32_t{ 1 }, g);
+        BOOST_CHECK_EQUAL( std::uint32_t{ 2048 }, algo->get_weight( g) );
+        algo->set_weight( g, 0);
+        BOOST_CHECK_EQUAL( std::uint32_t{ 1 }, algo->get_weight( g) );
+        BOOST_CHECK_THROW( algo->set_weight( 7, 1024), boost::fibers::fiber_error);
+        BOOST_CHECK_THROW( algo->get_runtime( 7), boost::fibers::fiber_error);
+    });
+    // other algorithms
+    std::thread t{ [](){
+        boost::fibers::use_scheduling_algorithm< boost::fibers::algo::round_robin >();
+        BOOST_CHECK( nullptr == boost::fibers::algo::fair_share::current() );
+    }};
+    t.join();
+}
+
+void test_fair_share_burst() {
+    run_with_algorithm< boost::fibers::algo::fair_share >( [](){
+        // one group with many fibers does not starve a group of equal weight
+        boost::fibers::algo::fair_share * algo = boost::fibers::algo::fair_share::current();
+        std::uint32_t g1 = algo->create_group();
+        std::uint32_t g2 = algo->create_group();
+        clock_type::time_point end = clock_type::now() + ms( 100);
+        std::vector< boost::fibers::fiber > fibers;
+        for ( int i = 0; i < 8; ++i) {
+            fibers.push_back( spin( g1, end) );
+        }
+        fibers.push_back( spin( g2, end) );
+        for ( boost::fibers::fiber & f : fibers) {
+            f.join();
+        }
+        double r = ratio( algo, g1, g2);
+        BOOST_CHECK_MESSAGE( 0.7 < r && r < 1.4, "runtime ratio " << r);
+    });
+}
+
+void test_fair_share_weight() {
+    run_with_algorithm< boost::fibers::algo::fair_share >( [](){
+        boost::fibers::algo::fair_share * algo = boost::fibers::algo::fair_share::current();
+        std::uint32_t g1 = algo->create_group( 3072);
+        std::uint32_t g2 = algo->create_group( 1024);
+        clock_type::time_point end = clock_type::now() + ms( 100);
+        boost::fibers::fiber f1 = spin( g1, end);
+        boost::fibers::fiber f2 = spin( g2, end);
+        f1.join();
+        f2.join();
+        double r = ratio( algo, g1, g2);
+        BOOST_CHECK_MESSAGE( 2. < r && r < 4.5, "runtime ratio " << r);
+    });
+}
+
+void test_fair_share_change_group() {
+    run_with_algorithm< boost::fibers::algo::fair_share >( [](){
+        boost::fibers::algo::fair_share * algo = boost::fibers::algo::fair_share::current();
+        std::uint32_t g1 = algo->create_group();
+        std::uint32_t g2 = algo->create_group();
+        clock_type::time_point end = clock_type::now() + ms( 5);
+        boost::fibers::fiber f = spin( g1, end);
+        // move a ready fiber to another group
+        f.properties< boost::fibers::algo::fair_share_props >().set_group( g2);
+        f.join();
+        BOOST_CHECK( algo->get_runtime( g1) < ms( 1) );
+        BOOST_CHECK( algo->get_runtime( g2) >= ms( 4) );
+    });
+}
+
+void test_fair_share_sleep() {
+    run_with_algorithm< boost::fibers::algo::fair_share >( [](){
+        // yielding fibers do not starve sleeping fibers
+        bool done = false;
+        boost::fibers::fiber f1{ boost::fibers::launch::post, [&done](){
+            boost::this_fiber::sleep_for( ms( 5) );
+            done = true;
+        }};
+        boost::fibers::fiber f2{ boost::fibers::launch::post, [&done](){
+            while ( ! done) {
+                boost::this_fiber::yield();
+            }
+        }};
+        f1.join();
+        f2.join();
+        BOOST_CHECK( done);
+    });
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: fair-share test suite");
+
+    test->add( BOOST_TEST_CASE( & test_fair_share_groups) );
+    test->add( BOOST_TEST_CASE( & test_fair_share_burst) );
+    test->add( BOOST_TEST_CASE( & test_fair_share_weight) );
+    test->add( BOOST_TEST_CASE( & test_fair_share_change_group) );
+    test->add( BOOST_TEST_CASE( & test_fair_share_sleep) );
+
+    return test;
+}
@@ -7,14 +7,18 @@
 // This test is based on the tests of Boost.Thread
 
 #include <chrono>
+#include <cstdint>
 #include <mutex>
+#include <set>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include <boost/assert.hpp>
 #include <boost/test/unit_test.hpp>
 
 #include <boost/fiber/all.hpp>
+#include <boost/fiber/detail/context_layout.hpp>
 
 int value1 = 0;
 std::string value2 = "";
@@ -392,6 +396,93 @@ void test_sleep_until() {
     }
 }
 
+void test_sleep_timer_wheel() {
+    typedef std::chrono::steady_clock Clock;
+    boost::fibers::use_timer_wheel( std::chrono::milliseconds(1) );
+    std::vector< boost::fibers::fiber > fibers;
+    int expired = 0;
+    for ( int i = 0; i < 64; ++i) {
+        fibers.emplace_back( boost::fibers::launch::post, [i,&expired](){
+            // spread deadlines over several levels of the wheel
+            std::chrono::milliseconds ms( ( i * 37) % 300);
+            Clock::time_point t0 = Clock::now();
+            boost::this_fiber::sleep_until( t0 + ms);
+            if ( Clock::now() >= t0 + ms) {
+                ++expired;
+            }
+        });
+    }
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+    BOOST_CHECK_EQUAL( 64, expired);
+    // restore sleep-queue
+    boost::fibers::use_timer_wheel( std::chrono::milliseconds(0) );
+    Clock::time_point t0 = Clock::now();
+    boost::this_fiber::sleep_for( std::chrono::milliseconds(10) );
+    BOOST_CHECK( Clock::now() >= t0 + std::chrono::milliseconds(10) );
+}
+
+void test_cached_clock() {
+    typedef boost::fibers::cached_clock Clock;
+    Clock::time_point t0 = Clock::now();
+    BOOST_CHECK( t0 <= std::chrono::steady_clock::now() );
+    boost::this_fiber::sleep_for( std::chrono::milliseconds(10) );
+    // refreshed by the dispatcher-context that has woken up this fiber
+    Clock::time_point t1 = Clock::now();
+    BOOST_CHECK( t1 >= t0 + std::chrono::milliseconds(10) );
+    BOOST_CHECK( t1 <= std::chrono::steady_clock::now() );
+}
+
+void test_stack_cache() {
+    boost::fibers::use_stack_cache( 4, 2);
+    int sum = 0;
+    for ( int i = 0; i < 32; ++i) {
+        // stacks of different allocators and sizes must not be mixed
+        if ( 0 == i % 2) {
+            boost::fibers::fiber f( boost::fibers::launch::post,
+                    std::allocator_arg, boost::fibers::fixedsize_stack( 64 * 1024),
+                    [&sum](){ char buf[32 * 1024]; buf[0] = 1; sum += buf[0]; });
+            f.join();
+        } else {
+            boost::fibers::fiber f( boost::fibers::launch::post,
+                    std::allocator_arg, boost::fibers::protected_fixedsize_stack(),
+                    [&sum](){ ++sum; });
+            f.join();
+        }
+        boost::this_fiber::yield();
+    }
+    BOOST_CHECK_EQUAL( 32, sum);
+    boost::fibers::use_stack_cache( 0, 0);
+}
+
+void test_sleep_timer_wheel_boundary() {
+    typedef std::chrono::steady_clock Clock;
+    // the wheel starts 2000 ticks before the 64^6 (2^36) tick boundary,
+    // the deadlines lie on both sides of it
+    std::chrono::microseconds tick( 1);
+    boost::fibers::context::active()->get_scheduler()->use_timer_wheel(
+        tick, Clock::now() - tick * ( ( static_cast< std::int64_t >( 1) << 36) - 2000) );
+    std::vector< boost::fibers::fiber > fibers;
+    int expired = 0;
+    for ( int i = 1; i <= 5; ++i) {
+        fibers.emplace_back( boost::fibers::launch::post, [i,&expired](){
+            std::chrono::milliseconds ms( i);
+            Clock::time_point t0 = Clock::now();
+            boost::this_fiber::sleep_until( t0 + ms);
+            Clock::time_point t1 = Clock::now();
+            if ( t1 >= t0 + ms && t1 < t0 + ms + std::chrono::seconds( 1) ) {
+                ++expired;
+            }
+        });
+    }
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+    BOOST_CHECK_EQUAL( 5, expired);
+    boost::fibers::use_timer_wheel( std::chrono::milliseconds(0) );
+}
+
 void do_wait( boost::fibers::barrier* b) {
     b->wait();
 }
@@ -418,6 +509,33 @@ void test_detach() {
     }
 }
 
+void test_context_layout() {
+    typedef boost::fibers::detail::context_layout   layout;
+    boost::fibers::fiber f( boost::fibers::launch::post, [](){
+        boost::fibers::context * ctx = boost::fibers::context::active();
+        std::set< std::uintptr_t > lines[4];
+        for ( layout::member const& m : layout::members( ctx) ) {
+            std::uintptr_t first = ( reinterpret_cast< std::uintptr_t >( ctx) + m.offset) / cacheline_length;
+            std::uintptr_t last = ( reinterpret_cast< std::uintptr_t >( ctx) + m.offset + m.size - 1) / cacheline_length;
+            for ( std::uintptr_t l = first; l <= last; ++l) {
+                lines[static_cast< int >( m.grp)].insert( l);
+            }
+        }
+        // switch path touches exactly one cacheline
+        BOOST_CHECK_EQUAL( 1u, lines[static_cast< int >( layout::group::hot)].size() );
+        // members written by other threads do not share a cacheline with the
+        // hot members nor with each other
+        for ( int i = 0; i < 3; ++i) {
+            for ( int j = i + 1; j < 3; ++j) {
+                for ( std::uintptr_t l : lines[i]) {
+                    BOOST_CHECK( 0 == lines[j].count( l) );
+                }
+            }
+        }
+    });
+    f.join();
+}
+
 boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
     boost::unit_test::test_suite * test =
         BOOST_TEST_SUITE("Boost.Fiber: fiber test suite");
@@ -434,7 +552,12 @@ boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
     test->add( BOOST_TEST_CASE( & test_yield) );
     test->add( BOOST_TEST_CASE( & test_sleep_for) );
     test->add( BOOST_TEST_CASE( & test_sleep_until) );
+    test->add( BOOST_TEST_CASE( & test_sleep_timer_wheel) );
+    test->add( BOOST_TEST_CASE( & test_sleep_timer_wheel_boundary) );
+    test->add( BOOST_TEST_CASE( & test_cached_clock) );
+    test->add( BOOST_TEST_CASE( & test_stack_cache) );
     test->add( BOOST_TEST_CASE( & test_detach) );
+    test->add( BOOST_TEST_CASE( & test_context_layout) );
 
     return test;
 }
@@ -6,7 +6,9 @@
 //  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 
 #include <iostream>
+#include <memory>
 #include <mutex>
+#include <vector>
 
 #include <boost/test/unit_test.hpp>
 
@@ -222,6 +224,69 @@ void test_fss_at_the_same_adress() {
     boost::fibers::fiber( boost::fibers::launch::post, fss_at_the_same_adress).join();
 }
 
+int counted_cleanups = 0;
+
+void counted_cleanup(int* i) {
+    delete i;
+    ++counted_cleanups;
+}
+
+void fss_many_keys() {
+    // more keys than slots kept inline in the context
+    constexpr int n = 3 * BOOST_FIBERS_FSS_INLINE_SLOTS + 1;
+    std::vector< std::unique_ptr< boost::fibers::fiber_specific_ptr<int> > > keys;
+    for (int i=0; i<n; ++i) {
+        keys.emplace_back( new boost::fibers::fiber_specific_ptr<int>(counted_cleanup));
+    }
+    counted_cleanups = 0;
+    boost::fibers::fiber f( boost::fibers::launch::post, [&keys](){
+        for (int i=0; i<n; ++i) {
+            BOOST_CHECK(!keys[i]->get());
+            keys[i]->reset(new int(i));
+        }
+        for (int i=0; i<n; ++i) {
+            BOOST_CHECK_EQUAL(i, *keys[i]->get());
+        }
+    });
+    f.join();
+    // values released at termination
+    BOOST_CHECK_EQUAL(n, counted_cleanups);
+    for (int i=0; i<n; ++i) {
+        BOOST_CHECK(!keys[i]->get());
+    }
+}
+
+void test_fss_many_keys() {
+    boost::fibers::fiber( boost::fibers::launch::post, fss_many_keys).join();
+}
+
+void fss_slot_reused() {
+    std::unique_ptr< boost::fibers::fiber_specific_ptr<int> > key1{
+        new boost::fibers::fiber_specific_ptr<int>(counted_cleanup) };
+    std::unique_ptr< boost::fibers::fiber_specific_ptr<int> > key2;
+    counted_cleanups = 0;
+    boost::fibers::fiber f( boost::fibers::launch::post, [&key1,&key2](){
+        key1->reset(new int(1));
+        boost::this_fiber::yield();
+        // the slot of key1 might have been passed to key2
+        BOOST_CHECK(!key2->get());
+        key2->reset(new int(2));
+        BOOST_CHECK_EQUAL(2, *key2->get());
+    });
+    boost::this_fiber::yield();
+    // destroying the key does not release values of other fibers
+    key1.reset();
+    BOOST_CHECK_EQUAL(0, counted_cleanups);
+    key2.reset( new boost::fibers::fiber_specific_ptr<int>(counted_cleanup));
+    f.join();
+    // both values released, the value stored for key1 at the latest at termination
+    BOOST_CHECK_EQUAL(2, counted_cleanups);
+}
+
+void test_fss_slot_reused() {
+    boost::fibers::fiber( boost::fibers::launch::post, fss_slot_reused).join();
+}
+
 boost::unit_test::test_suite* init_unit_test_suite(int, char*[]) {
     boost::unit_test::test_suite* test =
         BOOST_TEST_SUITE("Boost.Fiber: fss test suite");
@@ -232,6 +297,8 @@ boost::unit_test::test_suite* init_unit_test_suite(int, char*[]) {
     test->add(BOOST_TEST_CASE(test_fss_does_no_cleanup_with_null_cleanup_function));
     test->add(BOOST_TEST_CASE(test_fss_does_not_call_cleanup_after_ptr_destroyed));
     test->add(BOOST_TEST_CASE(test_fss_cleanup_not_called_for_null_pointer));
+    test->add(BOOST_TEST_CASE(test_fss_many_keys));
+    test->add(BOOST_TEST_CASE(test_fss_slot_reused));
 
     return test;
 }
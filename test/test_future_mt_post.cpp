@@ -9,6 +9,7 @@
 #include <stdexcept>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include <boost/fiber/all.hpp>
 #include <boost/test/unit_test.hpp>
@@ -34,6 +35,55 @@ void test_async() {
     }
 }
 
+// several threads wake fibers of this thread concurrently (remote ready-queue);
+// the fibers woken by one thread resume in the order they were woken
+void test_remote_wakeup_fifo() {
+    constexpr int producers = 4;
+    constexpr int wakeups = 256;
+    std::vector< boost::fibers::promise< void > > promises( producers * wakeups);
+    std::vector< std::pair< int, int > > resumed;
+    std::vector< boost::fibers::fiber > fibers;
+    int waiting = 0;
+    for ( int p = 0; p < producers; ++p) {
+        for ( int i = 0; i < wakeups; ++i) {
+            boost::fibers::future< void > f = promises[p * wakeups + i].get_future();
+            fibers.emplace_back( boost::fibers::launch::post,
+                                 std::allocator_arg, boost::fibers::fixedsize_stack{ 16 * 1024 },
+                                 [p,i,&resumed,&waiting](boost::fibers::future< void > f) mutable {
+                                     ++waiting;
+                                     f.get();
+                                     resumed.emplace_back( p, i);
+                                 },
+                                 std::move( f) );
+        }
+    }
+    // all fibers are blocked
+    while ( producers * wakeups != waiting) {
+        boost::this_fiber::yield();
+    }
+    std::vector< std::thread > threads;
+    for ( int p = 0; p < producers; ++p) {
+        threads.emplace_back( [p,&promises](){
+            for ( int i = 0; i < wakeups; ++i) {
+                promises[p * wakeups + i].set_value();
+            }
+        });
+    }
+    // no wake-up is lost
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+    BOOST_REQUIRE_EQUAL( static_cast< std::size_t >( producers * wakeups), resumed.size() );
+    std::vector< int > next( producers, 0);
+    for ( std::pair< int, int > const& r : resumed) {
+        BOOST_CHECK_EQUAL( next[r.first], r.second);
+        next[r.first] = r.second + 1;
+    }
+}
+
 void test_dummy() {}
 
 boost::unit_test_framework::test_suite* init_unit_test_suite(int, char*[]) {
@@ -42,6 +92,7 @@ boost::unit_test_framework::test_suite* init_unit_test_suite(int, char*[]) {
 
 #if ! defined(BOOST_FIBERS_NO_ATOMICS)
     test->add(BOOST_TEST_CASE(test_async));
+    test->add(BOOST_TEST_CASE(test_remote_wakeup_fifo));
 #else
     test->add(BOOST_TEST_CASE(test_dummy));
 #endif
@@ -535,6 +535,21 @@ void test_future_wait_with_fiber_2() {
     boost::fibers::fiber( boost::fibers::launch::post, fn2).join();
 }
 
+void test_future_set_value_and_yield() {
+    boost::fibers::promise< int > p;
+    boost::fibers::future< int > f = p.get_future();
+    int result = 0;
+    boost::fibers::fiber fb( boost::fibers::launch::post, [&result,&f](){
+        result = f.get();
+    });
+    // let the fiber block on the future
+    boost::this_fiber::yield();
+    p.set_value_and_yield( 7);
+    // the waiter has run before the notifier was resumed
+    BOOST_CHECK_EQUAL( 7, result);
+    fb.join();
+}
+
 
 boost::unit_test_framework::test_suite* init_unit_test_suite(int, char*[]) {
     boost::unit_test_framework::test_suite* test =
@@ -564,6 +579,7 @@ boost::unit_test_framework::test_suite* init_unit_test_suite(int, char*[]) {
     test->add(BOOST_TEST_CASE(test_future_wait_until_void));
     test->add(BOOST_TEST_CASE(test_future_wait_with_fiber_1));
     test->add(BOOST_TEST_CASE(test_future_wait_with_fiber_2));
+    test->add(BOOST_TEST_CASE(test_future_set_value_and_yield));
 
     return test;
 }
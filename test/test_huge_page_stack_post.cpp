@@ -0,0 +1,116 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <boost/context/stack_context.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+constexpr std::size_t huge_page_size = boost::fibers::huge_page_stack::huge_page_size;
+constexpr std::size_t stack_size = 64 * 1024;
+
+// lets the dispatcher release the terminated fibers (and their stacks)
+void release_terminated() {
+    boost::this_fiber::sleep_for( std::chrono::milliseconds( 1) );
+}
+
+void test_arenas() {
+    boost::fibers::huge_page_stack salloc{ stack_size, huge_page_size };
+    std::vector< boost::context::stack_context > stacks;
+    for ( int i = 0; i < 40; ++i) {
+        stacks.push_back( salloc.allocate() );
+        BOOST_CHECK_EQUAL( stack_size, stacks.back().size);
+        // stacks are carved from 2 MiB aligned arenas
+        std::uintptr_t bottom = reinterpret_cast< std::uintptr_t >( stacks.back().sp) - stack_size;
+        BOOST_CHECK_EQUAL( std::uintptr_t{ 0 }, bottom % huge_page_size % stack_size);
+        std::memset( reinterpret_cast< void * >( bottom), 0, stack_size);
+    }
+    boost::fibers::huge_page_stack_statistics s = salloc.statistics();
+    BOOST_CHECK_EQUAL( stack_size, s.stack_size);
+    BOOST_CHECK_EQUAL( huge_page_size, s.arena_size);
+    BOOST_CHECK_EQUAL( std::size_t{ 2 }, s.arenas);
+    BOOST_CHECK_EQUAL( std::size_t{ 40 }, s.used_stacks);
+    BOOST_CHECK_EQUAL( std::size_t{ 24 }, s.free_stacks);
+    BOOST_CHECK( s.hugetlbfs_arenas + s.transparent_arenas <= s.arenas);
+    for ( boost::context::stack_context & sctx : stacks) {
+        salloc.deallocate( sctx);
+    }
+    BOOST_CHECK_EQUAL( std::size_t{ 0 }, salloc.statistics().used_stacks);
+    BOOST_CHECK_EQUAL( std::size_t{ 64 }, salloc.statistics().free_stacks);
+    // released stacks are handed out again
+    stacks.clear();
+    for ( int i = 0; i < 64; ++i) {
+        stacks.push_back( salloc.allocate() );
+    }
+    BOOST_CHECK_EQUAL( std::size_t{ 2 }, salloc.statistics().arenas);
+    for ( boost::context::stack_context & sctx : stacks) {
+        salloc.deallocate( sctx);
+    }
+}
+
+void test_hugetlbfs() {
+    // falls back to transparent huge pages without reserved huge pages
+    boost::fibers::huge_page_stack salloc{ stack_size, huge_page_size,
+                                           boost::fibers::huge_page_backing::hugetlbfs, false };
+    int count = 0;
+    std::vector< boost::fibers::fiber > fibers;
+    for ( int i = 0; i < 100; ++i) {
+        fibers.emplace_back( std::allocator_arg, salloc, [&count](){
+            char buffer[4096];
+            std::memset( buffer, 1, sizeof( buffer) );
+            boost::this_fiber::yield();
+            count += buffer[0];
+        });
+    }
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+    release_terminated();
+    BOOST_CHECK_EQUAL( 100, count);
+    boost::fibers::huge_page_stack_statistics s = salloc.statistics();
+    BOOST_CHECK_EQUAL( std::size_t{ 4 }, s.arenas);
+    BOOST_CHECK_EQUAL( std::size_t{ 0 }, s.used_stacks);
+    BOOST_CHECK( s.hugetlbfs_arenas + s.transparent_arenas <= s.arenas);
+}
+
+void test_dispatcher() {
+    boost::fibers::huge_page_stack salloc{ stack_size, huge_page_size };
+    // Boost.Test is not thread-safe, checked after the thread has been joined
+    std::size_t used_by_dispatcher = 0, used_by_fiber = 0;
+    std::thread t{ [&](){
+        // the dispatcher context runs on a stack of the arena, too
+        boost::fibers::initialize_thread(
+            new boost::fibers::algo::round_robin(),
+            boost::fibers::make_stack_allocator_wrapper< boost::fibers::huge_page_stack >( salloc) );
+        used_by_dispatcher = salloc.statistics().used_stacks;
+        boost::fibers::fiber{ std::allocator_arg, salloc, [&](){
+            used_by_fiber = salloc.statistics().used_stacks;
+        }}.join();
+    }};
+    t.join();
+    BOOST_CHECK_EQUAL( std::size_t{ 1 }, used_by_dispatcher);
+    BOOST_CHECK_EQUAL( std::size_t{ 2 }, used_by_fiber);
+    boost::fibers::huge_page_stack_statistics s = salloc.statistics();
+    BOOST_CHECK_EQUAL( std::size_t{ 1 }, s.arenas);
+    BOOST_CHECK_EQUAL( std::size_t{ 0 }, s.used_stacks);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: huge_page_stack test suite");
+
+    test->add( BOOST_TEST_CASE( & test_arenas) );
+    test->add( BOOST_TEST_CASE( & test_hugetlbfs) );
+    test->add( BOOST_TEST_CASE( & test_dispatcher) );
+
+    return test;
+}
@@ -0,0 +1,95 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+#include "test_utils.hpp"
+
+constexpr std::uint32_t thread_count = 4;
+constexpr int fiber_count = 1000;
+
+void test_fifo() {
+    run_with_algorithm< boost::fibers::algo::lockfree_shared_work >( [](){
+        std::vector< int > trace;
+        std::vector< boost::fibers::fiber > fibers;
+        for ( int i = 0; i < 10; ++i) {
+            fibers.emplace_back( boost::fibers::launch::post, [&trace,i](){
+                trace.push_back( i);
+                boost::this_fiber::yield();
+                trace.push_back( 10 + i);
+            });
+        }
+        for ( boost::fibers::fiber & f : fibers) {
+            f.join();
+        }
+        BOOST_REQUIRE_EQUAL( 20u, trace.size() );
+        for ( int i = 0; i < 20; ++i) {
+            BOOST_CHECK_EQUAL( i, trace[i]);
+        }
+    });
+}
+
+void test_shared() {
+    std::atomic< int > count{ 0 };
+    std::mutex threads_mtx;
+    std::set< std::thread::id > thread_ids;
+    boost::fibers::mutex mtx;
+    boost::fibers::condition_variable cnd;
+    auto worker = [&mtx,&cnd,&count](){
+        boost::fibers::use_scheduling_algorithm< boost::fibers::algo::lockfree_shared_work >();
+        std::unique_lock< boost::fibers::mutex > lk{ mtx };
+        cnd.wait( lk, [&count](){ return fiber_count == count.load(); });
+    };
+    std::vector< std::thread > threads;
+    for ( std::uint32_t i = 1; i < thread_count; ++i) {
+        threads.emplace_back( worker);
+    }
+    run_with_algorithm< boost::fibers::algo::lockfree_shared_work >( [&](){
+        for ( int i = 0; i < fiber_count; ++i) {
+            boost::fibers::fiber{ [&](){
+                for ( int j = 0; j < 3; ++j) {
+                    spin_for();
+                    boost::this_fiber::yield();
+                }
+                {
+                    std::unique_lock< std::mutex > lk{ threads_mtx };
+                    thread_ids.insert( std::this_thread::get_id() );
+                }
+                if ( fiber_count == ++count) {
+                    std::unique_lock< boost::fibers::mutex > lk{ mtx };
+                    lk.unlock();
+                    cnd.notify_all();
+                }
+            }}.detach();
+        }
+        std::unique_lock< boost::fibers::mutex > lk{ mtx };
+        cnd.wait( lk, [&count](){ return fiber_count == count.load(); });
+    });
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+    BOOST_CHECK_EQUAL( fiber_count, count.load() );
+    BOOST_CHECK( 1 < thread_ids.size() );
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: lock-free shared-work test suite");
+
+    test->add( BOOST_TEST_CASE( & test_fifo) );
+    test->add( BOOST_TEST_CASE( & test_shared) );
+
+    return test;
+}
@@ -434,6 +434,22 @@ void test_recursive_timed_mutex() {
     boost::fibers::fiber( boost::fibers::launch::post, & do_test_recursive_timed_mutex).join();
 }
 
+void test_mutex_unlock_and_yield() {
+    boost::fibers::mutex mtx;
+    int value = 0;
+    mtx.lock();
+    boost::fibers::fiber f( boost::fibers::launch::post, [&](){
+        std::unique_lock< boost::fibers::mutex > lk( mtx);
+        ++value;
+    });
+    // let the fiber block on the mutex
+    boost::this_fiber::yield();
+    mtx.unlock_and_yield();
+    // the waiter has acquired and released the mutex
+    BOOST_CHECK_EQUAL( 1, value);
+    f.join();
+}
+
 boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
     boost::unit_test::test_suite * test =
         BOOST_TEST_SUITE("Boost.Fiber: mutex test suite");
@@ -442,6 +458,7 @@ boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
     test->add( BOOST_TEST_CASE( & test_recursive_mutex) );
     test->add( BOOST_TEST_CASE( & test_timed_mutex) );
     test->add( BOOST_TEST_CASE( & test_recursive_timed_mutex) );
+    test->add( BOOST_TEST_CASE( & test_mutex_unlock_and_yield) );
 
 	return test;
 }
@@ -0,0 +1,223 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/context/stack_context.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+typedef boost::fibers::numa_pooled_stack::traits_type   traits_type;
+
+constexpr std::size_t stack_size = 64 * 1024;
+constexpr std::size_t prefault_size = 16 * 1024;
+
+// lets the dispatcher release the terminated fibers (and their stacks)
+void release_terminated() {
+    boost::this_fiber::sleep_for( std::chrono::milliseconds( 1) );
+}
+
+void test_reuse() {
+    boost::fibers::numa_pooled_stack salloc{ stack_size, prefault_size };
+    int value = 0;
+    boost::fibers::fiber{ std::allocator_arg, salloc, [&value](){
+        // touches the prefaulted top of the stack
+        char buffer[4096];
+        std::memset( buffer, 1, sizeof( buffer) );
+        value = buffer[0];
+    }}.join();
+    release_terminated();
+    BOOST_CHECK_EQUAL( 1, value);
+    boost::fibers::numa_pooled_stack_statistics s = salloc.statistics();
+    BOOST_CHECK_EQUAL( stack_size, s.stack_size);
+    BOOST_CHECK_EQUAL( std::size_t{ 1 }, s.mapped_stacks);
+    BOOST_CHECK_EQUAL( std::size_t{ 1 }, s.pooled_stacks);
+    BOOST_CHECK_EQUAL( stack_size, s.pooled_bytes);
+    BOOST_CHECK_EQUAL( prefault_size / traits_type::page_size(), s.prefaulted_pages);
+    // the stack is taken from the free list of this thread
+    boost::fibers::fiber{ std::allocator_arg, salloc, [&value](){
+        value = 2;
+    }}.join();
+    release_terminated();
+    BOOST_CHECK_EQUAL( 2, value);
+    s = salloc.statistics();
+    BOOST_CHECK_EQUAL( std::size_t{ 1 }, s.mapped_stacks);
+    BOOST_CHECK_EQUAL( std::size_t{ 1 }, s.pooled_stacks);
+    // warm stacks are not prefaulted again
+    BOOST_CHECK_EQUAL( prefault_size / traits_type::page_size(), s.prefaulted_pages);
+}
+
+void test_overflow() {
+    boost::fibers::numa_pooled_stack salloc{ stack_size, prefault_size, 4, 4 };
+    std::vector< boost::context::stack_context > stacks;
+    for ( int i = 0; i < 10; ++i) {
+        stacks.push_back( salloc.allocate() );
+        BOOST_CHECK_EQUAL( stack_size, stacks.back().size);
+        // the top of the stack is writable
+        std::memset( static_cast< char * >( stacks.back().sp) - prefault_size, 0, prefault_size);
+    }
+    BOOST_CHECK_EQUAL( std::size_t{ 10 }, salloc.statistics().mapped_stacks);
+    BOOST_CHECK_EQUAL( std::size_t{ 0 }, salloc.statistics().pooled_stacks);
+    for ( boost::context::stack_context & sctx : stacks) {
+        salloc.deallocate( sctx);
+    }
+    boost::fibers::numa_pooled_stack_statistics s = salloc.statistics();
+    // at most four warm and four cold stacks are kept
+    BOOST_CHECK( 0 < s.cold_stacks);
+    BOOST_CHECK( s.pooled_stacks <= 8);
+    BOOST_CHECK_EQUAL( s.mapped_stacks, s.pooled_stacks);
+    // cold stacks are prefaulted again
+    std::uint64_t prefaulted = s.prefaulted_pages;
+    stacks.clear();
+    for ( int i = 0; i < 8; ++i) {
+        stacks.push_back( salloc.allocate() );
+    }
+    s = salloc.statistics();
+    BOOST_CHECK_EQUAL( std::size_t{ 8 }, s.mapped_stacks);
+    BOOST_CHECK_EQUAL( std::size_t{ 0 }, s.pooled_stacks);
+    BOOST_CHECK( prefaulted < s.prefaulted_pages);
+    for ( boost::context::stack_context & sctx : stacks) {
+        salloc.deallocate( sctx);
+    }
+}
+
+// permissions of the mapping containing `vp` ("rw-p", "---p", ...), empty if
+// unknown
+std::string protection( void const* vp) {
+    std::ifstream maps{ "/proc/self/maps" };
+    std::string line;
+    std::uintptr_t const addr = reinterpret_cast< std::uintptr_t >( vp);
+    while ( std::getline( maps, line) ) {
+        std::istringstream is{ line };
+        std::uintptr_t first = 0, last = 0;
+        char dash = 0;
+        std::string perms;
+        is >> std::hex >> first >> dash >> last >> perms;
+        if ( first <= addr && addr < last) {
+            return perms;
+        }
+    }
+    return std::string{};
+}
+
+void test_guard_page() {
+    boost::fibers::numa_pooled_stack salloc{ stack_size, prefault_size, 4, 4, true };
+    boost::context::stack_context sctx = salloc.allocate();
+    char * bottom = static_cast< char * >( sctx.sp) - sctx.size;
+    // the whole stack is writable
+    std::memset( bottom, 0, sctx.size);
+#if defined(__linux__)
+    BOOST_CHECK_EQUAL( std::string{ "---p" }, protection( bottom - 1) );
+    BOOST_CHECK_EQUAL( std::string{ "rw-p" }, protection( bottom) );
+#endif
+    salloc.deallocate( sctx);
+    // the guard page survives recycling
+    sctx = salloc.allocate();
+    BOOST_CHECK( bottom == static_cast< char * >( sctx.sp) - sctx.size);
+    std::memset( bottom, 0, sctx.size);
+    salloc.deallocate( sctx);
+}
+
+void test_thread_exit() {
+    boost::fibers::numa_pooled_stack salloc{ stack_size, 0 };
+    std::thread t{ [&salloc](){
+        std::vector< boost::fibers::fiber > fibers;
+        for ( int i = 0; i < 3; ++i) {
+            fibers.emplace_back( std::allocator_arg, salloc, [](){
+                boost::this_fiber::yield();
+            });
+        }
+        for ( boost::fibers::fiber & f : fibers) {
+            f.join();
+        }
+    }};
+    t.join();
+    boost::fibers::numa_pooled_stack_statistics s = salloc.statistics();
+    // the free list of the thread was moved to the overflow list
+    BOOST_CHECK_EQUAL( std::size_t{ 3 }, s.mapped_stacks);
+    BOOST_CHECK_EQUAL( std::size_t{ 3 }, s.pooled_stacks);
+    BOOST_CHECK_EQUAL( std::uint64_t{ 3 }, s.cold_stacks);
+    BOOST_CHECK_EQUAL( std::uint64_t{ 0 }, s.prefaulted_pages);
+    // taken by this thread from the overflow list
+    boost::fibers::fiber{ std::allocator_arg, salloc, [](){}}.join();
+    BOOST_CHECK_EQUAL( std::size_t{ 3 }, salloc.statistics().mapped_stacks);
+}
+
+void test_pool_destroyed() {
+    std::thread t{ [](){
+        {
+            boost::fibers::numa_pooled_stack salloc{ stack_size };
+            boost::fibers::fiber{ std::allocator_arg, salloc, [](){}}.join();
+        }
+        // the stacks of the destroyed pool are dropped from the free lists
+        boost::fibers::numa_pooled_stack salloc{ stack_size };
+        boost::fibers::fiber{ std::allocator_arg, salloc, [](){}}.join();
+        BOOST_CHECK_EQUAL( std::size_t{ 1 }, salloc.statistics().mapped_stacks);
+    }};
+    t.join();
+}
+
+void test_work_stealing() {
+    constexpr std::uint32_t thread_count = 4;
+    constexpr int fiber_count = 200;
+    boost::fibers::numa_pooled_stack salloc{ stack_size, prefault_size, 16, 64 };
+    auto pool = std::make_shared< boost::fibers::algo::work_stealing_pool >( thread_count);
+    std::atomic< int > count{ 0 };
+    boost::fibers::mutex mtx;
+    boost::fibers::condition_variable cnd;
+    std::vector< std::thread > threads;
+    for ( std::uint32_t i = 0; i < thread_count; ++i) {
+        threads.emplace_back( [&,i](){
+            boost::fibers::use_scheduling_algorithm< boost::fibers::algo::work_stealing >( pool);
+            if ( 0 == i) {
+                for ( int j = 0; j < fiber_count; ++j) {
+                    boost::fibers::fiber{ std::allocator_arg, salloc, [&](){
+                        boost::this_fiber::yield();
+                        if ( fiber_count == ++count) {
+                            std::unique_lock< boost::fibers::mutex > lk{ mtx };
+                            lk.unlock();
+                            cnd.notify_all();
+                        }
+                    }}.detach();
+                }
+            }
+            std::unique_lock< boost::fibers::mutex > lk{ mtx };
+            cnd.wait( lk, [&](){ return fiber_count == count.load(); });
+        });
+    }
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+    BOOST_CHECK_EQUAL( fiber_count, count.load() );
+    boost::fibers::numa_pooled_stack_statistics s = salloc.statistics();
+    // every stack was released
+    BOOST_CHECK_EQUAL( s.mapped_stacks, s.pooled_stacks);
+    BOOST_CHECK( s.pooled_stacks <= 64);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: numa_pooled_stack test suite");
+
+    test->add( BOOST_TEST_CASE( & test_reuse) );
+    test->add( BOOST_TEST_CASE( & test_overflow) );
+    test->add( BOOST_TEST_CASE( & test_guard_page) );
+    test->add( BOOST_TEST_CASE( & test_thread_exit) );
+    test->add( BOOST_TEST_CASE( & test_pool_destroyed) );
+    test->add( BOOST_TEST_CASE( & test_work_stealing) );
+
+    return test;
+}
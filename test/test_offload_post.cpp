@@ -0,0 +1,102 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+#include <boost/fiber/offload.hpp>
+
+typedef std::chrono::milliseconds ms;
+
+int add( int i, int j) {
+    return i + j;
+}
+
+void test_offload_value() {
+    std::thread::id id = std::this_thread::get_id();
+    bool other_thread = false;
+    int i = boost::fibers::offload( [id,&other_thread](int j){
+        other_thread = id != std::this_thread::get_id();
+        return 2 * j;
+    }, 21);
+    BOOST_CHECK_EQUAL( 42, i);
+    BOOST_CHECK( other_thread);
+    BOOST_CHECK_EQUAL( 3, boost::fibers::offload( add, 1, 2) );
+}
+
+void test_offload_move_only() {
+    std::unique_ptr< int > p = boost::fibers::offload( [](std::unique_ptr< int > q){
+        ++ * q;
+        return q;
+    }, std::unique_ptr< int >{ new int{ 1 } });
+    BOOST_CHECK_EQUAL( 2, * p);
+}
+
+void test_offload_reference() {
+    int i = 0;
+    int & r = boost::fibers::offload( [&i]() -> int & { return i; });
+    BOOST_CHECK_EQUAL( & i, & r);
+    boost::fibers::offload( [&i](){ i = 7; });
+    BOOST_CHECK_EQUAL( 7, i);
+}
+
+void test_offload_exception() {
+    bool thrown = false;
+    try {
+        boost::fibers::offload( [](){
+            throw std::runtime_error{ "abc" };
+        });
+    } catch ( std::runtime_error const& e) {
+        thrown = true;
+        BOOST_CHECK_EQUAL( std::string{ "abc" }, e.what() );
+    }
+    BOOST_CHECK( thrown);
+}
+
+void test_offload_other_fibers_run() {
+    int ticks = 0;
+    bool done = false;
+    boost::fibers::fiber f{ boost::fibers::launch::post, [&](){
+        while ( ! done) {
+            ++ticks;
+            boost::this_fiber::sleep_for( ms( 1) );
+        }
+    }};
+    // blocks a helper thread, not this thread
+    boost::fibers::offload( [](){ std::this_thread::sleep_for( ms( 50) ); });
+    done = true;
+    f.join();
+    BOOST_CHECK( 5 < ticks);
+}
+
+void test_offload_statistics() {
+    boost::fibers::offload_statistics before = boost::fibers::get_offload_statistics();
+    boost::fibers::offload( [](){});
+    boost::fibers::offload_statistics after = boost::fibers::get_offload_statistics();
+    BOOST_CHECK_EQUAL( before.completed + 1, after.completed);
+    BOOST_CHECK( 0 < after.threads);
+    BOOST_CHECK( after.threads <= after.max_threads);
+    BOOST_CHECK_EQUAL( 0u, after.queued);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: offload test suite");
+
+    test->add( BOOST_TEST_CASE( & test_offload_value) );
+    test->add( BOOST_TEST_CASE( & test_offload_move_only) );
+    test->add( BOOST_TEST_CASE( & test_offload_reference) );
+    test->add( BOOST_TEST_CASE( & test_offload_exception) );
+    test->add( BOOST_TEST_CASE( & test_offload_other_fibers_run) );
+    test->add( BOOST_TEST_CASE( & test_offload_statistics) );
+
+    return test;
+}
@@ -0,0 +1,199 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+#include "test_utils.hpp"
+
+typedef std::chrono::milliseconds ms;
+
+boost::fibers::fiber launch( int p, std::string & trace, char c, int n) {
+    boost::fibers::fiber f{ boost::fibers::launch::post, [&trace,c,n](){
+        for ( int i = 0; i < n; ++i) {
+            if ( 0 < i) {
+                boost::this_fiber::yield();
+            }
+            trace += c;
+        }
+    }};
+    f.properties< boost::fibers::algo::priority_props >().set_priority( p);
+    return f;
+}
+
+void test_priority_order() {
+    run_with_algorithm< boost::fibers::algo::priority >( [](){
+        std::string trace;
+        std::vector< boost::fibers::fiber > fibers;
+        fibers.push_back( launch( 1, trace, 'a', 1) );
+        fibers.push_back( launch( 5, trace, 'b', 2) );
+        fibers.push_back( launch( 5, trace, 'c', 2) );
+        fibers.push_back( launch( 3, trace, 'd', 1) );
+        for ( boost::fibers::fiber & f : fibers) {
+            f.join();
+        }
+        // strict priority, round-robin within a level
+        BOOST_CHECK_EQUAL( std::string{ "bcbcda" }, trace);
+    });
+}
+
+void test_priority_change() {
+    run_with_algorithm< boost::fibers::algo::priority >( [](){
+        std::string trace;
+        boost::fibers::fiber f1 = launch( 1, trace, 'a', 1);
+        boost::fibers::fiber f2 = launch( 2, trace, 'b', 1);
+        // reprioritize a ready fiber
+        f1.properties< boost::fibers::algo::priority_props >().set_priority( 3);
+        f1.join();
+        f2.join();
+        BOOST_CHECK_EQUAL( std::string{ "ab" }, trace);
+    });
+}
+
+void test_priority_clamp() {
+    boost::fibers::algo::priority_props props{ nullptr, 1000 };
+    BOOST_CHECK_EQUAL( static_cast< int >( boost::fibers::algo::priority::levels) - 1, props.get_priority() );
+    props.set_priority( -5);
+    BOOST_CHECK_EQUAL( 0, props.get_priority() );
+}
+
+void test_priority_sleep() {
+    run_with_algorithm< boost::fibers::algo::priority >( [](){
+        // a yielding fiber does not starve a sleeping fiber of the same level
+        bool done = false;
+        boost::fibers::fiber f1{ boost::fibers::launch::post, [&done](){
+            boost::this_fiber::sleep_for( ms( 5) );
+            done = true;
+        }};
+        boost::fibers::fiber f2{ boost::fibers::launch::post, [&done](){
+            while ( ! done) {
+                boost::this_fiber::yield();
+            }
+        }};
+        f1.properties< boost::fibers::algo::priority_props >().set_priority( 10);
+        f2.properties< boost::fibers::algo::priority_props >().set_priority( 10);
+        f1.join();
+        f2.join();
+        BOOST_CHECK( done);
+    });
+}
+
+void test_priority_props_on_stack() {
+    run_with_algorithm< boost::fibers::algo::priority >( [](){
+        std::uintptr_t ctx_addr = 0;
+        boost::fibers::fiber f{ boost::fibers::launch::post, [&ctx_addr](){
+            ctx_addr = reinterpret_cast< std::uintptr_t >( boost::fibers::context::active() );
+        }};
+        std::uintptr_t props_addr = reinterpret_cast< std::uintptr_t >(
+                & f.properties< boost::fibers::algo::priority_props >() );
+        f.properties< boost::fibers::algo::priority_props >().set_priority( 2);
+        f.join();
+        // properties were constructed right below the control structure on
+        // top of the fiber's stack
+        BOOST_CHECK( props_addr < ctx_addr);
+        BOOST_CHECK( ctx_addr - props_addr < sizeof( boost::fibers::algo::priority_props) + 256);
+    });
+}
+
+// properties allocated by a custom new_properties()
+class counted_props : public boost::fibers::algo::priority_props {
+public:
+    counted_props( boost::fibers::context * ctx) :
+        priority_props{ ctx } {
+    }
+};
+
+// custom scheduler overriding new_properties() only
+class counting_scheduler :
+    public boost::fibers::algo::algorithm_with_properties< boost::fibers::algo::priority_props > {
+private:
+    typedef boost::fibers::scheduler::ready_queue_type  rqueue_type;
+
+    rqueue_type                 rqueue_{};
+    std::mutex                  mtx_{};
+    std::condition_variable     cnd_{};
+    bool                        flag_{ false };
+
+public:
+    static thread_local int     created;
+
+    void awakened( boost::fibers::context * ctx, boost::fibers::algo::priority_props &) noexcept override {
+        ctx->ready_link( rqueue_);
+    }
+
+    boost::fibers::context * pick_next() noexcept override {
+        if ( rqueue_.empty() ) {
+            return nullptr;
+        }
+        boost::fibers::context * ctx = & rqueue_.front();
+        rqueue_.pop_front();
+        return ctx;
+    }
+
+    bool has_ready_fibers() const noexcept override {
+        return ! rqueue_.empty();
+    }
+
+    void suspend_until( std::chrono::steady_clock::time_point const& time_point) noexcept override {
+        std::unique_lock< std::mutex > lk{ mtx_ };
+        cnd_.wait_until( lk, time_point, [this](){ return flag_; });
+        flag_ = false;
+    }
+
+    void notify() noexcept override {
+        std::unique_lock< std::mutex > lk{ mtx_ };
+        flag_ = true;
+        lk.unlock();
+        cnd_.notify_all();
+    }
+
+    boost::fibers::fiber_properties * new_properties( boost::fibers::context * ctx) override {
+        ++created;
+        return new counted_props( ctx);
+    }
+};
+
+thread_local int counting_scheduler::created = 0;
+
+void test_custom_new_properties() {
+    std::thread t{ [](){
+        boost::fibers::use_scheduling_algorithm< counting_scheduler >();
+        int created = counting_scheduler::created;
+        int n = 0;
+        boost::fibers::fiber f{ boost::fibers::launch::post, [&n](){
+            ++n;
+        }};
+        // in-place construction is opt-in, the override is not bypassed
+        BOOST_CHECK_EQUAL( created + 1, counting_scheduler::created);
+        BOOST_CHECK( nullptr != dynamic_cast< counted_props * >(
+                & f.properties< boost::fibers::algo::priority_props >() ) );
+        f.join();
+        BOOST_CHECK_EQUAL( 1, n);
+    }};
+    t.join();
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: priority test suite");
+
+    test->add( BOOST_TEST_CASE( & test_priority_order) );
+    test->add( BOOST_TEST_CASE( & test_priority_change) );
+    test->add( BOOST_TEST_CASE( & test_priority_clamp) );
+    test->add( BOOST_TEST_CASE( & test_priority_sleep) );
+    test->add( BOOST_TEST_CASE( & test_priority_props_on_stack) );
+    test->add( BOOST_TEST_CASE( & test_custom_new_properties) );
+
+    return test;
+}
@@ -0,0 +1,221 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <boost/context/stack_context.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+constexpr std::uint32_t thread_count = 4;
+constexpr std::size_t fiber_count = 300;
+
+// counts the batches passed to the scheduling algorithm
+class counting_round_robin : public boost::fibers::algo::round_robin {
+public:
+    static std::size_t  batches;
+    static std::size_t  batched;
+
+    void awakened_n( boost::fibers::context ** ctxs, std::size_t n) noexcept override {
+        ++batches;
+        batched += n;
+        boost::fibers::algo::round_robin::awakened_n( ctxs, n);
+    }
+};
+
+std::size_t counting_round_robin::batches = 0;
+std::size_t counting_round_robin::batched = 0;
+
+// throws after `limit` stacks were allocated
+class limited_stack {
+private:
+    boost::fibers::fixedsize_stack      salloc_{};
+    std::shared_ptr< std::size_t >      count_;
+    std::size_t                         limit_;
+
+public:
+    limited_stack( std::shared_ptr< std::size_t > count, std::size_t limit) :
+        count_{ count },
+        limit_{ limit } {
+    }
+
+    boost::context::stack_context allocate() {
+        if ( limit_ == * count_) {
+            throw std::bad_alloc{};
+        }
+        ++( * count_);
+        return salloc_.allocate();
+    }
+
+    void deallocate( boost::context::stack_context & sctx) noexcept {
+        salloc_.deallocate( sctx);
+    }
+};
+
+void test_spawn_n() {
+    std::vector< std::size_t > values( fiber_count, 0);
+    std::vector< boost::fibers::fiber > fibers = boost::fibers::spawn_n( fiber_count,
+            [&values]( std::size_t i){
+                values[i] = i + 1;
+            });
+    BOOST_CHECK_EQUAL( fiber_count, fibers.size() );
+    // launched with launch::post
+    for ( std::size_t i = 0; i < fiber_count; ++i) {
+        BOOST_CHECK_EQUAL( std::size_t{ 0 }, values[i]);
+    }
+    std::set< boost::fibers::fiber::id > ids;
+    for ( boost::fibers::fiber & f : fibers) {
+        BOOST_CHECK( f.joinable() );
+        ids.insert( f.get_id() );
+        f.join();
+    }
+    BOOST_CHECK_EQUAL( fiber_count, ids.size() );
+    for ( std::size_t i = 0; i < fiber_count; ++i) {
+        BOOST_CHECK_EQUAL( i + 1, values[i]);
+    }
+}
+
+void test_spawn_n_empty() {
+    std::vector< boost::fibers::fiber > fibers = boost::fibers::spawn_n( 0, []( std::size_t){});
+    BOOST_CHECK( fibers.empty() );
+}
+
+void test_spawn_range() {
+    std::list< int > input{ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+    int sum = 0;
+    std::vector< boost::fibers::fiber > fibers = boost::fibers::spawn_range(
+            std::allocator_arg, boost::fibers::fixedsize_stack{},
+            input.begin(), input.end(),
+            [&sum]( int i){
+                boost::this_fiber::yield();
+                sum += i;
+            });
+    BOOST_CHECK_EQUAL( input.size(), fibers.size() );
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+    BOOST_CHECK_EQUAL( 55, sum);
+}
+
+void test_spawn_n_one_batch() {
+    std::thread t{ [](){
+        boost::fibers::use_scheduling_algorithm< counting_round_robin >();
+        std::size_t count = 0;
+        std::vector< boost::fibers::fiber > fibers = boost::fibers::spawn_n( fiber_count,
+                [&count]( std::size_t){
+                    ++count;
+                });
+        BOOST_CHECK_EQUAL( std::size_t{ 1 }, counting_round_robin::batches);
+        BOOST_CHECK_EQUAL( fiber_count, counting_round_robin::batched);
+        for ( boost::fibers::fiber & f : fibers) {
+            f.join();
+        }
+        BOOST_CHECK_EQUAL( fiber_count, count);
+    }};
+    t.join();
+}
+
+void test_spawn_n_exception() {
+    auto allocated = std::make_shared< std::size_t >( 0);
+    std::size_t count = 0;
+    bool thrown = false;
+    try {
+        boost::fibers::spawn_n( std::allocator_arg, limited_stack{ allocated, 5 }, 10,
+                [&count]( std::size_t){
+                    boost::this_fiber::yield();
+                    ++count;
+                });
+    } catch ( std::bad_alloc const&) {
+        thrown = true;
+    }
+    BOOST_CHECK( thrown);
+    // the fibers created before have run to completion
+    BOOST_CHECK_EQUAL( std::size_t{ 5 }, * allocated);
+    BOOST_CHECK_EQUAL( std::size_t{ 5 }, count);
+}
+
+template< typename Setup >
+void check_shared( Setup && setup) {
+    std::atomic< std::size_t > count{ 0 };
+    std::mutex threads_mtx;
+    std::set< std::thread::id > thread_ids;
+    boost::fibers::mutex mtx;
+    boost::fibers::condition_variable cnd;
+    auto done = [&count](){
+        return fiber_count == count.load();
+    };
+    std::vector< std::thread > threads;
+    for ( std::uint32_t i = 0; i < thread_count; ++i) {
+        threads.emplace_back( [&,i](){
+            setup();
+            if ( 0 == i) {
+                for ( boost::fibers::fiber & f : boost::fibers::spawn_n( fiber_count,
+                        [&]( std::size_t){
+                            // keep the thread busy, the other threads take over
+                            std::this_thread::sleep_for( std::chrono::microseconds( 100) );
+                            boost::this_fiber::yield();
+                            {
+                                std::unique_lock< std::mutex > lk{ threads_mtx };
+                                thread_ids.insert( std::this_thread::get_id() );
+                            }
+                            if ( fiber_count == ++count) {
+                                std::unique_lock< boost::fibers::mutex > lk{ mtx };
+                                lk.unlock();
+                                cnd.notify_all();
+                            }
+                        }) ) {
+                    f.detach();
+                }
+            }
+            std::unique_lock< boost::fibers::mutex > lk{ mtx };
+            cnd.wait( lk, done);
+        });
+    }
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+    BOOST_CHECK_EQUAL( fiber_count, count.load() );
+    // the fibers were shared
+    BOOST_CHECK( 1 < thread_ids.size() );
+}
+
+void test_work_stealing() {
+    auto pool = std::make_shared< boost::fibers::algo::work_stealing_pool >( thread_count);
+    check_shared( [pool](){
+        boost::fibers::use_scheduling_algorithm< boost::fibers::algo::work_stealing >( pool);
+    });
+}
+
+void test_shared_work() {
+    check_shared( [](){
+        boost::fibers::use_scheduling_algorithm< boost::fibers::algo::shared_work >();
+    });
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: spawn test suite");
+
+    test->add( BOOST_TEST_CASE( & test_spawn_n) );
+    test->add( BOOST_TEST_CASE( & test_spawn_n_empty) );
+    test->add( BOOST_TEST_CASE( & test_spawn_range) );
+    test->add( BOOST_TEST_CASE( & test_spawn_n_one_batch) );
+    test->add( BOOST_TEST_CASE( & test_spawn_n_exception) );
+    test->add( BOOST_TEST_CASE( & test_work_stealing) );
+    test->add( BOOST_TEST_CASE( & test_shared_work) );
+
+    return test;
+}
@@ -0,0 +1,130 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/context/stack_traits.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+// lets the dispatcher release the terminated fibers (and their stacks)
+void release_terminated() {
+    boost::this_fiber::sleep_for( std::chrono::milliseconds( 1) );
+}
+
+char volatile sink = 0;
+
+template< std::size_t N >
+void use_stack() {
+    char volatile buffer[N];
+    for ( std::size_t i = 0; i < N; ++i) {
+        buffer[i] = 1;
+    }
+    // read back, the buffer must not be optimized away
+    sink = buffer[N - 1];
+}
+
+boost::fibers::stack_usage find( boost::fibers::stack_profile const& profile, std::string const& tag) {
+    for ( boost::fibers::stack_usage const& u : profile.usage() ) {
+        if ( tag == u.tag) {
+            return u;
+        }
+    }
+    return boost::fibers::stack_usage{};
+}
+
+void test_profiled_stack() {
+    boost::fibers::stack_profile profile;
+    boost::fibers::profiled_stack<> deep{ "deep", boost::fibers::fixedsize_stack{ 256 * 1024 }, profile };
+    boost::fibers::profiled_stack<> shallow{ "shallow", boost::fibers::fixedsize_stack{ 256 * 1024 }, profile };
+    boost::fibers::fiber{ std::allocator_arg, deep, use_stack< 32 * 1024 > }.join();
+    boost::fibers::fiber{ std::allocator_arg, shallow, use_stack< 512 > }.join();
+    boost::fibers::fiber{ std::allocator_arg, shallow, use_stack< 1024 > }.join();
+    release_terminated();
+    boost::fibers::stack_usage u = find( profile, "deep");
+    BOOST_CHECK_EQUAL( std::uint64_t{ 1 }, u.samples);
+    BOOST_CHECK( 32 * 1024 <= u.max_used);
+    BOOST_CHECK( u.max_used < 64 * 1024);
+    BOOST_CHECK_EQUAL( u.max_used, u.mean_used);
+    // 32 KiB < used <= 64 KiB
+    BOOST_CHECK_EQUAL( std::uint64_t{ 1 }, u.histogram[6]);
+    u = find( profile, "shallow");
+    BOOST_CHECK_EQUAL( std::uint64_t{ 2 }, u.samples);
+    BOOST_CHECK( 1024 <= u.max_used);
+    BOOST_CHECK( u.max_used < 32 * 1024);
+    std::ostringstream os;
+    profile.report( os);
+    BOOST_CHECK( std::string::npos != os.str().find( "deep: 1 fibers") );
+    BOOST_CHECK( std::string::npos != os.str().find( "shallow: 2 fibers") );
+    profile.reset();
+    BOOST_CHECK_EQUAL( std::uint64_t{ 0 }, find( profile, "deep").samples);
+}
+
+void test_profiled_protected_stack() {
+    boost::fibers::stack_profile profile;
+    // the guard page is not painted
+    boost::fibers::profiled_stack< boost::fibers::protected_fixedsize_stack > salloc{
+        BOOST_FIBERS_CALL_SITE, boost::fibers::protected_fixedsize_stack{ 64 * 1024 }, profile };
+    boost::fibers::fiber{ std::allocator_arg, salloc, use_stack< 8 * 1024 > }.join();
+    release_terminated();
+    std::vector< boost::fibers::stack_usage > v = profile.usage();
+    BOOST_REQUIRE_EQUAL( std::size_t{ 1 }, v.size() );
+    BOOST_CHECK( std::string::npos != v[0].tag.find( "test_stack_profile_post.cpp:") );
+    BOOST_CHECK_EQUAL( std::uint64_t{ 1 }, v[0].samples);
+    BOOST_CHECK( 8 * 1024 <= v[0].max_used);
+    BOOST_CHECK( v[0].max_used < 64 * 1024);
+}
+
+void test_adaptive_stack() {
+    std::size_t page = boost::context::stack_traits::page_size();
+    boost::fibers::stack_profile profile;
+    boost::fibers::adaptive_stack<> salloc{ "adaptive", 256 * 1024, 16 * 1024, 2.0, 8, 4, profile };
+    // learning
+    BOOST_CHECK_EQUAL( std::size_t{ 256 * 1024 }, salloc.stack_size() );
+    for ( int i = 0; i < 8; ++i) {
+        boost::fibers::fiber{ std::allocator_arg, salloc, use_stack< 12 * 1024 > }.join();
+        release_terminated();
+    }
+    boost::fibers::stack_usage u = find( profile, "adaptive");
+    BOOST_CHECK_EQUAL( std::uint64_t{ 8 }, u.samples);
+    BOOST_CHECK( 12 * 1024 <= u.max_used);
+    std::size_t size = salloc.stack_size();
+    BOOST_CHECK( 2 * u.max_used <= size);
+    BOOST_CHECK( size < 2 * u.max_used + page);
+    BOOST_CHECK( size < 256 * 1024);
+    // every 4th stack is still painted
+    for ( int i = 0; i < 16; ++i) {
+        boost::fibers::fiber{ std::allocator_arg, salloc, use_stack< 12 * 1024 > }.join();
+        release_terminated();
+    }
+    BOOST_CHECK_EQUAL( std::uint64_t{ 12 }, find( profile, "adaptive").samples);
+    BOOST_CHECK_EQUAL( size, salloc.stack_size() );
+}
+
+void test_adaptive_stack_min_size() {
+    boost::fibers::stack_profile profile;
+    boost::fibers::adaptive_stack< boost::fibers::fixedsize_stack > salloc{ "min", 128 * 1024, 64 * 1024, 2.0, 1, 1, profile };
+    boost::fibers::fiber{ std::allocator_arg, salloc, use_stack< 512 > }.join();
+    release_terminated();
+    BOOST_CHECK_EQUAL( std::size_t{ 64 * 1024 }, salloc.stack_size() );
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: stack profile test suite");
+
+    test->add( BOOST_TEST_CASE( & test_profiled_stack) );
+    test->add( BOOST_TEST_CASE( & test_profiled_protected_stack) );
+    test->add( BOOST_TEST_CASE( & test_adaptive_stack) );
+    test->add( BOOST_TEST_CASE( & test_adaptive_stack_min_size) );
+
+    return test;
+}
@@ -0,0 +1,160 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+std::uint64_t ready_delays( boost::fibers::scheduler_statistics const& s) {
+    std::uint64_t n = 0;
+    for ( std::size_t i = 0; i < boost::fibers::scheduler_statistics::histogram_buckets; ++i) {
+        n += s.ready_delay[i];
+    }
+    return n;
+}
+
+void test_local_wakeups() {
+    boost::fibers::scheduler_statistics s0 = boost::fibers::this_thread_statistics();
+    BOOST_CHECK_EQUAL( std::uint64_t{ 1 }, s0.schedulers);
+    std::vector< boost::fibers::fiber > fibers;
+    for ( int i = 0; i < 10; ++i) {
+        fibers.emplace_back( boost::fibers::launch::post, [](){
+            for ( int j = 0; j < 3; ++j) {
+                boost::this_fiber::yield();
+            }
+        });
+    }
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+    boost::fibers::scheduler_statistics s1 = boost::fibers::this_thread_statistics();
+    BOOST_CHECK_EQUAL( std::uint64_t{ 30 }, s1.yields - s0.yields);
+    // launched fibers and yields
+    BOOST_CHECK( 40 <= s1.local_wakeups - s0.local_wakeups);
+    BOOST_CHECK_EQUAL( s0.remote_wakeups, s1.remote_wakeups);
+    BOOST_CHECK( 40 <= s1.context_switches - s0.context_switches);
+    // a ready-delay is recorded for each context resumed from the ready-queue
+    std::uint64_t delays = ready_delays( s1) - ready_delays( s0);
+    BOOST_CHECK( 40 <= delays);
+    BOOST_CHECK( delays <= s1.context_switches - s0.context_switches);
+    BOOST_CHECK_EQUAL( std::uint64_t{ 0 }, s1.sleeping);
+}
+
+void test_remote_wakeups() {
+    constexpr int wakeups = 5;
+    std::vector< boost::fibers::promise< void > > promises( wakeups);
+    std::vector< boost::fibers::fiber > fibers;
+    int waiting = 0;
+    for ( boost::fibers::promise< void > & p : promises) {
+        fibers.emplace_back( boost::fibers::launch::post,
+                             [&waiting](boost::fibers::future< void > f) mutable {
+                                 ++waiting;
+                                 f.get();
+                             },
+                             p.get_future() );
+    }
+    // all fibers are blocked
+    while ( wakeups != waiting) {
+        boost::this_fiber::yield();
+    }
+    boost::fibers::scheduler_statistics s0 = boost::fibers::this_thread_statistics();
+    std::thread t{ [&promises](){
+        for ( boost::fibers::promise< void > & p : promises) {
+            p.set_value();
+        }
+    }};
+    t.join();
+    for ( boost::fibers::fiber & f : fibers) {
+        f.join();
+    }
+    boost::fibers::scheduler_statistics s1 = boost::fibers::this_thread_statistics();
+    BOOST_CHECK_EQUAL( std::uint64_t{ wakeups }, s1.remote_wakeups - s0.remote_wakeups);
+}
+
+void test_sleeping() {
+    boost::fibers::fiber f{ boost::fibers::launch::post, [](){
+        boost::this_fiber::sleep_for( std::chrono::milliseconds( 10) );
+    }};
+    boost::this_fiber::yield();
+    BOOST_CHECK_EQUAL( std::uint64_t{ 1 }, boost::fibers::this_thread_statistics().sleeping);
+    f.join();
+    BOOST_CHECK_EQUAL( std::uint64_t{ 0 }, boost::fibers::this_thread_statistics().sleeping);
+}
+
+void test_steals() {
+    constexpr std::uint32_t thread_count = 2;
+    constexpr int fiber_count = 100;
+    boost::fibers::scheduler_statistics s0 = boost::fibers::process_statistics();
+    auto pool = std::make_shared< boost::fibers::algo::work_stealing_pool >( thread_count);
+    std::atomic< int > count{ 0 };
+    std::mutex threads_mtx;
+    std::set< std::thread::id > thread_ids;
+    boost::fibers::mutex mtx;
+    boost::fibers::condition_variable cnd;
+    std::vector< std::thread > threads;
+    for ( std::uint32_t i = 0; i < thread_count; ++i) {
+        threads.emplace_back( [&,i](){
+            boost::fibers::use_scheduling_algorithm< boost::fibers::algo::work_stealing >( pool);
+            if ( 0 == i) {
+                for ( int j = 0; j < fiber_count; ++j) {
+                    boost::fibers::fiber{ [&](){
+                        // block the thread, the idle peer steals
+                        std::this_thread::sleep_for( std::chrono::microseconds( 100) );
+                        boost::this_fiber::yield();
+                        {
+                            std::unique_lock< std::mutex > lk{ threads_mtx };
+                            thread_ids.insert( std::this_thread::get_id() );
+                        }
+                        if ( fiber_count == ++count) {
+                            std::unique_lock< boost::fibers::mutex > lk{ mtx };
+                            lk.unlock();
+                            cnd.notify_all();
+                        }
+                    }}.detach();
+                }
+            }
+            std::unique_lock< boost::fibers::mutex > lk{ mtx };
+            cnd.wait( lk, [&](){ return fiber_count == count.load(); });
+        });
+    }
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+    // the schedulers of the joined threads are accumulated
+    boost::fibers::scheduler_statistics s1 = boost::fibers::process_statistics();
+    BOOST_CHECK_EQUAL( s0.schedulers, s1.schedulers);
+    BOOST_CHECK( s1.steals_attempted - s0.steals_attempted >= s1.steals_succeeded - s0.steals_succeeded);
+    // fibers ran on both threads
+    BOOST_CHECK_EQUAL( std::size_t{ thread_count }, thread_ids.size() );
+    BOOST_CHECK( 0 < s1.steals_succeeded - s0.steals_succeeded);
+    BOOST_CHECK( fiber_count <= s1.local_wakeups - s0.local_wakeups);
+}
+
+void test_dummy() {}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: statistics test suite");
+
+#if defined(BOOST_FIBERS_USE_STATISTICS) && ! defined(BOOST_FIBERS_NO_ATOMICS)
+    test->add( BOOST_TEST_CASE( & test_local_wakeups) );
+    test->add( BOOST_TEST_CASE( & test_remote_wakeups) );
+    test->add( BOOST_TEST_CASE( & test_sleeping) );
+    test->add( BOOST_TEST_CASE( & test_steals) );
+#else
+    test->add( BOOST_TEST_CASE( & test_dummy) );
+#endif
+
+    return test;
+}
@@ -0,0 +1,275 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+#include "test_utils.hpp"
+
+constexpr std::uint32_t thread_count = 4;
+constexpr int fiber_count = 300;
+
+// the thread at index 0 launches three kinds of fibers:
+//  - bound to the thread at launch
+//  - bound/released at runtime via this_fiber::thread_affinity()
+//  - migratable fibers keeping the other threads busy
+template< typename Setup >
+void check_affinity( Setup && setup) {
+    constexpr int total = 3 * fiber_count;
+    std::atomic< int > count{ 0 };
+    std::atomic< int > migrated{ 0 };
+    std::atomic< int > wrong_affinity{ 0 };
+    std::mutex threads_mtx;
+    std::set< std::thread::id > thread_ids;
+    boost::fibers::mutex mtx;
+    boost::fibers::condition_variable cnd;
+    auto done = [&count](){
+        return total == count.load();
+    };
+    auto finish = [&](){
+        if ( total == ++count) {
+            std::unique_lock< boost::fibers::mutex > lk{ mtx };
+            lk.unlock();
+            cnd.notify_all();
+        }
+    };
+    auto launch = [&](){
+        std::thread::id id = std::this_thread::get_id();
+        for ( int i = 0; i < fiber_count; ++i) {
+            boost::fibers::fiber{ boost::fibers::launch::post, boost::fibers::pinned_to_thread, [&,id](){
+                if ( ! boost::this_fiber::thread_affinity() ) {
+                    ++wrong_affinity;
+                }
+                for ( int j = 0; j < 3; ++j) {
+                    spin_for();
+                    boost::this_fiber::yield();
+                    if ( id != std::this_thread::get_id() ) {
+                        ++migrated;
+                    }
+                }
+                finish();
+            }}.detach();
+            boost::fibers::fiber{ boost::fibers::launch::post, [&](){
+                if ( boost::this_fiber::thread_affinity() ) {
+                    ++wrong_affinity;
+                }
+                boost::this_fiber::thread_affinity( true);
+                std::thread::id tid = std::this_thread::get_id();
+                for ( int j = 0; j < 3; ++j) {
+                    spin_for();
+                    boost::this_fiber::yield();
+                    if ( tid != std::this_thread::get_id() ) {
+                        ++migrated;
+                    }
+                }
+                boost::this_fiber::thread_affinity( false);
+                spin_for();
+                boost::this_fiber::yield();
+                finish();
+            }}.detach();
+            boost::fibers::fiber{ boost::fibers::launch::post, [&](){
+                for ( int j = 0; j < 3; ++j) {
+                    spin_for();
+                    boost::this_fiber::yield();
+                }
+                {
+                    std::unique_lock< std::mutex > lk{ threads_mtx };
+                    thread_ids.insert( std::this_thread::get_id() );
+                }
+                finish();
+            }}.detach();
+        }
+    };
+    std::vector< std::thread > threads;
+    for ( std::uint32_t i = 0; i < thread_count; ++i) {
+        threads.emplace_back( [&,i](){
+            setup();
+            if ( 0 == i) {
+                launch();
+            }
+            std::unique_lock< boost::fibers::mutex > lk{ mtx };
+            cnd.wait( lk, done);
+        });
+    }
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+    BOOST_CHECK_EQUAL( total, count.load() );
+    BOOST_CHECK_EQUAL( 0, wrong_affinity.load() );
+    BOOST_CHECK_EQUAL( 0, migrated.load() );
+    // the migratable fibers were shared
+    BOOST_CHECK( 1 < thread_ids.size() );
+}
+
+void test_work_stealing() {
+    auto pool = std::make_shared< boost::fibers::algo::work_stealing_pool >( thread_count);
+    check_affinity( [pool](){
+        boost::fibers::use_scheduling_algorithm< boost::fibers::algo::work_stealing >( pool);
+    });
+}
+
+void test_shared_work() {
+    check_affinity( [](){
+        boost::fibers::use_scheduling_algorithm< boost::fibers::algo::shared_work >();
+    });
+}
+
+void test_lockfree_shared_work() {
+    check_affinity( [](){
+        boost::fibers::use_scheduling_algorithm< boost::fibers::algo::lockfree_shared_work >();
+    });
+}
+
+// a pinned fiber keeps running while free fibers keep the shared ready-queue
+// busy; the free fibers yield till the pinned fiber has finished (or a
+// timeout has elapsed)
+template< typename Setup >
+void check_pinned_under_load( Setup && setup) {
+    constexpr int load_count = 4 * thread_count;
+    constexpr int total = load_count + 1;
+    std::atomic< int > count{ 0 };
+    std::atomic< bool > pinned_done{ false };
+    std::atomic< bool > timed_out{ false };
+    boost::fibers::mutex mtx;
+    boost::fibers::condition_variable cnd;
+    auto finish = [&](){
+        if ( total == ++count) {
+            std::unique_lock< boost::fibers::mutex > lk{ mtx };
+            lk.unlock();
+            cnd.notify_all();
+        }
+    };
+    std::vector< std::thread > threads;
+    for ( std::uint32_t i = 0; i < thread_count; ++i) {
+        threads.emplace_back( [&,i](){
+            setup();
+            if ( 0 == i) {
+                std::chrono::steady_clock::time_point timeout =
+                    std::chrono::steady_clock::now() + std::chrono::seconds( 10);
+                for ( int j = 0; j < load_count; ++j) {
+                    boost::fibers::fiber{ boost::fibers::launch::post, [&,timeout](){
+                        while ( ! pinned_done) {
+                            if ( timeout < std::chrono::steady_clock::now() ) {
+                                timed_out = true;
+                                break;
+                            }
+                            boost::this_fiber::yield();
+                        }
+                        finish();
+                    }}.detach();
+                }
+                boost::fibers::fiber{ boost::fibers::launch::post, boost::fibers::pinned_to_thread, [&](){
+                    for ( int j = 0; j < 100; ++j) {
+                        boost::this_fiber::yield();
+                    }
+                    pinned_done = true;
+                    finish();
+                }}.detach();
+            }
+            std::unique_lock< boost::fibers::mutex > lk{ mtx };
+            cnd.wait( lk, [&count](){ return total == count.load(); });
+        });
+    }
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+    BOOST_CHECK( pinned_done.load() );
+    BOOST_CHECK( ! timed_out.load() );
+}
+
+void test_shared_work_pinned_under_load() {
+    check_pinned_under_load( [](){
+        boost::fibers::use_scheduling_algorithm< boost::fibers::algo::shared_work >();
+    });
+}
+
+void test_lockfree_shared_work_pinned_under_load() {
+    check_pinned_under_load( [](){
+        boost::fibers::use_scheduling_algorithm< boost::fibers::algo::lockfree_shared_work >();
+    });
+}
+
+// a pinned fiber queued ahead of free fibers must not keep the peers from
+// stealing them: the victim's thread is blocked till a peer has run all free
+// fibers (or a timeout has elapsed)
+void test_work_stealing_behind_pinned() {
+    constexpr int free_count = 16;
+    auto pool = std::make_shared< boost::fibers::algo::work_stealing_pool >( 2);
+    std::atomic< int > stolen{ 0 };
+    std::atomic< bool > all_stolen{ false };
+    std::atomic< bool > pinned_migrated{ false };
+    std::mutex done_mtx;
+    std::condition_variable done_cnd;
+    boost::fibers::mutex mtx;
+    boost::fibers::condition_variable cnd;
+    bool finished = false;
+    std::thread victim{ [&](){
+        boost::fibers::use_scheduling_algorithm< boost::fibers::algo::work_stealing >( pool);
+        std::thread::id id = std::this_thread::get_id();
+        // queued ahead of the free fibers
+        boost::fibers::fiber pinned{ boost::fibers::launch::post, boost::fibers::pinned_to_thread, [&,id](){
+            if ( id != std::this_thread::get_id() ) {
+                pinned_migrated = true;
+            }
+        }};
+        for ( int i = 0; i < free_count; ++i) {
+            boost::fibers::fiber{ boost::fibers::launch::post, [&,id](){
+                if ( id != std::this_thread::get_id() && free_count == ++stolen) {
+                    std::unique_lock< std::mutex > lk{ done_mtx };
+                    lk.unlock();
+                    done_cnd.notify_all();
+                }
+            }}.detach();
+        }
+        {
+            // blocks the thread, neither the pinned nor the free fibers
+            // run here meanwhile
+            std::unique_lock< std::mutex > lk{ done_mtx };
+            all_stolen = done_cnd.wait_for( lk, std::chrono::seconds( 10),
+                                            [&](){ return free_count == stolen.load(); });
+        }
+        pinned.join();
+        {
+            std::unique_lock< boost::fibers::mutex > lk{ mtx };
+            finished = true;
+        }
+        cnd.notify_all();
+    }};
+    std::thread thief{ [&](){
+        boost::fibers::use_scheduling_algorithm< boost::fibers::algo::work_stealing >( pool);
+        std::unique_lock< boost::fibers::mutex > lk{ mtx };
+        cnd.wait( lk, [&finished](){ return finished; });
+    }};
+    victim.join();
+    thief.join();
+    BOOST_CHECK( all_stolen.load() );
+    BOOST_CHECK_EQUAL( free_count, stolen.load() );
+    BOOST_CHECK( ! pinned_migrated.load() );
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: thread-affinity test suite");
+
+    test->add( BOOST_TEST_CASE( & test_work_stealing) );
+    test->add( BOOST_TEST_CASE( & test_work_stealing_behind_pinned) );
+    test->add( BOOST_TEST_CASE( & test_shared_work) );
+    test->add( BOOST_TEST_CASE( & test_lockfree_shared_work) );
+    test->add( BOOST_TEST_CASE( & test_shared_work_pinned_under_load) );
+    test->add( BOOST_TEST_CASE( & test_lockfree_shared_work_pinned_under_load) );
+
+    return test;
+}
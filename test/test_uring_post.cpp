@@ -0,0 +1,158 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+#include <boost/fiber/uring.hpp>
+
+#include "test_utils.hpp"
+
+typedef std::chrono::milliseconds ms;
+
+void test_read_write() {
+    run_with_algorithm< boost::fibers::algo::uring_round_robin >( [](){
+        std::vector< int > fds( 2 * 16);
+        for ( std::size_t i = 0; i < fds.size(); i += 2) {
+            BOOST_REQUIRE( 0 == ::pipe( & fds[i]) );
+        }
+        std::vector< boost::fibers::fiber > fibers;
+        int matched = 0;
+        for ( std::size_t i = 0; i < fds.size(); i += 2) {
+            fibers.emplace_back( boost::fibers::launch::post, [&fds,&matched,i](){
+                char buf[8] = { 0 };
+                BOOST_CHECK_EQUAL( 5, boost::fibers::uring::read( fds[i], buf, sizeof( buf) ) );
+                if ( 0 == std::strcmp( "abcd", buf) ) {
+                    ++matched;
+                }
+            });
+            fibers.emplace_back( boost::fibers::launch::post, [&fds,i](){
+                boost::this_fiber::sleep_for( ms( 5) );
+                BOOST_CHECK_EQUAL( 5, boost::fibers::uring::write( fds[i + 1], "abcd", 5) );
+            });
+        }
+        for ( boost::fibers::fiber & f : fibers) {
+            f.join();
+        }
+        BOOST_CHECK_EQUAL( 16, matched);
+        for ( int fd : fds) {
+            ::close( fd);
+        }
+    });
+}
+
+void test_read_error() {
+    run_with_algorithm< boost::fibers::algo::uring_round_robin >( [](){
+        char buf[8];
+        BOOST_CHECK_EQUAL( -EBADF, boost::fibers::uring::read( -1, buf, sizeof( buf) ) );
+    });
+}
+
+void test_fsync() {
+    run_with_algorithm< boost::fibers::algo::uring_round_robin >( [](){
+        std::FILE * f = std::tmpfile();
+        BOOST_REQUIRE( nullptr != f);
+        int fd = ::fileno( f);
+        BOOST_CHECK_EQUAL( 3, boost::fibers::uring::write( fd, "xyz", 3, 0) );
+        BOOST_CHECK_EQUAL( 0, boost::fibers::uring::fsync( fd) );
+        BOOST_CHECK_EQUAL( 0, boost::fibers::uring::fsync( fd, true) );
+        char buf[4] = { 0 };
+        BOOST_CHECK_EQUAL( 3, boost::fibers::uring::read( fd, buf, 3, 0) );
+        BOOST_CHECK_EQUAL( 0, std::strcmp( "xyz", buf) );
+        std::fclose( f);
+    });
+}
+
+void test_accept_connect() {
+    run_with_algorithm< boost::fibers::algo::uring_round_robin >( [](){
+        int lfd = ::socket( AF_INET, SOCK_STREAM, 0);
+        BOOST_REQUIRE( -1 != lfd);
+        ::sockaddr_in addr;
+        std::memset( & addr, 0, sizeof( addr) );
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        BOOST_REQUIRE( 0 == ::bind( lfd, reinterpret_cast< ::sockaddr * >( & addr), sizeof( addr) ) );
+        BOOST_REQUIRE( 0 == ::listen( lfd, 1) );
+        ::socklen_t len = sizeof( addr);
+        BOOST_REQUIRE( 0 == ::getsockname( lfd, reinterpret_cast< ::sockaddr * >( & addr), & len) );
+        char c = 0;
+        boost::fibers::fiber server{ boost::fibers::launch::post, [&](){
+            int fd = boost::fibers::uring::accept( lfd);
+            BOOST_REQUIRE( 0 <= fd);
+            BOOST_CHECK_EQUAL( 1, boost::fibers::uring::read( fd, & c, 1, 0) );
+            ::close( fd);
+        }};
+        boost::fibers::fiber client{ boost::fibers::launch::post, [&](){
+            int fd = ::socket( AF_INET, SOCK_STREAM, 0);
+            BOOST_REQUIRE( -1 != fd);
+            BOOST_CHECK_EQUAL( 0, boost::fibers::uring::connect(
+                        fd, reinterpret_cast< ::sockaddr * >( & addr), sizeof( addr) ) );
+            BOOST_CHECK_EQUAL( 1, boost::fibers::uring::write( fd, "z", 1, 0) );
+            ::close( fd);
+        }};
+        server.join();
+        client.join();
+        BOOST_CHECK_EQUAL( 'z', c);
+        ::close( lfd);
+    });
+}
+
+void test_remote_notify() {
+    run_with_algorithm< boost::fibers::algo::uring_round_robin >( [](){
+        boost::fibers::promise< int > p;
+        boost::fibers::future< int > f = p.get_future();
+        // the thread blocks in io_uring_enter() till the eventfd is signaled
+        std::thread t{ [&p](){
+            std::this_thread::sleep_for( ms( 10) );
+            p.set_value( 7);
+        }};
+        BOOST_CHECK_EQUAL( 7, f.get() );
+        t.join();
+        // a sleeping fiber is woken by the timeout of io_uring_enter()
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        boost::this_fiber::sleep_for( ms( 20) );
+        BOOST_CHECK( std::chrono::steady_clock::now() - start >= ms( 20) );
+    });
+}
+
+void test_wrong_algorithm() {
+    char buf[8];
+    bool thrown = false;
+    try {
+        boost::fibers::uring::read( 0, buf, sizeof( buf) );
+    } catch ( boost::fibers::fiber_error const& e) {
+        thrown = true;
+        BOOST_CHECK( std::errc::operation_not_supported == e.code() );
+    }
+    BOOST_CHECK( thrown);
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: io_uring test suite");
+
+    test->add( BOOST_TEST_CASE( & test_read_write) );
+    test->add( BOOST_TEST_CASE( & test_read_error) );
+    test->add( BOOST_TEST_CASE( & test_fsync) );
+    test->add( BOOST_TEST_CASE( & test_accept_connect) );
+    test->add( BOOST_TEST_CASE( & test_remote_notify) );
+    test->add( BOOST_TEST_CASE( & test_wrong_algorithm) );
+
+    return test;
+}
@@ -0,0 +1,35 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_FIBERS_TEST_UTILS_H
+#define BOOST_FIBERS_TEST_UTILS_H
+
+#include <chrono>
+#include <thread>
+
+#include <boost/fiber/operations.hpp>
+
+// runs `fn` on a thread of its own with scheduling algorithm `Algo`
+// installed; an algorithm can't be removed from its thread, hence each
+// test case gets a fresh thread
+template< typename Algo, typename Fn >
+void run_with_algorithm( Fn && fn) {
+    std::thread t{ [&fn](){
+        boost::fibers::use_scheduling_algorithm< Algo >();
+        fn();
+    }};
+    t.join();
+}
+
+// spins without yielding: while a fiber occupies its thread for a moment,
+// the fibers queued behind it are left to the peers (stolen or taken from
+// the shared ready-queue), hence the fibers are spread across the threads
+inline void spin_for( std::chrono::microseconds duration = std::chrono::microseconds( 10) ) {
+    std::chrono::steady_clock::time_point tp = std::chrono::steady_clock::now() + duration;
+    while ( std::chrono::steady_clock::now() < tp) {
+    }
+}
+
+#endif // BOOST_FIBERS_TEST_UTILS_H
@@ -0,0 +1,144 @@
+//          Copyright Oliver Kowalke 2013.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/fiber/all.hpp>
+
+#include "test_utils.hpp"
+
+constexpr std::uint32_t thread_count = 4;
+constexpr int fiber_count = 1000;
+
+// threads using the legacy constructor share one pool per process
+void test_work_stealing() {
+    std::atomic< int > count{ 0 };
+    std::mutex threads_mtx;
+    std::set< std::thread::id > thread_ids;
+    boost::fibers::mutex mtx;
+    boost::fibers::condition_variable cnd;
+    auto worker = [&mtx,&cnd,&count](){
+        boost::fibers::use_scheduling_algorithm< boost::fibers::algo::work_stealing >( thread_count, true);
+        std::unique_lock< boost::fibers::mutex > lk{ mtx };
+        cnd.wait( lk, [&count](){ return fiber_count == count.load(); });
+    };
+    std::vector< std::thread > threads;
+    for ( std::uint32_t i = 1; i < thread_count; ++i) {
+        threads.emplace_back( worker);
+    }
+    boost::fibers::use_scheduling_algorithm< boost::fibers::algo::work_stealing >( thread_count, true);
+    // a burst of fibers on one thread wakes the parked peers, which spread
+    // the fibers by stealing batches
+    for ( int i = 0; i < fiber_count; ++i) {
+        boost::fibers::fiber{ [&](){
+            for ( int j = 0; j < 3; ++j) {
+                spin_for();
+                boost::this_fiber::yield();
+            }
+            {
+                std::unique_lock< std::mutex > lk{ threads_mtx };
+                thread_ids.insert( std::this_thread::get_id() );
+            }
+            if ( fiber_count == ++count) {
+                std::unique_lock< boost::fibers::mutex > lk{ mtx };
+                lk.unlock();
+                cnd.notify_all();
+            }
+        }}.detach();
+    }
+    {
+        std::unique_lock< boost::fibers::mutex > lk{ mtx };
+        cnd.wait( lk, [&count](){ return fiber_count == count.load(); });
+    }
+    for ( std::thread & t : threads) {
+        t.join();
+    }
+    BOOST_CHECK_EQUAL( fiber_count, count.load() );
+    BOOST_CHECK( 1 < thread_ids.size() );
+}
+
+struct pool_run {
+    std::shared_ptr< boost::fibers::algo::work_stealing_pool >  pool;
+    std::atomic< int >                                          count{ 0 };
+    std::mutex                                                  threads_mtx{};
+    std::set< std::thread::id >                                 worker_ids{};
+    std::set< std::thread::id >                                 fiber_ids{};
+    boost::fibers::mutex                                        mtx{};
+    boost::fibers::condition_variable                           cnd{};
+
+    pool_run() :
+        pool{ std::make_shared< boost::fibers::algo::work_stealing_pool >( 2) } {
+    }
+
+    void worker( bool spawn) {
+        boost::fibers::use_scheduling_algorithm< boost::fibers::algo::work_stealing >( pool, true);
+        {
+            std::unique_lock< std::mutex > lk{ threads_mtx };
+            worker_ids.insert( std::this_thread::get_id() );
+        }
+        if ( spawn) {
+            for ( int i = 0; i < fiber_count; ++i) {
+                boost::fibers::fiber{ [this](){
+                    boost::this_fiber::yield();
+                    {
+                        std::unique_lock< std::mutex > lk{ threads_mtx };
+                        fiber_ids.insert( std::this_thread::get_id() );
+                    }
+                    if ( fiber_count == ++count) {
+                        std::unique_lock< boost::fibers::mutex > lk{ mtx };
+                        lk.unlock();
+                        cnd.notify_all();
+                    }
+                }}.detach();
+            }
+        }
+        std::unique_lock< boost::fibers::mutex > lk{ mtx };
+        cnd.wait( lk, [this](){ return fiber_count == count.load(); });
+    }
+};
+
+// independent pools run side by side; fibers never migrate to a thread of
+// another pool, a pool might be torn down and created again
+void test_work_stealing_pools() {
+    for ( int round = 0; round < 3; ++round) {
+        pool_run runs[2];
+        std::vector< std::thread > threads;
+        for ( pool_run & run : runs) {
+            threads.emplace_back( [&run](){ run.worker( true); });
+            threads.emplace_back( [&run](){ run.worker( false); });
+        }
+        for ( std::thread & t : threads) {
+            t.join();
+        }
+        for ( pool_run & run : runs) {
+            BOOST_CHECK_EQUAL( fiber_count, run.count.load() );
+            BOOST_CHECK_EQUAL( 2u, run.worker_ids.size() );
+            for ( std::thread::id const& id : run.fiber_ids) {
+                BOOST_CHECK( 0 != run.worker_ids.count( id) );
+            }
+            // the schedulers released the pool at thread exit
+            BOOST_CHECK_EQUAL( 1, run.pool.use_count() );
+        }
+    }
+}
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* []) {
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.Fiber: work-stealing test suite");
+
+    test->add( BOOST_TEST_CASE( & test_work_stealing) );
+    test->add( BOOST_TEST_CASE( & test_work_stealing_pools) );
+
+    return test;
+}